@@ -32,6 +32,10 @@ public final class Symbol implements Comparable<Symbol>, CharSequence
     private final String _underlying;
     private final byte[] _underlyingBytes;
 
+    /**
+     * Symbols retained for the lifetime of the JVM, i.e. those created by {@link #getSymbol(String)}.
+     * Symbols decoded from peers are only looked up here, see {@link #lookup(String)}.
+     */
     private static final ConcurrentHashMap<String, Symbol> _symbols = new ConcurrentHashMap<String, Symbol>(2048);
 
     private Symbol(String underlying)
@@ -72,11 +76,32 @@ public final class Symbol implements Comparable<Symbol>, CharSequence
         return _underlying.hashCode();
     }
 
+    @Override
+    public boolean equals(Object o)
+    {
+        if (this == o)
+        {
+            return true;
+        }
+
+        if (o instanceof Symbol)
+        {
+            return _underlying.equals(((Symbol) o)._underlying);
+        }
+
+        return false;
+    }
+
     public static Symbol valueOf(String symbolVal)
     {
         return getSymbol(symbolVal);
     }
 
+    /**
+     * Returns the symbol for the given value, creating and retaining it for the lifetime of the JVM
+     * if it does not exist yet.  Intended for well known symbols, values received from a peer should
+     * use {@link #lookup(String)} so that they can't grow the symbol table without bound.
+     */
     public static Symbol getSymbol(String symbolVal)
     {
         if(symbolVal == null)
@@ -86,7 +111,6 @@ public final class Symbol implements Comparable<Symbol>, CharSequence
         Symbol symbol = _symbols.get(symbolVal);
         if(symbol == null)
         {
-            symbolVal = symbolVal.intern();
             symbol = new Symbol(symbolVal);
             Symbol existing;
             if((existing = _symbols.putIfAbsent(symbolVal, symbol)) != null)
@@ -97,6 +121,24 @@ public final class Symbol implements Comparable<Symbol>, CharSequence
         return symbol;
     }
 
+    /**
+     * Returns the retained symbol for the given value if there is one, otherwise a new symbol that
+     * is not retained.  Symbols compare by value, so the two are interchangeable other than in cost.
+     */
+    public static Symbol lookup(String symbolVal)
+    {
+        if(symbolVal == null)
+        {
+            return null;
+        }
+        Symbol symbol = _symbols.get(symbolVal);
+        if(symbol == null)
+        {
+            symbol = new Symbol(symbolVal);
+        }
+        return symbol;
+    }
+
     public void writeTo(WritableBuffer buffer)
     {
         buffer.put(_underlyingBytes, 0, _underlyingBytes.length);
@@ -23,6 +23,8 @@
 
 package org.apache.qpid.proton.codec;
 
+import org.apache.qpid.proton.amqp.Symbol;
+import org.apache.qpid.proton.amqp.UnsignedLong;
 import org.apache.qpid.proton.codec.messaging.*;
 import org.apache.qpid.proton.codec.security.*;
 import org.apache.qpid.proton.codec.transaction.*;
@@ -30,6 +32,29 @@ import org.apache.qpid.proton.codec.transport.*;
 
 public class AMQPDefinedTypes
 {
+    // The descriptors of the deferred families are listed here so that deferring them
+    // does not load their type classes.
+    private static final Object[] TRANSACTION_DESCRIPTORS =
+    {
+        UnsignedLong.valueOf(0x0000000000000030L), Symbol.valueOf("amqp:coordinator:list"),
+        UnsignedLong.valueOf(0x0000000000000031L), Symbol.valueOf("amqp:declare:list"),
+        UnsignedLong.valueOf(0x0000000000000032L), Symbol.valueOf("amqp:discharge:list"),
+        UnsignedLong.valueOf(0x0000000000000033L), Symbol.valueOf("amqp:declared:list"),
+        UnsignedLong.valueOf(0x0000000000000034L), Symbol.valueOf("amqp:transactional-state:list"),
+    };
+
+    private static final Object[] SECURITY_DESCRIPTORS =
+    {
+        UnsignedLong.valueOf(0x0000000000000040L), Symbol.valueOf("amqp:sasl-mechanisms:list"),
+        UnsignedLong.valueOf(0x0000000000000041L), Symbol.valueOf("amqp:sasl-init:list"),
+        UnsignedLong.valueOf(0x0000000000000042L), Symbol.valueOf("amqp:sasl-challenge:list"),
+        UnsignedLong.valueOf(0x0000000000000043L), Symbol.valueOf("amqp:sasl-response:list"),
+        UnsignedLong.valueOf(0x0000000000000044L), Symbol.valueOf("amqp:sasl-outcome:list"),
+    };
+
+    private static final String TRANSACTION_PACKAGE = "org.apache.qpid.proton.amqp.transaction";
+    private static final String SECURITY_PACKAGE = "org.apache.qpid.proton.amqp.security";
+
     public static void registerAllTypes(Decoder decoder, EncoderImpl encoder)
     {
         registerTransportTypes(decoder, encoder);
@@ -38,6 +63,20 @@ public class AMQPDefinedTypes
         registerSecurityTypes(decoder, encoder);
     }
 
+    /**
+     * Registers the transport and messaging types, which nearly every connection uses, and defers
+     * registering the transaction and security types until one of them is first read or written.
+     * The end result is the same as {@link #registerAllTypes(Decoder, EncoderImpl)} but with less
+     * work done, and fewer classes loaded, up front.
+     */
+    public static void registerAllTypesLazily(DecoderImpl decoder, EncoderImpl encoder)
+    {
+        registerTransportTypes(decoder, encoder);
+        registerMessagingTypes(decoder, encoder);
+        deferTransactionTypes(decoder, encoder);
+        deferSecurityTypes(decoder, encoder);
+    }
+
     public static void registerTransportTypes(Decoder decoder, EncoderImpl encoder)
     {
         OpenType.register(decoder, encoder);
@@ -108,4 +147,50 @@ public class AMQPDefinedTypes
         SaslResponseType.register(decoder, encoder);
         SaslOutcomeType.register(decoder, encoder);
     }
+
+    public static void deferTransactionTypes(final DecoderImpl decoder, final EncoderImpl encoder)
+    {
+        defer(decoder, encoder, TRANSACTION_DESCRIPTORS, TRANSACTION_PACKAGE, new Runnable()
+        {
+            @Override
+            public void run()
+            {
+                registerTransactionTypes(decoder, encoder);
+            }
+        });
+    }
+
+    public static void deferSecurityTypes(final DecoderImpl decoder, final EncoderImpl encoder)
+    {
+        defer(decoder, encoder, SECURITY_DESCRIPTORS, SECURITY_PACKAGE, new Runnable()
+        {
+            @Override
+            public void run()
+            {
+                registerSecurityTypes(decoder, encoder);
+            }
+        });
+    }
+
+    private static void defer(DecoderImpl decoder, EncoderImpl encoder,
+                              Object[] descriptors, String typePackage, final Runnable registration)
+    {
+        Runnable once = new Runnable()
+        {
+            private boolean _registered;
+
+            @Override
+            public void run()
+            {
+                if (!_registered)
+                {
+                    _registered = true;
+                    registration.run();
+                }
+            }
+        };
+
+        decoder.registerDeferred(descriptors, once);
+        encoder.registerDeferred(typePackage, once);
+    }
 }
@@ -24,7 +24,9 @@ import java.nio.charset.CharacterCodingException;
 import java.nio.charset.CharsetDecoder;
 import java.nio.charset.CoderResult;
 import java.nio.charset.StandardCharsets;
+import java.util.AbstractList;
 import java.util.ArrayList;
+import java.util.Arrays;
 import java.util.Collections;
 import java.util.List;
 
@@ -43,7 +45,7 @@ public class CompositeReadableBuffer implements ReadableBuffer {
     private static final int INT_BYTES = 4;
     private static final int LONG_BYTES = 8;
 
-    private ArrayList<byte[]> contents;
+    private SegmentDeque contents;
 
     // Track active array and our offset into it.
     private int currentArrayIndex = -1;
@@ -144,59 +146,16 @@ public class CompositeReadableBuffer implements ReadableBuffer {
             throw new IndexOutOfBoundsException("The given index is not valid: " + index);
         }
 
-        byte result = 0;
-
-        if (index == position) {
-            result = currentArray[currentOffset];
-        } else if (index < position) {
-            result = getBackwards(index);
-        } else {
-            result = getForward(index);
-        }
-
-        return result;
-    }
-
-    private byte getForward(int index) {
-        byte result = 0;
-
-        int currentArrayIndex = this.currentArrayIndex;
-        int currentOffset = this.currentOffset;
-        byte[] currentArray = this.currentArray;
-
-        for (int amount = index - position; amount >= 0;) {
-            if (amount < currentArray.length - currentOffset) {
-                result = currentArray[currentOffset + amount];
-                break;
-            } else {
-                amount -= currentArray.length - currentOffset;
-                currentArray = contents.get(++currentArrayIndex);
-                currentOffset = 0;
-            }
+        final int target = currentOffset + (index - position);
+        if (currentArrayIndex < 0 || (target >= 0 && target < currentArray.length)) {
+            return currentArray[target];
         }
 
-        return result;
-    }
-
-    private byte getBackwards(int index) {
-        byte result = 0;
+        // Locate the array holding the index by its offset from the start of the segments.
+        final long offset = contents.startOf(currentArrayIndex) + target;
+        final int arrayIndex = contents.indexOf(offset);
 
-        int currentArrayIndex = this.currentArrayIndex;
-        int currentOffset = this.currentOffset;
-        byte[] currentArray = this.currentArray;
-
-        for (int amount = position - index; amount >= 0;) {
-            if ((currentOffset - amount) >= 0) {
-                result = currentArray[currentOffset - amount];
-                break;
-            } else {
-                amount -= currentOffset;
-                currentArray = contents.get(--currentArrayIndex);
-                currentOffset = currentArray.length;
-            }
-        }
-
-        return result;
+        return contents.get(arrayIndex)[(int) (offset - contents.startOf(arrayIndex))];
     }
 
     @Override
@@ -212,6 +171,7 @@ public class CompositeReadableBuffer implements ReadableBuffer {
                      (int)(currentArray[currentOffset++] & 0xFF) << 16 |
                      (int)(currentArray[currentOffset++] & 0xFF) << 8 |
                      (int)(currentArray[currentOffset++] & 0xFF) << 0;
+            maybeMoveToNextArray();
         } else {
             for (int i = INT_BYTES - 1; i >= 0; --i) {
                 result |= (int)(currentArray[currentOffset++] & 0xFF) << (i * Byte.SIZE);
@@ -241,6 +201,7 @@ public class CompositeReadableBuffer implements ReadableBuffer {
                      (long)(currentArray[currentOffset++] & 0xFF) << 16 |
                      (long)(currentArray[currentOffset++] & 0xFF) << 8 |
                      (long)(currentArray[currentOffset++] & 0xFF) << 0;
+            maybeMoveToNextArray();
         } else {
             for (int i = LONG_BYTES - 1; i >= 0; --i) {
                 result |= (long)(currentArray[currentOffset++] & 0xFF) << (i * Byte.SIZE);
@@ -340,11 +301,8 @@ public class CompositeReadableBuffer implements ReadableBuffer {
             throw new IllegalArgumentException("position must be non-negative and no greater than the limit");
         }
 
-        int moveBy = position - this.position;
-        if (moveBy >= 0) {
-            moveForward(moveBy);
-        } else {
-            moveBackwards(Math.abs(moveBy));
+        if (position != this.position) {
+            moveBy(position - this.position);
         }
 
         this.position = position;
@@ -356,33 +314,17 @@ public class CompositeReadableBuffer implements ReadableBuffer {
         return this;
     }
 
-    private void moveForward(int moveBy) {
-        while (moveBy > 0) {
-            if (moveBy < currentArray.length - currentOffset) {
-                currentOffset += moveBy;
-                break;
-            } else {
-                moveBy -= currentArray.length - currentOffset;
-                if (currentArrayIndex != -1 && currentArrayIndex < contents.size() - 1) {
-                    currentArray = contents.get(++currentArrayIndex);
-                    currentOffset = 0;
-                } else {
-                    currentOffset = currentArray.length;
-                }
-            }
-        }
-    }
-
-    private void moveBackwards(int moveBy) {
-        while (moveBy > 0) {
-            if ((currentOffset - moveBy) >= 0) {
-                currentOffset -= moveBy;
-                break;
-            } else {
-                moveBy -= currentOffset;
-                currentArray = contents.get(--currentArrayIndex);
-                currentOffset = currentArray.length;
-            }
+    private void moveBy(int amount) {
+        final int target = currentOffset + amount;
+        if (currentArrayIndex < 0 || (target >= 0 && target < currentArray.length)) {
+            currentOffset = target;
+        } else {
+            // Landing on an array boundary selects the start of the following array
+            // unless there is none, matching where sequential reads would leave us.
+            final long offset = contents.startOf(currentArrayIndex) + target;
+            currentArrayIndex = contents.indexOf(offset);
+            currentArray = contents.get(currentArrayIndex);
+            currentOffset = (int) (offset - contents.startOf(currentArrayIndex));
         }
     }
 
@@ -491,7 +433,7 @@ public class CompositeReadableBuffer implements ReadableBuffer {
             new CompositeReadableBuffer(currentArray, currentOffset);
 
         if (contents != null) {
-            duplicated.contents = new ArrayList<>(contents);
+            duplicated.contents = new SegmentDeque(contents);
         }
 
         duplicated.capacity = capacity;
@@ -521,6 +463,42 @@ public class CompositeReadableBuffer implements ReadableBuffer {
         return result.asReadOnlyBuffer();
     }
 
+    /**
+     * Returns read-only views of the content between position and limit, one per backing
+     * array that the content spans.  Unlike {@link #byteBuffer()} the content is never
+     * copied, so callers that can consume several buffers (e.g. a gathering write) should
+     * prefer this method for buffers made up of many arrays.
+     * <p>
+     * The buffer position is not affected and the views share content with this buffer.
+     *
+     * @return an array of read-only buffers which together hold the remaining content.
+     */
+    public ByteBuffer[] byteBuffers() {
+        final int viewSpan = limit() - position();
+
+        if (viewSpan == 0) {
+            return new ByteBuffer[0];
+        } else if (viewSpan <= currentArray.length - currentOffset) {
+            return new ByteBuffer[] { ByteBuffer.wrap(currentArray, currentOffset, viewSpan).asReadOnlyBuffer() };
+        }
+
+        final long start = contents.startOf(currentArrayIndex) + currentOffset;
+        final int lastArrayIndex = contents.indexOf(start + viewSpan - 1);
+        final ByteBuffer[] views = new ByteBuffer[lastArrayIndex - currentArrayIndex + 1];
+
+        int offset = currentOffset;
+        int remaining = viewSpan;
+        for (int i = 0; i < views.length; ++i) {
+            final byte[] array = contents.get(currentArrayIndex + i);
+            final int length = Math.min(array.length - offset, remaining);
+            views[i] = ByteBuffer.wrap(array, offset, length).asReadOnlyBuffer();
+            remaining -= length;
+            offset = 0;
+        }
+
+        return views;
+    }
+
     private ByteBuffer buildByteBuffer(int span) {
         byte[] compactedView = new byte[span];
         int arrayIndex = currentArrayIndex;
@@ -613,20 +591,18 @@ public class CompositeReadableBuffer implements ReadableBuffer {
         }
 
         int totalCompaction = 0;
-        int totalRemovals = 0;
 
-        for (; totalRemovals < currentArrayIndex; ++totalRemovals) {
-            byte[] element = contents.remove(0);
-            totalCompaction += element.length;
+        if (currentArrayIndex > 0) {
+            totalCompaction = (int) (contents.startOf(currentArrayIndex) - contents.startOf(0));
+            contents.removeFirst(currentArrayIndex);
+            currentArrayIndex = 0;
         }
 
-        currentArrayIndex -= totalRemovals;
-
         if (currentArray.length == currentOffset) {
             totalCompaction += currentArray.length;
 
             // If we are sitting on the end of the data (length == offest) then
-            // we are also at the last element in the ArrayList if one is currently
+            // we are also at the last element in the segment list if one is currently
             // in use, so remove the data and release the list.
             if (currentArrayIndex == 0) {
                 contents.clear();
@@ -676,7 +652,7 @@ public class CompositeReadableBuffer implements ReadableBuffer {
             currentArray = array;
             currentOffset = 0;
         } else if (contents == null) {
-            contents = new ArrayList<>();
+            contents = new SegmentDeque();
             contents.add(currentArray);
             contents.add(array);
             currentArrayIndex = 0;
@@ -889,4 +865,135 @@ public class CompositeReadableBuffer implements ReadableBuffer {
             throw new IndexOutOfBoundsException("target is to small for specified read size");
         }
     }
+
+    /**
+     * Ring buffer holding the arrays of a multi-array composite.  Removing consumed
+     * arrays from the head is constant time, and each entry records the running total
+     * of bytes appended up to and including it so that an offset can be mapped to the
+     * array holding it with a binary search rather than a walk over the arrays.
+     */
+    private static final class SegmentDeque extends AbstractList<byte[]> {
+
+        private static final int INITIAL_CAPACITY = 8;
+
+        private byte[][] arrays;
+        private long[] ends;
+        private int head;
+        private int size;
+
+        SegmentDeque() {
+            arrays = new byte[INITIAL_CAPACITY][];
+            ends = new long[INITIAL_CAPACITY];
+        }
+
+        SegmentDeque(SegmentDeque other) {
+            arrays = new byte[other.arrays.length][];
+            ends = new long[other.arrays.length];
+            size = other.size;
+
+            for (int i = 0; i < size; ++i) {
+                final int slot = other.slot(i);
+                arrays[i] = other.arrays[slot];
+                ends[i] = other.ends[slot];
+            }
+        }
+
+        @Override
+        public byte[] get(int index) {
+            if (index < 0 || index >= size) {
+                throw new IndexOutOfBoundsException("The given index is not valid: " + index);
+            }
+
+            return arrays[slot(index)];
+        }
+
+        @Override
+        public int size() {
+            return size;
+        }
+
+        @Override
+        public boolean add(byte[] array) {
+            if (size == arrays.length) {
+                grow();
+            }
+
+            final int slot = slot(size);
+            arrays[slot] = array;
+            ends[slot] = size == 0 ? array.length : ends[slot(size - 1)] + array.length;
+            size++;
+            modCount++;
+
+            return true;
+        }
+
+        @Override
+        public void clear() {
+            Arrays.fill(arrays, null);
+            head = 0;
+            size = 0;
+            modCount++;
+        }
+
+        /**
+         * Drops the given number of arrays from the head of the deque.
+         */
+        void removeFirst(int count) {
+            for (int i = 0; i < count; ++i) {
+                arrays[head] = null;
+                head = (head + 1) & (arrays.length - 1);
+            }
+
+            size -= count;
+            modCount++;
+        }
+
+        /**
+         * @return the offset of the first byte of the array at the given index, relative to
+         *         an origin that is fixed for the life of the deque.
+         */
+        long startOf(int index) {
+            final int slot = slot(index);
+            return ends[slot] - arrays[slot].length;
+        }
+
+        /**
+         * @return the index of the array holding the given offset, or the last array when the
+         *         offset sits at the very end of the content.
+         */
+        int indexOf(long offset) {
+            int low = 0;
+            int high = size - 1;
+
+            while (low < high) {
+                final int mid = (low + high) >>> 1;
+                if (ends[slot(mid)] <= offset) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
+                }
+            }
+
+            return low;
+        }
+
+        private int slot(int index) {
+            return (head + index) & (arrays.length - 1);
+        }
+
+        private void grow() {
+            final byte[][] newArrays = new byte[arrays.length << 1][];
+            final long[] newEnds = new long[arrays.length << 1];
+
+            for (int i = 0; i < size; ++i) {
+                final int slot = slot(i);
+                newArrays[i] = arrays[slot];
+                newEnds[i] = ends[slot];
+            }
+
+            arrays = newArrays;
+            ends = newEnds;
+            head = 0;
+        }
+    }
 }
@@ -51,6 +51,8 @@ public class DecoderImpl implements ByteBufferDecoder
     private final Map<Object, FastPathDescribedTypeConstructor<?>> _fastPathTypeConstructors =
         new HashMap<Object, FastPathDescribedTypeConstructor<?>>();
 
+    private Map<Object, Runnable> _deferredTypeRegistrations;
+
     public DecoderImpl()
     {
     }
@@ -112,6 +114,10 @@ public class DecoderImpl implements ByteBufferDecoder
 
             TypeConstructor<?> nestedEncoding = readConstructor();
             DescribedTypeConstructor<?> dtc = _dynamicTypeConstructors.get(descriptor);
+            if(dtc == null && runDeferredRegistration(descriptor))
+            {
+                dtc = _dynamicTypeConstructors.get(descriptor);
+            }
             if(dtc == null)
             {
                 dtc = new DescribedTypeConstructor()
@@ -143,11 +149,51 @@ public class DecoderImpl implements ByteBufferDecoder
 
     public void register(final Object descriptor, final DescribedTypeConstructor dtc)
     {
+        // Run any deferred registration for the descriptor first so it cannot later replace this one.
+        runDeferredRegistration(descriptor);
+
         // Allow external type constructors to replace the built-in instances.
         _fastPathTypeConstructors.remove(descriptor);
         _dynamicTypeConstructors.put(descriptor, dtc);
     }
 
+    /**
+     * Defers a registration until one of the given descriptors is first read, so that the
+     * constructors of rarely used types need not be created (or their classes loaded) up front.
+     *
+     * @param descriptors the descriptors the registration will register constructors for.
+     * @param registration registers the constructors, it should do nothing if run again.
+     */
+    public void registerDeferred(final Object[] descriptors, final Runnable registration)
+    {
+        if (_deferredTypeRegistrations == null)
+        {
+            _deferredTypeRegistrations = new HashMap<Object, Runnable>();
+        }
+
+        for (Object descriptor : descriptors)
+        {
+            _deferredTypeRegistrations.put(descriptor, registration);
+        }
+    }
+
+    private boolean runDeferredRegistration(final Object descriptor)
+    {
+        if (_deferredTypeRegistrations == null)
+        {
+            return false;
+        }
+
+        Runnable registration = _deferredTypeRegistrations.remove(descriptor);
+        if (registration == null)
+        {
+            return false;
+        }
+
+        registration.run();
+        return true;
+    }
+
     private ClassCastException unexpectedType(final Object val, Class clazz)
     {
         return new ClassCastException("Unexpected type "
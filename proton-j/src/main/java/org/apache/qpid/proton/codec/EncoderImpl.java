@@ -48,6 +48,7 @@ public final class EncoderImpl implements ByteBufferEncoder
     private final Map<Class, AMQPType> _typeRegistry = new HashMap<Class, AMQPType>();
     private Map<Object, AMQPType> _describedDescriptorRegistry = new HashMap<Object, AMQPType>();
     private Map<Class, AMQPType>  _describedTypesClassRegistry = new HashMap<Class, AMQPType>();
+    private Map<String, Runnable> _deferredTypeRegistrations;
 
     private final NullType              _nullType;
     private final BooleanType           _booleanType;
@@ -192,6 +193,10 @@ public final class EncoderImpl implements ByteBufferEncoder
 
                     return amqpType;
                 }
+                else if(runDeferredRegistration(clazz))
+                {
+                    return _typeRegistry.get(clazz);
+                }
             }
             _typeRegistry.put(clazz, amqpType);
         }
@@ -207,9 +212,50 @@ public final class EncoderImpl implements ByteBufferEncoder
 
     <T> void register(Class<T> clazz, AMQPType<T> type)
     {
+        // Run any deferred registration for the class first so it cannot later replace this one.
+        runDeferredRegistration(clazz);
         _typeRegistry.put(clazz, type);
     }
 
+    /**
+     * Defers a registration until an object of a class from the given package is first written,
+     * so that the types of rarely used classes need not be created (or the classes loaded) up front.
+     *
+     * @param typePackage the name of the package holding the classes the registration registers types for.
+     * @param registration registers the types, it should do nothing if run again.
+     */
+    public void registerDeferred(String typePackage, Runnable registration)
+    {
+        if (_deferredTypeRegistrations == null)
+        {
+            _deferredTypeRegistrations = new HashMap<String, Runnable>();
+        }
+
+        _deferredTypeRegistrations.put(typePackage + ".", registration);
+    }
+
+    private boolean runDeferredRegistration(Class<?> clazz)
+    {
+        if (_deferredTypeRegistrations == null || _deferredTypeRegistrations.isEmpty())
+        {
+            return false;
+        }
+
+        String className = clazz.getName();
+        for (Map.Entry<String, Runnable> entry : _deferredTypeRegistrations.entrySet())
+        {
+            if (className.startsWith(entry.getKey()))
+            {
+                Runnable registration = entry.getValue();
+                _deferredTypeRegistrations.remove(entry.getKey());
+                registration.run();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     public void registerDescribedType(Class clazz, Object descriptor)
     {
         AMQPType type = _describedDescriptorRegistry.get(descriptor);
@@ -744,6 +790,10 @@ public final class EncoderImpl implements ByteBufferEncoder
             {
                 writeDescribedType((DescribedType)o);
             }
+            else if(runDeferredRegistration(o.getClass()) && (type = _typeRegistry.get(o.getClass())) != null)
+            {
+                type.write(o);
+            }
             else
             {
                 throw new IllegalArgumentException(
@@ -0,0 +1,357 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.codec;
+
+import java.nio.ByteBuffer;
+import java.nio.charset.CharacterCodingException;
+import java.nio.charset.CharsetDecoder;
+import java.util.concurrent.atomic.AtomicInteger;
+
+/**
+ * An encoded payload that is shared, without copying, between many deliveries on
+ * any number of links and connections.
+ * <p>
+ * Each call to {@link #retain()} returns a new {@link ReadableBuffer} view of the
+ * payload that holds a reference to it and can be passed to
+ * {@link org.apache.qpid.proton.engine.Sender#sendNoCopy(ReadableBuffer)}. The view
+ * gives up its reference once all of its bytes have been written by the transport,
+ * and when the creator has also called {@link #release()} the optional release
+ * callback is run, for example to return the backing buffer to a pool.
+ * <p>
+ * The payload bytes must not be modified once the payload has been created. Views
+ * obtained through {@link ReadableBuffer#slice()} or {@link ReadableBuffer#duplicate()}
+ * do not hold a reference and must not outlive the view they were taken from.
+ */
+public final class SharedPayload {
+
+    private static final Runnable NO_OP = new Runnable() {
+
+        @Override
+        public void run() {
+        }
+    };
+
+    private final ByteBuffer payload;
+    private final Runnable onRelease;
+    private final AtomicInteger refCount = new AtomicInteger(1);
+
+    private SharedPayload(ByteBuffer payload, Runnable onRelease) {
+        this.payload = payload;
+        this.onRelease = onRelease;
+    }
+
+    /**
+     * Creates a shared payload over the given array.
+     *
+     * @param payload
+     *      the encoded payload, which must not be modified afterwards.
+     *
+     * @return a new shared payload holding a single reference for the caller.
+     */
+    public static SharedPayload wrap(byte[] payload) {
+        return wrap(payload, 0, payload.length);
+    }
+
+    /**
+     * Creates a shared payload over a region of the given array.
+     *
+     * @param payload
+     *      the array containing the encoded payload, which must not be modified afterwards.
+     * @param offset
+     *      the offset into the array where the payload starts.
+     * @param length
+     *      the number of payload bytes.
+     *
+     * @return a new shared payload holding a single reference for the caller.
+     */
+    public static SharedPayload wrap(byte[] payload, int offset, int length) {
+        return new SharedPayload(ByteBuffer.wrap(payload, offset, length).slice(), NO_OP);
+    }
+
+    /**
+     * Creates a shared payload over the remaining bytes of the given buffer.
+     *
+     * @param payload
+     *      the buffer containing the encoded payload, which must not be modified afterwards.
+     * @param onRelease
+     *      run once the last reference to the payload has been released, or null.
+     *
+     * @return a new shared payload holding a single reference for the caller.
+     */
+    public static SharedPayload wrap(ByteBuffer payload, Runnable onRelease) {
+        return new SharedPayload(payload.slice(), onRelease == null ? NO_OP : onRelease);
+    }
+
+    /**
+     * @return the number of bytes in the payload.
+     */
+    public int length() {
+        return payload.remaining();
+    }
+
+    /**
+     * @return the number of outstanding references, including the creator's own reference.
+     */
+    public int refCount() {
+        return refCount.get();
+    }
+
+    /**
+     * Obtains a new reference to the payload in the form of a buffer positioned at its
+     * first byte, intended to be sent with
+     * {@link org.apache.qpid.proton.engine.Sender#sendNoCopy(ReadableBuffer)}.
+     *
+     * @return a new view of the payload that releases its reference once fully read.
+     *
+     * @throws IllegalStateException if the payload has already been released.
+     */
+    public ReadableBuffer retain() {
+        int current;
+        do {
+            current = refCount.get();
+            if (current == 0) {
+                throw new IllegalStateException("Shared payload has already been released");
+            }
+        } while (!refCount.compareAndSet(current, current + 1));
+
+        return new View(payload.duplicate());
+    }
+
+    /**
+     * Releases the reference held by the creator of the payload. The payload is released
+     * once this has been called and every view obtained from {@link #retain()} has been
+     * fully read.
+     *
+     * @throws IllegalStateException if the payload has already been released.
+     */
+    public void release() {
+        int current;
+        do {
+            current = refCount.get();
+            if (current == 0) {
+                throw new IllegalStateException("Shared payload has already been released");
+            }
+        } while (!refCount.compareAndSet(current, current - 1));
+
+        if (current == 1) {
+            onRelease.run();
+        }
+    }
+
+    @Override
+    public String toString() {
+        return "SharedPayload{length=" + length() + ", refCount=" + refCount() + "}";
+    }
+
+    private final class View implements ReadableBuffer {
+
+        private final ByteBufferReader reader;
+        private boolean released;
+
+        View(ByteBuffer buffer) {
+            this.reader = new ByteBufferReader(buffer);
+        }
+
+        @Override
+        public ReadableBuffer reclaimRead() {
+            // The transport reclaims after each write, once fully written the reference goes
+            if (!released && !reader.hasRemaining()) {
+                released = true;
+                release();
+            }
+
+            return this;
+        }
+
+        @Override
+        public int capacity() {
+            return reader.capacity();
+        }
+
+        @Override
+        public boolean hasArray() {
+            return reader.hasArray();
+        }
+
+        @Override
+        public byte[] array() {
+            return reader.array();
+        }
+
+        @Override
+        public int arrayOffset() {
+            return reader.arrayOffset();
+        }
+
+        @Override
+        public byte get() {
+            return reader.get();
+        }
+
+        @Override
+        public byte get(int index) {
+            return reader.get(index);
+        }
+
+        @Override
+        public int getInt() {
+            return reader.getInt();
+        }
+
+        @Override
+        public long getLong() {
+            return reader.getLong();
+        }
+
+        @Override
+        public short getShort() {
+            return reader.getShort();
+        }
+
+        @Override
+        public float getFloat() {
+            return reader.getFloat();
+        }
+
+        @Override
+        public double getDouble() {
+            return reader.getDouble();
+        }
+
+        @Override
+        public ReadableBuffer get(byte[] target, int offset, int length) {
+            reader.get(target, offset, length);
+            return this;
+        }
+
+        @Override
+        public ReadableBuffer get(byte[] target) {
+            reader.get(target);
+            return this;
+        }
+
+        @Override
+        public ReadableBuffer get(WritableBuffer target) {
+            reader.get(target);
+            return this;
+        }
+
+        @Override
+        public ReadableBuffer slice() {
+            return reader.slice();
+        }
+
+        @Override
+        public ReadableBuffer flip() {
+            reader.flip();
+            return this;
+        }
+
+        @Override
+        public ReadableBuffer limit(int limit) {
+            reader.limit(limit);
+            return this;
+        }
+
+        @Override
+        public int limit() {
+            return reader.limit();
+        }
+
+        @Override
+        public ReadableBuffer position(int position) {
+            reader.position(position);
+            return this;
+        }
+
+        @Override
+        public int position() {
+            return reader.position();
+        }
+
+        @Override
+        public ReadableBuffer mark() {
+            reader.mark();
+            return this;
+        }
+
+        @Override
+        public ReadableBuffer reset() {
+            reader.reset();
+            return this;
+        }
+
+        @Override
+        public ReadableBuffer rewind() {
+            reader.rewind();
+            return this;
+        }
+
+        @Override
+        public ReadableBuffer clear() {
+            reader.clear();
+            return this;
+        }
+
+        @Override
+        public int remaining() {
+            return reader.remaining();
+        }
+
+        @Override
+        public boolean hasRemaining() {
+            return reader.hasRemaining();
+        }
+
+        @Override
+        public ReadableBuffer duplicate() {
+            return reader.duplicate();
+        }
+
+        @Override
+        public ByteBuffer byteBuffer() {
+            return reader.byteBuffer();
+        }
+
+        @Override
+        public String readUTF8() throws CharacterCodingException {
+            return reader.readUTF8();
+        }
+
+        @Override
+        public String readString(CharsetDecoder decoder) throws CharacterCodingException {
+            return reader.readString(decoder);
+        }
+
+        @Override
+        public int hashCode() {
+            return reader.hashCode();
+        }
+
+        @Override
+        public boolean equals(Object other) {
+            return this == other || reader.equals(other);
+        }
+
+        @Override
+        public String toString() {
+            return reader.toString();
+        }
+    }
+}
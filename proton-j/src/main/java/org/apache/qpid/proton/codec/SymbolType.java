@@ -31,6 +31,9 @@ import java.util.Map;
 public class SymbolType extends AbstractPrimitiveType<Symbol>
 {
     private static final Charset ASCII_CHARSET = Charset.forName("US-ASCII");
+
+    /** Bounds the per decoder cache, which would otherwise grow with every distinct symbol a peer sends. */
+    private static final int MAX_CACHED_SYMBOLS = 1024;
     private final SymbolEncoding _symbolEncoding;
     private final SymbolEncoding _shortSymbolEncoding;
 
@@ -48,8 +51,12 @@ public class SymbolType extends AbstractPrimitiveType<Symbol>
                     buffer.get(bytes);
 
                     String str = new String(bytes, ASCII_CHARSET);
-                    symbol = Symbol.getSymbol(str);
+                    symbol = Symbol.lookup(str);
 
+                    if (_symbolCache.size() >= MAX_CACHED_SYMBOLS)
+                    {
+                        _symbolCache.clear();
+                    }
                     _symbolCache.put(ReadableBuffer.ByteBufferReader.wrap(bytes), symbol);
                 }
                 return symbol;
@@ -745,7 +745,7 @@ class DataDecoder
             int size = b.get() & 0xff;
             byte[] bytes = new byte[size];
             b.get(bytes);
-            data.putSymbol(Symbol.valueOf(new String(bytes, ASCII)));
+            data.putSymbol(Symbol.lookup(new String(bytes, ASCII)));
         }
     }
 
@@ -803,7 +803,7 @@ class DataDecoder
             int size = b.getInt();
             byte[] bytes = new byte[size];
             b.get(bytes);
-            data.putSymbol(Symbol.valueOf(new String(bytes, ASCII)));
+            data.putSymbol(Symbol.lookup(new String(bytes, ASCII)));
         }
     }
 
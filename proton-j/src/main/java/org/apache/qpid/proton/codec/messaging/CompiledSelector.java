@@ -0,0 +1,158 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.qpid.proton.codec.messaging;
+
+import java.nio.charset.StandardCharsets;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+import org.apache.qpid.proton.amqp.DescribedType;
+import org.apache.qpid.proton.amqp.Symbol;
+import org.apache.qpid.proton.amqp.UnsignedLong;
+import org.apache.qpid.proton.codec.DecodeException;
+import org.apache.qpid.proton.codec.ReadableBuffer;
+
+/**
+ * A message selector compiled once, typically per link from the selector filter of its source,
+ * and then evaluated against each encoded message without decoding it.
+ *
+ * Identifiers name application properties, apart from the JMS header names JMSMessageID,
+ * JMSCorrelationID, JMSType, JMSXGroupID and JMSXGroupSeq, which name the message-id,
+ * correlation-id, subject, group-id and group-sequence fields of the properties section.
+ * Other identifiers starting with JMS, such as JMSPriority or JMSTimestamp, name values this
+ * class does not read and so are rejected rather than treated as application properties.
+ * String values are compared as their encoded UTF-8 bytes and numeric values are read from
+ * whichever encoding they were sent with, and evaluation stops reading the message as soon as
+ * the outcome is known.
+ *
+ * The supported syntax is described by {@link #compile(String)}. A compiled selector keeps
+ * state between the steps of an evaluation and so must not be used by several threads at once.
+ */
+public final class CompiledSelector {
+
+    public static final Symbol SELECTOR_FILTER_SYMBOL = Symbol.valueOf("apache.org:selector-filter:string");
+    public static final UnsignedLong SELECTOR_FILTER_CODE = UnsignedLong.valueOf(0x0000468C00000004L);
+
+    private static final Map<String, Integer> PROPERTIES_FIELDS = new HashMap<>();
+    static {
+        PROPERTIES_FIELDS.put("JMSMessageID", 0);
+        PROPERTIES_FIELDS.put("JMSType", 3);
+        PROPERTIES_FIELDS.put("JMSCorrelationID", 5);
+        PROPERTIES_FIELDS.put("JMSXGroupID", 10);
+        PROPERTIES_FIELDS.put("JMSXGroupSeq", 11);
+    }
+
+    private final String selector;
+    private final SelectorExpression expression;
+    private final EncodedMessageView view;
+
+    private CompiledSelector(String selector, SelectorExpression expression, List<String> identifiers) {
+        this.selector = selector;
+        this.expression = expression;
+
+        byte[][] applicationKeys = new byte[identifiers.size()][];
+        int[] propertiesFields = new int[identifiers.size()];
+        for (int slot = 0; slot < identifiers.size(); slot++) {
+            Integer field = PROPERTIES_FIELDS.get(identifiers.get(slot));
+            if (field != null) {
+                propertiesFields[slot] = field;
+            } else {
+                propertiesFields[slot] = -1;
+                applicationKeys[slot] = identifiers.get(slot).getBytes(StandardCharsets.UTF_8);
+            }
+        }
+        this.view = new EncodedMessageView(applicationKeys, propertiesFields);
+    }
+
+    /**
+     * Compiles a selector written in the subset of the JMS message selector syntax made up of
+     * comparisons between an identifier and a string, numeric or boolean literal, [NOT] IN with
+     * string literals, [NOT] BETWEEN with numeric literals, IS [NOT] NULL, boolean identifiers,
+     * TRUE, FALSE, NOT, AND, OR and parentheses.
+     *
+     * @param selector the selector.
+     * @return the compiled selector.
+     * @throws IllegalArgumentException if the selector is malformed, uses syntax outside that
+     * subset, such as LIKE or arithmetic, or uses a JMS header identifier other than those
+     * described above, in which case it must be evaluated some other way.
+     */
+    public static CompiledSelector compile(String selector) {
+        SelectorParser parser = new SelectorParser(selector);
+        SelectorExpression expression = parser.parse();
+        List<String> identifiers = parser.getIdentifiers();
+        for (String identifier : identifiers) {
+            if (identifier.startsWith("JMS") && !PROPERTIES_FIELDS.containsKey(identifier)) {
+                throw new IllegalArgumentException("Identifier " + identifier + " is not supported: " + selector);
+            }
+        }
+        return new CompiledSelector(selector, expression, identifiers);
+    }
+
+    /**
+     * Compiles the selector filter, if any, among the filters of a source, as returned by
+     * {@link org.apache.qpid.proton.amqp.messaging.Source#getFilter()}.
+     *
+     * @param filters the filters of the source, which may be null.
+     * @return the compiled selector, or null if there is no selector filter.
+     * @throws IllegalArgumentException if the selector cannot be compiled.
+     */
+    public static CompiledSelector fromFilters(Map<Symbol, Object> filters) {
+        if (filters == null) {
+            return null;
+        }
+
+        for (Object filter : filters.values()) {
+            if (filter instanceof DescribedType) {
+                DescribedType described = (DescribedType) filter;
+                Object descriptor = described.getDescriptor();
+                if ((SELECTOR_FILTER_SYMBOL.equals(descriptor) || SELECTOR_FILTER_CODE.equals(descriptor))
+                    && described.getDescribed() instanceof String) {
+                    return compile((String) described.getDescribed());
+                }
+            }
+        }
+        return null;
+    }
+
+    /**
+     * Evaluates the selector against an encoded message, which is not consumed.
+     *
+     * @param message the buffer holding the encoded sections of the message from its position to its limit.
+     * @return true if the selector is true for the message, or false if it is false or unknown.
+     * @throws DecodeException if the part of the message that had to be read is malformed.
+     */
+    public boolean matches(ReadableBuffer message) {
+        view.reset(message);
+        try {
+            return expression.evaluate(view) == SelectorExpression.TRUE;
+        } catch (IndexOutOfBoundsException e) {
+            throw new DecodeException("Encoded message is truncated", e);
+        } finally {
+            view.release();
+        }
+    }
+
+    public String getSelector() {
+        return selector;
+    }
+
+    @Override
+    public String toString() {
+        return "CompiledSelector [" + selector + "]";
+    }
+}
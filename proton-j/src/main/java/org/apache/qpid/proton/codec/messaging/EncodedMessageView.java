@@ -0,0 +1,294 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.qpid.proton.codec.messaging;
+
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+
+import org.apache.qpid.proton.codec.DecodeException;
+import org.apache.qpid.proton.codec.EncodingCodes;
+import org.apache.qpid.proton.codec.ReadableBuffer;
+
+/**
+ * Finds the encoded values a {@link CompiledSelector} refers to within an encoded message, without
+ * decoding anything but the constructors and sizes needed to step over what lies in between.
+ *
+ * Values are located lazily. The application-properties map is scanned only as far as the first
+ * occurrence of the key being asked for, remembering any other wanted keys passed on the way, so
+ * that a selector which fails on its first comparison reads no more of the map than it needed.
+ *
+ * A view is reset for each message and is not thread safe.
+ */
+final class EncodedMessageView {
+
+    /** The offset of a value that has not been looked for yet. */
+    static final int UNSCANNED = -1;
+    /** The offset of a value that is not present in the message. */
+    static final int ABSENT = -2;
+
+    private static final long PROPERTIES_DESCRIPTOR = 0x73L;
+    private static final long APPLICATION_PROPERTIES_DESCRIPTOR = 0x74L;
+    private static final long FIRST_BODY_DESCRIPTOR = 0x75L;
+    private static final long OTHER_DESCRIPTOR = -1L;
+
+    private static final byte[] PROPERTIES_SYMBOL = "amqp:properties:list".getBytes(StandardCharsets.US_ASCII);
+    private static final byte[] APPLICATION_PROPERTIES_SYMBOL = "amqp:application-properties:map".getBytes(StandardCharsets.US_ASCII);
+
+    // For each slot, the UTF-8 bytes of its application property key, or null if it is a properties field
+    private final byte[][] applicationKeys;
+    // For each slot, the index of its field in the properties list, or -1 if it is an application property
+    private final int[] propertiesFields;
+    private final int[] offsets;
+
+    private ReadableBuffer buffer;
+    private int limit;
+
+    private boolean sectionsScanned;
+    private int propertiesStart;
+    private int propertiesCount;
+    private int applicationNext;
+    private int applicationRemaining;
+
+    EncodedMessageView(byte[][] applicationKeys, int[] propertiesFields) {
+        this.applicationKeys = applicationKeys;
+        this.propertiesFields = propertiesFields;
+        this.offsets = new int[applicationKeys.length];
+    }
+
+    void reset(ReadableBuffer buffer) {
+        this.buffer = buffer;
+        this.limit = buffer.limit();
+        this.sectionsScanned = false;
+        this.propertiesStart = ABSENT;
+        this.propertiesCount = 0;
+        this.applicationNext = ABSENT;
+        this.applicationRemaining = 0;
+        Arrays.fill(offsets, UNSCANNED);
+    }
+
+    void release() {
+        buffer = null;
+    }
+
+    /**
+     * @return the offset of the constructor of the value held in the given slot, or {@link #ABSENT}.
+     */
+    int find(int slot) {
+        int offset = offsets[slot];
+        if (offset != UNSCANNED) {
+            return offset;
+        }
+
+        if (!sectionsScanned) {
+            scanSections();
+        }
+
+        if (propertiesFields[slot] >= 0) {
+            offset = findPropertiesField(propertiesFields[slot]);
+            offsets[slot] = offset;
+            return offset;
+        }
+
+        return findApplicationProperty(slot);
+    }
+
+    int getByte(int index) {
+        if (index >= limit) {
+            throw new DecodeException("Encoded message is truncated");
+        }
+        return buffer.get(index) & 0xFF;
+    }
+
+    int getInt(int index) {
+        return getByte(index) << 24 | getByte(index + 1) << 16 | getByte(index + 2) << 8 | getByte(index + 3);
+    }
+
+    long getLong(int index) {
+        return ((long) getInt(index)) << 32 | (getInt(index + 4) & 0xFFFFFFFFL);
+    }
+
+    /**
+     * @return the offset just past the encoded value starting at the given offset.
+     */
+    int skip(int offset) {
+        int code = getByte(offset);
+        if (code == EncodingCodes.DESCRIBED_TYPE_INDICATOR) {
+            return skip(skip(offset + 1));
+        }
+
+        switch (code >> 4) {
+            case 0x4:
+                return offset + 1;
+            case 0x5:
+                return offset + 2;
+            case 0x6:
+                return offset + 3;
+            case 0x7:
+                return offset + 5;
+            case 0x8:
+                return offset + 9;
+            case 0x9:
+                return offset + 17;
+            case 0xa:
+            case 0xc:
+            case 0xe:
+                return offset + 2 + getByte(offset + 1);
+            case 0xb:
+            case 0xd:
+            case 0xf:
+                return checkedEnd(offset + 5, getInt(offset + 1));
+            default:
+                throw new DecodeException("Unknown encoding code 0x" + Integer.toHexString(code));
+        }
+    }
+
+    /**
+     * @return true if the value at the given offset is a string or symbol whose UTF-8 bytes are the given ones.
+     */
+    boolean stringEquals(int offset, byte[] expected) {
+        int code = getByte(offset);
+        int start;
+        int length;
+        if (code == (EncodingCodes.STR8 & 0xFF) || code == (EncodingCodes.SYM8 & 0xFF)) {
+            length = getByte(offset + 1);
+            start = offset + 2;
+        } else if (code == (EncodingCodes.STR32 & 0xFF) || code == (EncodingCodes.SYM32 & 0xFF)) {
+            length = getInt(offset + 1);
+            start = offset + 5;
+        } else {
+            return false;
+        }
+
+        if (length != expected.length) {
+            return false;
+        }
+        for (int i = 0; i < length; i++) {
+            if ((byte) getByte(start + i) != expected[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    private void scanSections() {
+        sectionsScanned = true;
+
+        int offset = buffer.position();
+        while (offset < limit) {
+            if (getByte(offset) != EncodingCodes.DESCRIBED_TYPE_INDICATOR) {
+                throw new DecodeException("Expected a message section at offset " + offset);
+            }
+
+            int valueOffset = skip(offset + 1);
+            long descriptor = readDescriptor(offset + 1);
+            if (descriptor == PROPERTIES_DESCRIPTOR) {
+                readProperties(valueOffset);
+            } else if (descriptor == APPLICATION_PROPERTIES_DESCRIPTOR) {
+                readApplicationProperties(valueOffset);
+                return;
+            } else if (descriptor >= FIRST_BODY_DESCRIPTOR) {
+                // Application properties can only come before the body
+                return;
+            }
+
+            offset = skip(valueOffset);
+        }
+    }
+
+    private long readDescriptor(int offset) {
+        int code = getByte(offset);
+        if (code == (EncodingCodes.SMALLULONG & 0xFF)) {
+            return getByte(offset + 1);
+        } else if (code == (EncodingCodes.ULONG & 0xFF)) {
+            return getLong(offset + 1);
+        } else if (stringEquals(offset, PROPERTIES_SYMBOL)) {
+            return PROPERTIES_DESCRIPTOR;
+        } else if (stringEquals(offset, APPLICATION_PROPERTIES_SYMBOL)) {
+            return APPLICATION_PROPERTIES_DESCRIPTOR;
+        }
+        return OTHER_DESCRIPTOR;
+    }
+
+    private void readProperties(int offset) {
+        int code = getByte(offset);
+        if (code == (EncodingCodes.LIST8 & 0xFF)) {
+            propertiesCount = getByte(offset + 2);
+            propertiesStart = offset + 3;
+        } else if (code == (EncodingCodes.LIST32 & 0xFF)) {
+            propertiesCount = getInt(offset + 5);
+            propertiesStart = offset + 9;
+        }
+    }
+
+    private void readApplicationProperties(int offset) {
+        int code = getByte(offset);
+        if (code == (EncodingCodes.MAP8 & 0xFF)) {
+            applicationRemaining = getByte(offset + 2) / 2;
+            applicationNext = offset + 3;
+        } else if (code == (EncodingCodes.MAP32 & 0xFF)) {
+            applicationRemaining = getInt(offset + 5) / 2;
+            applicationNext = offset + 9;
+        }
+    }
+
+    private int findPropertiesField(int field) {
+        if (field >= propertiesCount) {
+            return ABSENT;
+        }
+
+        int offset = propertiesStart;
+        for (int i = 0; i < field; i++) {
+            offset = skip(offset);
+        }
+        return getByte(offset) == (EncodingCodes.NULL & 0xFF) ? ABSENT : offset;
+    }
+
+    private int findApplicationProperty(int wanted) {
+        while (applicationRemaining > 0) {
+            int keyOffset = applicationNext;
+            int valueOffset = skip(keyOffset);
+            applicationNext = skip(valueOffset);
+            applicationRemaining--;
+
+            for (int slot = 0; slot < applicationKeys.length; slot++) {
+                if (offsets[slot] == UNSCANNED && applicationKeys[slot] != null
+                    && stringEquals(keyOffset, applicationKeys[slot])) {
+                    offsets[slot] = valueOffset;
+                    if (slot == wanted) {
+                        return valueOffset;
+                    }
+                    break;
+                }
+            }
+        }
+
+        // The whole map has been scanned, so any key not seen yet is not present
+        for (int slot = 0; slot < applicationKeys.length; slot++) {
+            if (offsets[slot] == UNSCANNED && applicationKeys[slot] != null) {
+                offsets[slot] = ABSENT;
+            }
+        }
+        return ABSENT;
+    }
+
+    private int checkedEnd(int start, int size) {
+        if (size < 0 || start + size < start) {
+            throw new DecodeException("Invalid encoded size " + size);
+        }
+        return start + size;
+    }
+}
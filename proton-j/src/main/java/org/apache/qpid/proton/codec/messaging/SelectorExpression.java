@@ -0,0 +1,318 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.qpid.proton.codec.messaging;
+
+import org.apache.qpid.proton.codec.EncodingCodes;
+
+/**
+ * A node of a compiled selector. Evaluation follows the three valued logic of SQL, in which a
+ * comparison involving a missing value, or a value of another type, is neither true nor false.
+ */
+abstract class SelectorExpression {
+
+    static final int FALSE = 0;
+    static final int TRUE = 1;
+    static final int UNKNOWN = 2;
+
+    enum Operator {
+        EQUAL, NOT_EQUAL, LESS, LESS_OR_EQUAL, GREATER, GREATER_OR_EQUAL;
+
+        Operator reverse() {
+            switch (this) {
+                case LESS:
+                    return GREATER;
+                case LESS_OR_EQUAL:
+                    return GREATER_OR_EQUAL;
+                case GREATER:
+                    return LESS;
+                case GREATER_OR_EQUAL:
+                    return LESS_OR_EQUAL;
+                default:
+                    return this;
+            }
+        }
+
+        int apply(int comparison) {
+            switch (this) {
+                case EQUAL:
+                    return truth(comparison == 0);
+                case NOT_EQUAL:
+                    return truth(comparison != 0);
+                case LESS:
+                    return truth(comparison < 0);
+                case LESS_OR_EQUAL:
+                    return truth(comparison <= 0);
+                case GREATER:
+                    return truth(comparison > 0);
+                default:
+                    return truth(comparison >= 0);
+            }
+        }
+    }
+
+    abstract int evaluate(EncodedMessageView message);
+
+    static int truth(boolean value) {
+        return value ? TRUE : FALSE;
+    }
+
+    static final class Constant extends SelectorExpression {
+
+        private final int value;
+
+        Constant(boolean value) {
+            this.value = truth(value);
+        }
+
+        @Override
+        int evaluate(EncodedMessageView message) {
+            return value;
+        }
+    }
+
+    static final class And extends SelectorExpression {
+
+        private final SelectorExpression left;
+        private final SelectorExpression right;
+
+        And(SelectorExpression left, SelectorExpression right) {
+            this.left = left;
+            this.right = right;
+        }
+
+        @Override
+        int evaluate(EncodedMessageView message) {
+            int result = left.evaluate(message);
+            if (result == FALSE) {
+                return FALSE;
+            }
+            int other = right.evaluate(message);
+            return other == TRUE ? result : other;
+        }
+    }
+
+    static final class Or extends SelectorExpression {
+
+        private final SelectorExpression left;
+        private final SelectorExpression right;
+
+        Or(SelectorExpression left, SelectorExpression right) {
+            this.left = left;
+            this.right = right;
+        }
+
+        @Override
+        int evaluate(EncodedMessageView message) {
+            int result = left.evaluate(message);
+            if (result == TRUE) {
+                return TRUE;
+            }
+            int other = right.evaluate(message);
+            return other == FALSE ? result : other;
+        }
+    }
+
+    static final class Not extends SelectorExpression {
+
+        private final SelectorExpression operand;
+
+        Not(SelectorExpression operand) {
+            this.operand = operand;
+        }
+
+        @Override
+        int evaluate(EncodedMessageView message) {
+            int result = operand.evaluate(message);
+            return result == UNKNOWN ? UNKNOWN : 1 - result;
+        }
+    }
+
+    static final class IsNull extends SelectorExpression {
+
+        private final int slot;
+
+        IsNull(int slot) {
+            this.slot = slot;
+        }
+
+        @Override
+        int evaluate(EncodedMessageView message) {
+            int offset = message.find(slot);
+            return truth(offset == EncodedMessageView.ABSENT || message.getByte(offset) == (EncodingCodes.NULL & 0xFF));
+        }
+    }
+
+    /**
+     * Compares a string value with string literals, matching if it equals any of them.
+     */
+    static final class StringIn extends SelectorExpression {
+
+        private final int slot;
+        private final byte[][] literals;
+
+        StringIn(int slot, byte[][] literals) {
+            this.slot = slot;
+            this.literals = literals;
+        }
+
+        @Override
+        int evaluate(EncodedMessageView message) {
+            int offset = message.find(slot);
+            if (offset == EncodedMessageView.ABSENT || !isString(message.getByte(offset))) {
+                return UNKNOWN;
+            }
+
+            for (byte[] literal : literals) {
+                if (message.stringEquals(offset, literal)) {
+                    return TRUE;
+                }
+            }
+            return FALSE;
+        }
+
+        private static boolean isString(int code) {
+            return code == (EncodingCodes.STR8 & 0xFF) || code == (EncodingCodes.STR32 & 0xFF)
+                || code == (EncodingCodes.SYM8 & 0xFF) || code == (EncodingCodes.SYM32 & 0xFF);
+        }
+    }
+
+    static final class BooleanComparison extends SelectorExpression {
+
+        private final int slot;
+        private final boolean literal;
+
+        BooleanComparison(int slot, boolean literal) {
+            this.slot = slot;
+            this.literal = literal;
+        }
+
+        @Override
+        int evaluate(EncodedMessageView message) {
+            int offset = message.find(slot);
+            if (offset == EncodedMessageView.ABSENT) {
+                return UNKNOWN;
+            }
+
+            int code = message.getByte(offset);
+            boolean value;
+            if (code == (EncodingCodes.BOOLEAN_TRUE & 0xFF)) {
+                value = true;
+            } else if (code == (EncodingCodes.BOOLEAN_FALSE & 0xFF)) {
+                value = false;
+            } else if (code == (EncodingCodes.BOOLEAN & 0xFF)) {
+                value = message.getByte(offset + 1) != 0;
+            } else {
+                return UNKNOWN;
+            }
+            return truth(value == literal);
+        }
+    }
+
+    /**
+     * Compares a numeric value with a numeric literal, as whole numbers if both are and otherwise
+     * as doubles, reading the value straight from whichever encoding it was sent with.
+     */
+    static final class NumericComparison extends SelectorExpression {
+
+        private final int slot;
+        private final Operator operator;
+        private final boolean integral;
+        private final long longLiteral;
+        private final double doubleLiteral;
+
+        NumericComparison(int slot, Operator operator, Number literal) {
+            this.slot = slot;
+            this.operator = operator;
+            this.integral = literal instanceof Long;
+            this.longLiteral = literal.longValue();
+            this.doubleLiteral = literal.doubleValue();
+        }
+
+        @Override
+        int evaluate(EncodedMessageView message) {
+            int offset = message.find(slot);
+            if (offset == EncodedMessageView.ABSENT) {
+                return UNKNOWN;
+            }
+
+            long longValue;
+            double doubleValue;
+            switch ((byte) message.getByte(offset)) {
+                case EncodingCodes.UBYTE:
+                case EncodingCodes.SMALLUINT:
+                case EncodingCodes.SMALLULONG:
+                    longValue = message.getByte(offset + 1);
+                    break;
+                case EncodingCodes.BYTE:
+                case EncodingCodes.SMALLINT:
+                case EncodingCodes.SMALLLONG:
+                    longValue = (byte) message.getByte(offset + 1);
+                    break;
+                case EncodingCodes.USHORT:
+                    longValue = message.getByte(offset + 1) << 8 | message.getByte(offset + 2);
+                    break;
+                case EncodingCodes.SHORT:
+                    longValue = (short) (message.getByte(offset + 1) << 8 | message.getByte(offset + 2));
+                    break;
+                case EncodingCodes.UINT:
+                    longValue = message.getInt(offset + 1) & 0xFFFFFFFFL;
+                    break;
+                case EncodingCodes.INT:
+                    longValue = message.getInt(offset + 1);
+                    break;
+                case EncodingCodes.UINT0:
+                case EncodingCodes.ULONG0:
+                    longValue = 0;
+                    break;
+                case EncodingCodes.LONG:
+                    longValue = message.getLong(offset + 1);
+                    break;
+                case EncodingCodes.ULONG:
+                    longValue = message.getLong(offset + 1);
+                    if (longValue < 0) {
+                        // Beyond the range of a long, so compare as a double
+                        return compare(unsignedToDouble(longValue));
+                    }
+                    break;
+                case EncodingCodes.FLOAT:
+                    doubleValue = Float.intBitsToFloat(message.getInt(offset + 1));
+                    return compare(doubleValue);
+                case EncodingCodes.DOUBLE:
+                    doubleValue = Double.longBitsToDouble(message.getLong(offset + 1));
+                    return compare(doubleValue);
+                default:
+                    return UNKNOWN;
+            }
+
+            if (integral) {
+                return operator.apply(Long.compare(longValue, longLiteral));
+            }
+            return compare(longValue);
+        }
+
+        private int compare(double value) {
+            if (Double.isNaN(value) || Double.isNaN(doubleLiteral)) {
+                return UNKNOWN;
+            }
+            return operator.apply(value < doubleLiteral ? -1 : (value > doubleLiteral ? 1 : 0));
+        }
+
+        private static double unsignedToDouble(long value) {
+            return (double) (value >>> 1) * 2.0 + (value & 1);
+        }
+    }
+}
@@ -0,0 +1,406 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.qpid.proton.codec.messaging;
+
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashSet;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Locale;
+import java.util.Map;
+import java.util.Set;
+
+import org.apache.qpid.proton.codec.messaging.SelectorExpression.Operator;
+
+/**
+ * Parses the subset of the JMS message selector syntax that {@link CompiledSelector} supports:
+ * comparisons between an identifier and a literal, [NOT] IN, [NOT] BETWEEN, IS [NOT] NULL, boolean
+ * identifiers, TRUE, FALSE, NOT, AND, OR and parentheses.
+ *
+ * Anything else, such as LIKE, arithmetic or comparing two identifiers, is rejected with an
+ * IllegalArgumentException so that the caller can fall back to evaluating the selector some other way.
+ */
+final class SelectorParser {
+
+    private static final Set<String> KEYWORDS = new HashSet<>(Arrays.asList(
+        "AND", "OR", "NOT", "IN", "IS", "NULL", "BETWEEN", "LIKE", "ESCAPE", "TRUE", "FALSE"));
+
+    private enum TokenType {
+        IDENTIFIER, STRING, NUMBER, OPERATOR, END
+    }
+
+    private final String selector;
+    private final Map<String, Integer> slots = new LinkedHashMap<>();
+
+    private int position;
+    private TokenType tokenType;
+    private String token;
+    private Object literal;
+
+    SelectorParser(String selector) {
+        this.selector = selector;
+    }
+
+    /**
+     * @return the identifiers referred to by the selector, in slot order.
+     */
+    List<String> getIdentifiers() {
+        return new ArrayList<>(slots.keySet());
+    }
+
+    SelectorExpression parse() {
+        next();
+        SelectorExpression expression = parseOr();
+        if (tokenType != TokenType.END) {
+            throw unexpected();
+        }
+        return expression;
+    }
+
+    private SelectorExpression parseOr() {
+        SelectorExpression expression = parseAnd();
+        while (isKeyword("OR")) {
+            next();
+            expression = new SelectorExpression.Or(expression, parseAnd());
+        }
+        return expression;
+    }
+
+    private SelectorExpression parseAnd() {
+        SelectorExpression expression = parseNot();
+        while (isKeyword("AND")) {
+            next();
+            expression = new SelectorExpression.And(expression, parseNot());
+        }
+        return expression;
+    }
+
+    private SelectorExpression parseNot() {
+        if (isKeyword("NOT")) {
+            next();
+            return new SelectorExpression.Not(parseNot());
+        }
+        return parsePredicate();
+    }
+
+    private SelectorExpression parsePredicate() {
+        if (isOperator("(")) {
+            next();
+            SelectorExpression expression = parseOr();
+            expect(")");
+            return expression;
+        }
+        if (isKeyword("TRUE") || isKeyword("FALSE")) {
+            boolean value = isKeyword("TRUE");
+            next();
+            return new SelectorExpression.Constant(value);
+        }
+
+        if (tokenType == TokenType.IDENTIFIER) {
+            if (!isIdentifier()) {
+                throw unexpected();
+            }
+            int slot = slot(token);
+            next();
+            return parseIdentifierPredicate(slot);
+        }
+
+        // A literal compared with an identifier, as in 10 < size
+        Object left = parseLiteral();
+        Operator operator = parseOperator();
+        if (!isIdentifier()) {
+            throw new IllegalArgumentException("Comparing two literals is not supported: " + selector);
+        }
+        int slot = slot(token);
+        next();
+        return comparison(slot, operator.reverse(), left);
+    }
+
+    private SelectorExpression parseIdentifierPredicate(int slot) {
+        if (isKeyword("IS")) {
+            next();
+            boolean negate = isKeyword("NOT");
+            if (negate) {
+                next();
+            }
+            expectKeyword("NULL");
+            return negate(new SelectorExpression.IsNull(slot), negate);
+        }
+
+        boolean negate = isKeyword("NOT");
+        if (negate) {
+            next();
+        }
+
+        if (isKeyword("IN")) {
+            next();
+            expect("(");
+            List<byte[]> literals = new ArrayList<>();
+            do {
+                if (tokenType != TokenType.STRING) {
+                    throw new IllegalArgumentException("IN only supports string literals: " + selector);
+                }
+                literals.add(((String) literal).getBytes(StandardCharsets.UTF_8));
+                next();
+            } while (acceptOperator(","));
+            expect(")");
+            return negate(new SelectorExpression.StringIn(slot, literals.toArray(new byte[literals.size()][])), negate);
+        }
+
+        if (isKeyword("BETWEEN")) {
+            next();
+            Object low = parseLiteral();
+            expectKeyword("AND");
+            Object high = parseLiteral();
+            if (!(low instanceof Number) || !(high instanceof Number)) {
+                throw new IllegalArgumentException("BETWEEN only supports numeric literals: " + selector);
+            }
+            SelectorExpression between = new SelectorExpression.And(
+                comparison(slot, Operator.GREATER_OR_EQUAL, low), comparison(slot, Operator.LESS_OR_EQUAL, high));
+            return negate(between, negate);
+        }
+
+        if (negate) {
+            throw unexpected();
+        }
+
+        if (tokenType != TokenType.OPERATOR || isOperator(")")) {
+            // A boolean identifier standing alone
+            return new SelectorExpression.BooleanComparison(slot, true);
+        }
+
+        Operator operator = parseOperator();
+        if (isIdentifier()) {
+            throw new IllegalArgumentException("Comparing two identifiers is not supported: " + selector);
+        }
+        return comparison(slot, operator, parseLiteral());
+    }
+
+    private SelectorExpression comparison(int slot, Operator operator, Object literal) {
+        if (literal instanceof Number) {
+            return new SelectorExpression.NumericComparison(slot, operator, (Number) literal);
+        }
+
+        SelectorExpression equality;
+        if (literal instanceof String) {
+            equality = new SelectorExpression.StringIn(slot, new byte[][] { ((String) literal).getBytes(StandardCharsets.UTF_8) });
+        } else {
+            equality = new SelectorExpression.BooleanComparison(slot, (Boolean) literal);
+        }
+
+        switch (operator) {
+            case EQUAL:
+                return equality;
+            case NOT_EQUAL:
+                return new SelectorExpression.Not(equality);
+            default:
+                throw new IllegalArgumentException("Strings and booleans can only be compared with = or <>: " + selector);
+        }
+    }
+
+    private Object parseLiteral() {
+        boolean negative = false;
+        if (isOperator("-") || isOperator("+")) {
+            negative = isOperator("-");
+            next();
+            if (tokenType != TokenType.NUMBER) {
+                throw unexpected();
+            }
+        }
+
+        Object value;
+        if (tokenType == TokenType.STRING || tokenType == TokenType.NUMBER) {
+            value = literal;
+        } else if (isKeyword("TRUE") || isKeyword("FALSE")) {
+            value = isKeyword("TRUE");
+        } else {
+            throw unexpected();
+        }
+        next();
+
+        if (negative) {
+            value = value instanceof Long ? (Object) (-(Long) value) : (Object) (-(Double) value);
+        }
+        return value;
+    }
+
+    private Operator parseOperator() {
+        Operator operator;
+        if (isOperator("=")) {
+            operator = Operator.EQUAL;
+        } else if (isOperator("<>")) {
+            operator = Operator.NOT_EQUAL;
+        } else if (isOperator("<")) {
+            operator = Operator.LESS;
+        } else if (isOperator("<=")) {
+            operator = Operator.LESS_OR_EQUAL;
+        } else if (isOperator(">")) {
+            operator = Operator.GREATER;
+        } else if (isOperator(">=")) {
+            operator = Operator.GREATER_OR_EQUAL;
+        } else {
+            throw unexpected();
+        }
+        next();
+        return operator;
+    }
+
+    private static SelectorExpression negate(SelectorExpression expression, boolean negate) {
+        return negate ? new SelectorExpression.Not(expression) : expression;
+    }
+
+    private int slot(String identifier) {
+        Integer slot = slots.get(identifier);
+        if (slot == null) {
+            slot = slots.size();
+            slots.put(identifier, slot);
+        }
+        return slot;
+    }
+
+    private boolean isIdentifier() {
+        return tokenType == TokenType.IDENTIFIER && !KEYWORDS.contains(token.toUpperCase(Locale.ROOT));
+    }
+
+    private boolean isKeyword(String keyword) {
+        return tokenType == TokenType.IDENTIFIER && token.equalsIgnoreCase(keyword);
+    }
+
+    private boolean isOperator(String operator) {
+        return tokenType == TokenType.OPERATOR && token.equals(operator);
+    }
+
+    private boolean acceptOperator(String operator) {
+        if (isOperator(operator)) {
+            next();
+            return true;
+        }
+        return false;
+    }
+
+    private void expect(String operator) {
+        if (!acceptOperator(operator)) {
+            throw unexpected();
+        }
+    }
+
+    private void expectKeyword(String keyword) {
+        if (!isKeyword(keyword)) {
+            throw unexpected();
+        }
+        next();
+    }
+
+    private IllegalArgumentException unexpected() {
+        String found = tokenType == TokenType.END ? "end of selector" : "'" + token + "'";
+        return new IllegalArgumentException("Unexpected " + found + " at " + position + " in selector: " + selector);
+    }
+
+    private void next() {
+        int length = selector.length();
+        while (position < length && Character.isWhitespace(selector.charAt(position))) {
+            position++;
+        }
+
+        literal = null;
+        if (position == length) {
+            tokenType = TokenType.END;
+            token = null;
+            return;
+        }
+
+        int start = position;
+        char c = selector.charAt(position);
+        if (Character.isJavaIdentifierStart(c)) {
+            do {
+                position++;
+            } while (position < length && Character.isJavaIdentifierPart(selector.charAt(position)));
+            tokenType = TokenType.IDENTIFIER;
+            token = selector.substring(start, position);
+        } else if (c == '\'') {
+            StringBuilder value = new StringBuilder();
+            position++;
+            while (true) {
+                if (position == length) {
+                    throw new IllegalArgumentException("Unterminated string literal in selector: " + selector);
+                }
+                char s = selector.charAt(position++);
+                if (s == '\'') {
+                    if (position < length && selector.charAt(position) == '\'') {
+                        position++;
+                    } else {
+                        break;
+                    }
+                }
+                value.append(s);
+            }
+            tokenType = TokenType.STRING;
+            token = selector.substring(start, position);
+            literal = value.toString();
+        } else if (Character.isDigit(c) || (c == '.' && position + 1 < length && Character.isDigit(selector.charAt(position + 1)))) {
+            readNumber(start);
+        } else {
+            tokenType = TokenType.OPERATOR;
+            if (selector.startsWith("<>", position) || selector.startsWith("<=", position) || selector.startsWith(">=", position)) {
+                position += 2;
+            } else if ("=<>(),+-".indexOf(c) >= 0) {
+                position++;
+            } else {
+                throw new IllegalArgumentException("Unsupported character '" + c + "' at " + position + " in selector: " + selector);
+            }
+            token = selector.substring(start, position);
+        }
+    }
+
+    private void readNumber(int start) {
+        int length = selector.length();
+        boolean decimal = false;
+        while (position < length) {
+            char c = selector.charAt(position);
+            if (c == '.' || c == 'e' || c == 'E') {
+                decimal = true;
+            } else if ((c == '-' || c == '+') && decimal && isExponent(selector.charAt(position - 1))) {
+                // The sign of an exponent
+            } else if (!Character.isDigit(c)) {
+                break;
+            }
+            position++;
+        }
+
+        String number = selector.substring(start, position);
+        if (position < length && (selector.charAt(position) == 'L' || selector.charAt(position) == 'l') && !decimal) {
+            position++;
+        } else if (position < length && "dDfF".indexOf(selector.charAt(position)) >= 0) {
+            position++;
+            decimal = true;
+        }
+
+        tokenType = TokenType.NUMBER;
+        token = selector.substring(start, position);
+        try {
+            literal = decimal ? (Object) Double.valueOf(number) : (Object) Long.valueOf(number);
+        } catch (NumberFormatException e) {
+            throw new IllegalArgumentException("Invalid number '" + token + "' in selector: " + selector, e);
+        }
+    }
+
+    private static boolean isExponent(char c) {
+        return c == 'e' || c == 'E';
+    }
+}
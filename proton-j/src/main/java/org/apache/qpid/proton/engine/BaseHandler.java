@@ -74,9 +74,12 @@ public class BaseHandler implements CoreHandler
     @Override public void onLinkLocalClose(Event e) { onUnhandled(e); }
     @Override public void onLinkRemoteClose(Event e) { onUnhandled(e); }
     @Override public void onLinkFlow(Event e) { onUnhandled(e); }
+    @Override public void onLinkWritable(Event e) { onUnhandled(e); }
     @Override public void onLinkFinal(Event e) { onUnhandled(e); }
 
     @Override public void onDelivery(Event e) { onUnhandled(e); }
+    @Override public void onDeliveryBatch(Event e) { onUnhandled(e); }
+    @Override public void onDeliveryExpired(Event e) { onUnhandled(e); }
     @Override public void onTransport(Event e) { onUnhandled(e); }
     @Override public void onTransportError(Event e) { onUnhandled(e); }
     @Override public void onTransportHeadClosed(Event e) { onUnhandled(e); }
@@ -178,12 +181,21 @@ public class BaseHandler implements CoreHandler
         case LINK_FLOW:
             onLinkFlow(e);
             break;
+        case LINK_WRITABLE:
+            onLinkWritable(e);
+            break;
         case LINK_FINAL:
             onLinkFinal(e);
             break;
         case DELIVERY:
             onDelivery(e);
             break;
+        case DELIVERY_BATCH:
+            onDeliveryBatch(e);
+            break;
+        case DELIVERY_EXPIRED:
+            onDeliveryExpired(e);
+            break;
         case TRANSPORT:
             onTransport(e);
             break;
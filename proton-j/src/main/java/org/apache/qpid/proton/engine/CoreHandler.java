@@ -45,9 +45,12 @@ public interface CoreHandler extends Handler {
     void onLinkLocalClose(Event e);
     void onLinkRemoteClose(Event e);
     void onLinkFlow(Event e);
+    void onLinkWritable(Event e);
     void onLinkFinal(Event e);
 
     void onDelivery(Event e);
+    void onDeliveryBatch(Event e);
+    void onDeliveryExpired(Event e);
     void onTransport(Event e);
     void onTransportError(Event e);
     void onTransportHeadClosed(Event e);
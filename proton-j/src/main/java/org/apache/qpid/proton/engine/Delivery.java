@@ -181,4 +181,26 @@ public interface Delivery extends Extendable
      * @see Sender#send(org.apache.qpid.proton.codec.ReadableBuffer)
      */
     int available();
+
+    /**
+     * Sets the time after which this outgoing delivery is no longer worth sending, typically
+     * worked out from the ttl of its message's header or the absolute-expiry-time of its properties.
+     *
+     * If the time has passed when the transport comes to send the delivery, after the sender
+     * has been advanced past it but before any of it has been written, the delivery is dropped
+     * instead. Its data is discarded, the credit it took is given back to its sender, and a
+     * {@link Event.Type#DELIVERY_EXPIRED} event is emitted, after which the application should
+     * settle it. A delivery that has started to be written is sent in full.
+     *
+     * @param expiryTime the expiry time in milliseconds since the epoch, or 0 (the default) for none.
+     */
+    void setExpiryTime(long expiryTime);
+
+    long getExpiryTime();
+
+    /**
+     * @return true if this delivery was dropped because it expired before it could be sent.
+     * @see #setExpiryTime(long)
+     */
+    boolean isExpired();
 }
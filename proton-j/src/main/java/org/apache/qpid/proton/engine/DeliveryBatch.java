@@ -0,0 +1,42 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+package org.apache.qpid.proton.engine;
+
+
+/**
+ * The deliveries on a single link whose remote state or settlement was updated
+ * by one disposition received from the peer, in delivery-id order.
+ *
+ * This is the context of a {@link Event.Type#DELIVERY_BATCH} event, emitted in place
+ * of individual {@link Event.Type#DELIVERY} events when enabled with
+ * {@link Transport#setEmitDeliveryBatchEvents(boolean)}.
+ */
+public interface DeliveryBatch extends Iterable<Delivery>
+{
+
+    Link getLink();
+
+    /**
+     * @return the number of deliveries in the batch
+     */
+    int size();
+
+}
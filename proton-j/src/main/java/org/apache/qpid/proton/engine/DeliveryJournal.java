@@ -0,0 +1,123 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine;
+
+import java.io.Closeable;
+import java.io.File;
+import java.io.IOException;
+import java.util.Collection;
+
+import org.apache.qpid.proton.codec.ReadableBuffer;
+import org.apache.qpid.proton.engine.impl.DeliveryJournalImpl;
+
+/**
+ * Keeps the payloads of the unsettled deliveries of one or more senders in memory-mapped segment
+ * files, so that a publisher restarting after a failure can send again whatever had not been
+ * settled, without keeping its own copy of each payload.
+ *
+ * A journal is set on a sender with {@link Sender#setDeliveryJournal(DeliveryJournal)}. The data
+ * sent for each delivery is appended to the journal as it is sent, the delivery is recorded as
+ * complete when the sender advances past it, and it is forgotten when it is settled. A segment
+ * file is deleted as soon as every delivery with data in it has been settled.
+ *
+ * On opening, the complete unsettled deliveries found in the directory are made available from
+ * {@link #getRecovered()}. Sending a delivery with the same tag on a journaled sender with the
+ * same link name supersedes the recovered one, and one that is not to be sent again is dropped
+ * with {@link #discard(RecoveredDelivery)}.
+ *
+ * The journal is written by the engine as deliveries are sent and settled, so it must only be
+ * used from the thread that uses the connections of its senders. Writes reach the operating
+ * system as they are made, and so survive the publisher failing, but only reach the storage
+ * device on {@link #flush()}.
+ *
+ * Each segment stays mapped into memory, whole, until its buffer is garbage collected, which
+ * happens some time after the segment is deleted or the journal is closed rather than at that
+ * point. Under a steady load the address space in use is therefore the size of the live
+ * segments plus that of however many deleted ones have yet to be collected, and a smaller
+ * segment size than the default keeps that overhead down.
+ */
+public interface DeliveryJournal extends Closeable
+{
+    public static final class Factory
+    {
+        /**
+         * Opens the journal in the given directory, creating the directory if need be.
+         *
+         * @param directory the directory holding the segment files.
+         * @param segmentSize the size of each segment file in bytes.
+         */
+        public static DeliveryJournal open(File directory, int segmentSize) throws IOException
+        {
+            return new DeliveryJournalImpl(directory, segmentSize);
+        }
+
+        /**
+         * Opens the journal in the given directory with segment files of 16 MiB.
+         */
+        public static DeliveryJournal open(File directory) throws IOException
+        {
+            return new DeliveryJournalImpl(directory, DeliveryJournalImpl.DEFAULT_SEGMENT_SIZE);
+        }
+    }
+
+    /**
+     * A complete unsettled delivery found when the journal was opened.
+     */
+    public interface RecoveredDelivery
+    {
+        String getLinkName();
+
+        byte[] getTag();
+
+        int getMessageFormat();
+
+        /**
+         * @return the data sent for the delivery, which may be a view of the segment file
+         * holding it and so remains valid only until the delivery is sent again or discarded.
+         */
+        ReadableBuffer getPayload();
+    }
+
+    /**
+     * @return the recovered deliveries that have been neither sent again nor discarded, in the
+     * order they were originally sent.
+     */
+    Collection<RecoveredDelivery> getRecovered();
+
+    /**
+     * Forgets a recovered delivery that is not going to be sent again.
+     */
+    void discard(RecoveredDelivery delivery);
+
+    /**
+     * @return the number of deliveries in the journal that have not been settled, including
+     * those being sent and those recovered.
+     */
+    int getUnsettledCount();
+
+    /**
+     * @return the number of segment files currently in use.
+     */
+    int getSegmentCount();
+
+    /**
+     * Forces everything written to the journal so far to the storage device.
+     */
+    void flush() throws IOException;
+}
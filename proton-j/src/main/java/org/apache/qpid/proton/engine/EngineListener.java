@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine;
+
+/**
+ * Listener told of changes to the state of a connection and its sessions, links and deliveries
+ * at the point the engine makes them, as an alternative to collecting {@link Event}s with a
+ * {@link Collector} for embedders that drive the engine from their own loop.
+ *
+ * Set with {@link ProtonJConnection#setEngineListener(EngineListener)}, after which the
+ * connection's events are passed to the listener instead of to any collector. Every method
+ * does nothing by default, so only the changes of interest need be handled.
+ *
+ * The methods are called while the transport is part way through processing input or output,
+ * so they should only read state or make changes that take effect when output is next
+ * processed, such as granting credit, updating or settling deliveries, and opening or closing
+ * endpoints. They must not process the transport's input or output themselves. Unlike a
+ * collector, consecutive identical events are not coalesced.
+ */
+public interface EngineListener {
+
+    /**
+     * Called when a transfer frame has been received and its content appended to the delivery.
+     *
+     * @param receiver the receiving link
+     * @param delivery the delivery the transfer belongs to
+     * @param available the number of bytes of the delivery now available to read
+     * @param partial whether more transfers are to follow for the delivery
+     */
+    default void onTransfer(Receiver receiver, Delivery delivery, int available, boolean partial) {
+    }
+
+    /**
+     * Called when a disposition frame has been received and applied to the delivery.
+     *
+     * @param delivery the delivery
+     * @param remotelySettled whether the peer has settled the delivery
+     */
+    default void onDisposition(Delivery delivery, boolean remotelySettled) {
+    }
+
+    /**
+     * Called instead of {@link #onDisposition(Delivery, boolean)} for the deliveries updated by
+     * a disposition when {@link Transport#setEmitDeliveryBatchEvents(boolean)} is enabled.
+     *
+     * @param batch the deliveries of one link updated by the disposition
+     */
+    default void onDeliveryBatch(DeliveryBatch batch) {
+    }
+
+    /**
+     * Called when an outgoing delivery is dropped because its expiry time passed before it
+     * could be sent.
+     *
+     * @param delivery the delivery
+     * @see Delivery#setExpiryTime(long)
+     */
+    default void onExpired(Delivery delivery) {
+    }
+
+    /**
+     * Called when the credit of a link has changed, either by a flow frame from the peer or by
+     * sending a delivery.
+     *
+     * @param link the link
+     * @param credit the link's credit, as returned by {@link Link#getCredit()}
+     */
+    default void onFlow(Link link, int credit) {
+    }
+
+    /**
+     * Called for the {@link Event.Type}s whose context is a connection.
+     */
+    default void onConnection(Event.Type type, Connection connection) {
+    }
+
+    /**
+     * Called for the {@link Event.Type}s whose context is a session.
+     */
+    default void onSession(Event.Type type, Session session) {
+    }
+
+    /**
+     * Called for the {@link Event.Type}s other than {@link Event.Type#LINK_FLOW} whose context is a link.
+     */
+    default void onLink(Event.Type type, Link link) {
+    }
+
+    /**
+     * Called for the {@link Event.Type}s whose context is a transport.
+     */
+    default void onTransport(Event.Type type, Transport transport) {
+    }
+}
@@ -66,9 +66,12 @@ public interface Event extends Extendable
         LINK_LOCAL_CLOSE,
         LINK_REMOTE_CLOSE,
         LINK_FLOW,
+        LINK_WRITABLE,
         LINK_FINAL,
 
         DELIVERY,
+        DELIVERY_BATCH,
+        DELIVERY_EXPIRED,
 
         TRANSPORT,
         TRANSPORT_ERROR,
@@ -162,6 +165,8 @@ public interface Event extends Extendable
 
     Delivery getDelivery();
 
+    DeliveryBatch getDeliveryBatch();
+
     Transport getTransport();
 
     Reactor getReactor();
@@ -0,0 +1,62 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine;
+
+/**
+ * The times at which a connection passed each phase of its establishment, for telling whether a
+ * slow connect was spent in TCP, TLS, SASL or the AMQP open and attach exchanges.
+ *
+ * Times are {@link System#nanoTime()} values and so only comparable with each other. The
+ * durations returned by {@link #getElapsedNanos(Phase)} are measured from the creation of the
+ * transport, which for an outgoing reactor connection is just before its socket connect is started.
+ */
+public interface HandshakeTimings
+{
+    public enum Phase
+    {
+        /** The TCP connection was established, as reported by the reactor or via {@link Transport#socketConnected()}. */
+        SOCKET_CONNECTED,
+        /** The TLS handshake finished. */
+        TLS_FINISHED,
+        /** The SASL outcome was sent, by a server, or received, by a client. */
+        SASL_OUTCOME,
+        /** The Open frame was sent. */
+        OPEN_SENT,
+        /** The peer's Open frame was received. */
+        OPEN_RECEIVED,
+        /** The first link was attached in both directions. */
+        FIRST_ATTACH_ACTIVE
+    }
+
+    /**
+     * @return the time the transport was created.
+     */
+    long getStartNanos();
+
+    /**
+     * @return the time the given phase was reached, or -1 if it has not been.
+     */
+    long getNanos(Phase phase);
+
+    /**
+     * @return the time from the creation of the transport until the given phase was reached,
+     * or -1 if it has not been.
+     */
+    long getElapsedNanos(Phase phase);
+}
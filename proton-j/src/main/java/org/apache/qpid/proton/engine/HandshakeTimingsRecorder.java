@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine;
+
+import org.apache.qpid.proton.engine.impl.HandshakeTimingsRecorderImpl;
+
+/**
+ * Aggregates the {@link HandshakeTimings} of many connections into a histogram per phase, so that
+ * a regression in connection latency shows up as a shift in the phase responsible for it.
+ *
+ * A recorder is set on each transport with {@link Transport#setHandshakeTimingsRecorder(HandshakeTimingsRecorder)}
+ * and may be shared between transports used on different threads. Each histogram counts the time
+ * from the creation of the transport until the phase was reached, in buckets whose bounds are
+ * powers of two nanoseconds, so the percentiles it reports are within a factor of two.
+ */
+public interface HandshakeTimingsRecorder
+{
+    public static final class Factory
+    {
+        public static HandshakeTimingsRecorder create()
+        {
+            return new HandshakeTimingsRecorderImpl();
+        }
+    }
+
+    /**
+     * @return the number of connections that reached the given phase.
+     */
+    long getCount(HandshakeTimings.Phase phase);
+
+    /**
+     * @return the longest time taken to reach the given phase, or 0 if none did.
+     */
+    long getMaxNanos(HandshakeTimings.Phase phase);
+
+    /**
+     * @param percentile between 0 and 100.
+     * @return the upper bound of the bucket holding the given percentile of the times taken to
+     * reach the given phase, or 0 if none did.
+     */
+    long getPercentileNanos(HandshakeTimings.Phase phase, double percentile);
+
+    /**
+     * @return the counts of the histogram for the given phase, where the count at index i is of
+     * times from 2^(i-1) up to 2^i nanoseconds, and the count at index 0 of times below 1 nanosecond.
+     */
+    long[] getBucketCounts(HandshakeTimings.Phase phase);
+
+    /**
+     * Records that a connection took the given time to reach the given phase.
+     */
+    void record(HandshakeTimings.Phase phase, long elapsedNanos);
+
+    /**
+     * Clears every histogram.
+     */
+    void reset();
+}
@@ -31,4 +31,14 @@ public interface ProtonJConnection extends Connection, ProtonJEndpoint
     ProtonJSession session();
 
     int getMaxChannels();
+
+    /**
+     * Set a listener to be told of the connection's events as they happen, instead of them
+     * being put on any {@link Collector} given to {@link #collect(Collector)}.
+     *
+     * @param listener the listener, or null to go back to using the collector.
+     */
+    void setEngineListener(EngineListener listener);
+
+    EngineListener getEngineListener();
 }
@@ -18,6 +18,10 @@
  */
 package org.apache.qpid.proton.engine;
 
+import java.util.concurrent.Executor;
+
+import javax.net.ssl.SSLContext;
+
 import org.apache.qpid.proton.engine.SslDomain;
 
 /**
@@ -25,5 +29,57 @@ import org.apache.qpid.proton.engine.SslDomain;
  */
 public interface ProtonJSslDomain extends SslDomain
 {
+    /**
+     * Sets an executor used to pipeline the encryption and decryption of TLS records for transports
+     * created using this domain.
+     *
+     * Once the handshake is complete, batches of records are wrapped and unwrapped by the executor
+     * while the transport carries on with AMQP processing of the batch before, which can raise the
+     * throughput of a few busy connections beyond what a single thread can encrypt.  Record order is
+     * preserved, the executor only ever has one batch in each direction for a given transport.  The
+     * transport itself must still only be used from one thread at a time.
+     *
+     * By default no executor is set and all record processing takes place on the calling thread.
+     *
+     * @param executor the executor to use, or null to process records on the calling thread.
+     */
+    void setRecordProcessingExecutor(Executor executor);
+
+    /**
+     * @return the executor set by {@link #setRecordProcessingExecutor(Executor)}, or null if none was set.
+     */
+    Executor getRecordProcessingExecutor();
+
+    /**
+     * Sets a cache of recently validated peer certificate chains, consulted before the trust
+     * manager when verifying peers, so that a peer reconnecting with the same chain is not
+     * validated again. Only used when the peer is verified and no {@link SSLContext} has been set.
+     *
+     * By default no cache is set and every handshake validates the peer chain in full.
+     *
+     * @param cache the cache to use, or null to always validate.
+     */
+    void setPeerValidationCache(SslPeerValidationCache cache);
+
+    /**
+     * @return the cache set by {@link #setPeerValidationCache(SslPeerValidationCache)}, or null if none was set.
+     */
+    SslPeerValidationCache getPeerValidationCache();
+
+    /**
+     * Sets the contexts a server handshakes with for the server names clients ask for, so that
+     * one listener can present a different certificate for each host name. The first TLS record
+     * from a client is held back until complete so that the server name can be read from it
+     * before the engine is created.
+     *
+     * By default no mapping is set and every client handshakes with the domain's own context.
+     *
+     * @param mapping the mapping to use, or null to use the domain's own context for every client.
+     */
+    void setServerNameMapping(SslServerNameMapping mapping);
 
+    /**
+     * @return the mapping set by {@link #setServerNameMapping(SslServerNameMapping)}, or null if none was set.
+     */
+    SslServerNameMapping getServerNameMapping();
 }
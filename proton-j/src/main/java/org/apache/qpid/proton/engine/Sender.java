@@ -100,4 +100,54 @@ public interface Sender extends Link
     @Override
     public boolean advance();
 
+    /**
+     * Sets the limit on the number of bytes that may be queued on this sender without yet
+     * having been written to the transport, e.g. while the peer withholds credit.
+     *
+     * Once the limit is reached the sender is no longer {@link #isWritable() writable}, and it
+     * remains so until the queued bytes drain to half the limit, when a
+     * {@link Event.Type#LINK_WRITABLE} event is emitted.
+     *
+     * @param maxQueuedBytes the limit in bytes, or 0 (the default) for no limit.
+     */
+    public void setMaxQueuedBytes(int maxQueuedBytes);
+
+    public int getMaxQueuedBytes();
+
+    /**
+     * Sets the limit on the number of {@link #getQueued() queued} deliveries for this sender.
+     * Behaves as {@link #setMaxQueuedBytes(int)} does for bytes.
+     *
+     * @param maxQueuedDeliveries the limit in deliveries, or 0 (the default) for no limit.
+     */
+    public void setMaxQueuedDeliveries(int maxQueuedDeliveries);
+
+    public int getMaxQueuedDeliveries();
+
+    /**
+     * @return the number of bytes sent on this link that have not yet been written to the transport.
+     */
+    public int getQueuedBytes();
+
+    /**
+     * Returns whether new deliveries may be created on this sender, i.e. whether neither the
+     * limits set on the sender nor those set on its {@link Session} have been reached.  Once
+     * this returns false {@link #delivery(byte[])} throws {@link IllegalStateException} until
+     * a {@link Event.Type#LINK_WRITABLE} event has been emitted for the sender, though data
+     * may still be sent for the current delivery so that it can be completed.
+     *
+     * @return true if the sender is writable.
+     */
+    public boolean isWritable();
+
+    /**
+     * Sets the journal the data sent for each delivery on this sender is kept in until the
+     * delivery is settled, so that it can be recovered if the application fails. The journal
+     * applies to deliveries whose data is sent after it is set.
+     *
+     * @param deliveryJournal the journal, or null (the default) for none.
+     */
+    public void setDeliveryJournal(DeliveryJournal deliveryJournal);
+
+    public DeliveryJournal getDeliveryJournal();
 }
@@ -55,6 +55,30 @@ public interface Session extends Endpoint
 
     public int getOutgoingBytes();
 
+    /**
+     * Sets the limit on the number of bytes that may be queued by senders on this session
+     * without yet having been written to the transport.  Once the limit is reached no sender
+     * on the session is {@link Sender#isWritable() writable}, and none will be again until the
+     * outgoing bytes drain to half the limit, at which point a {@link Event.Type#LINK_WRITABLE}
+     * event is emitted for each sender that has become writable.
+     *
+     * @param maxOutgoingBytes the limit in bytes, or 0 (the default) for no limit.
+     */
+    public void setMaxOutgoingBytes(int maxOutgoingBytes);
+
+    public int getMaxOutgoingBytes();
+
+    /**
+     * Sets the limit on the number of deliveries that may have been advanced past by senders
+     * on this session without yet having been fully written to the transport.  Behaves as
+     * {@link #setMaxOutgoingBytes(int)} does for bytes.
+     *
+     * @param maxOutgoingDeliveries the limit in deliveries, or 0 (the default) for no limit.
+     */
+    public void setMaxOutgoingDeliveries(int maxOutgoingDeliveries);
+
+    public int getMaxOutgoingDeliveries();
+
     public long getOutgoingWindow();
 
     /**
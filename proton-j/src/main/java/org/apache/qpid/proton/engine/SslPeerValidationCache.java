@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine;
+
+import java.security.cert.X509CRL;
+import java.security.cert.X509Certificate;
+import java.util.concurrent.TimeUnit;
+
+import org.apache.qpid.proton.engine.impl.ssl.SslPeerValidationCacheImpl;
+
+/**
+ * Remembers which peer certificate chains have recently passed validation, so that a peer
+ * reconnecting with the same chain does not repeat the full PKIX path building and validation.
+ *
+ * A cache is set on a domain with {@link ProtonJSslDomain#setPeerValidationCache(SslPeerValidationCache)}
+ * and may be shared between domains to bound the number of chains they remember together. Each
+ * validation is remembered for the trust manager that made it, so a chain accepted by one domain
+ * is still validated in full by another, which may not trust the same CAs. Only successful
+ * validations are remembered, each for no longer than the time to live given on creation and
+ * never beyond the expiry of any certificate in the chain. Chains holding a certificate that has
+ * since been revoked can be dropped with {@link #invalidate(X509Certificate)} or
+ * {@link #invalidate(X509CRL)}.
+ */
+public interface SslPeerValidationCache
+{
+    public static final class Factory
+    {
+        /**
+         * @param maxEntries the number of chains to remember, beyond which the least recently
+         * used is forgotten.
+         * @param timeToLive how long a successful validation is remembered for.
+         * @param unit the unit of the time to live.
+         */
+        public static SslPeerValidationCache create(int maxEntries, long timeToLive, TimeUnit unit)
+        {
+            return new SslPeerValidationCacheImpl(maxEntries, unit.toMillis(timeToLive));
+        }
+    }
+
+    /**
+     * Forgets every chain holding the given certificate.
+     */
+    void invalidate(X509Certificate certificate);
+
+    /**
+     * Forgets every chain holding a certificate revoked by the given CRL.
+     */
+    void invalidate(X509CRL crl);
+
+    /**
+     * Forgets every chain.
+     */
+    void invalidateAll();
+
+    /**
+     * @return the number of chains currently remembered.
+     */
+    int size();
+
+    /**
+     * @return the number of validations answered from the cache.
+     */
+    long getHits();
+
+    /**
+     * @return the number of validations passed on to the trust manager.
+     */
+    long getMisses();
+
+    /**
+     * @return the number of chains forgotten to make room for others.
+     */
+    long getEvictions();
+}
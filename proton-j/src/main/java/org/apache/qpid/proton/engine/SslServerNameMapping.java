@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine;
+
+import java.util.Map;
+
+import javax.net.ssl.SSLContext;
+
+import org.apache.qpid.proton.engine.impl.ssl.SslServerNameMappingImpl;
+
+/**
+ * Maps the host names that clients ask for using the TLS Server Name Indication extension to the
+ * pre-built {@link SSLContext} a server should handshake with, so that one listener can present
+ * a different certificate for each of many host names.
+ *
+ * A mapping is set on a server domain with {@link ProtonJSslDomain#setServerNameMapping(SslServerNameMapping)}.
+ * Host names are matched ignoring case, first exactly and then against wildcard entries of the
+ * form {@code *.example.com}, which match a single leading label. Clients that do not send a
+ * server name, or ask for one that is not mapped, handshake with the domain's own context.
+ *
+ * A mapping may be changed at any time from any thread, for example to load renewed
+ * certificates. Changes only affect handshakes started afterwards.
+ */
+public interface SslServerNameMapping
+{
+    public static final class Factory
+    {
+        public static SslServerNameMapping create()
+        {
+            return new SslServerNameMappingImpl();
+        }
+    }
+
+    /**
+     * Sets the context used for the given host name, replacing any set before.
+     *
+     * @param hostname the host name, or a wildcard of the form {@code *.example.com}.
+     * @param context the context to use, or null to remove the host name from the mapping.
+     */
+    void setContext(String hostname, SSLContext context);
+
+    /**
+     * Replaces the whole mapping at once, so that no handshake sees a mix of the old and new contexts.
+     *
+     * @param contexts the contexts to use keyed by host name, as for {@link #setContext(String, SSLContext)}.
+     */
+    void setContexts(Map<String, SSLContext> contexts);
+
+    /**
+     * @param serverName the server name sent by a client, or null if none was sent.
+     * @return the context to use for the given server name, or null if it is not mapped.
+     */
+    SSLContext getContext(String serverName);
+}
@@ -143,6 +143,22 @@ public interface Transport extends Endpoint
      */
     TransportResult processInput();
 
+    /**
+     * Process input read directly from the given buffer, which remains owned by the caller.
+     *
+     * Complete frames are parsed in place where the configured layers allow it, so that no copy
+     * into the transport's own input buffer is needed; only an incomplete trailing frame is
+     * retained by the transport. On return the buffer position has been advanced past the bytes
+     * consumed. Any bytes the transport could not currently accept remain in the buffer and should
+     * be offered again later, as would be done for the {@link #capacity()} of {@link #tail()}.
+     *
+     * If the returned result indicates failure, the transport will not accept any more input.
+     *
+     * @param input the buffer holding the received bytes, read from its position up to its limit.
+     * @return the result of processing the data, which indicates success or failure.
+     */
+    TransportResult processInput(ByteBuffer input);
+
     /**
      * Has the transport produce up to size bytes placing the result
      * into dest beginning at position offset.
@@ -309,6 +325,19 @@ public interface Transport extends Endpoint
 
     boolean isEmitFlowEventOnSend();
 
+    /**
+     * Configure whether the deliveries updated by a disposition received from the peer are
+     * reported with a single {@link Event.Type#DELIVERY_BATCH} event per link, rather than
+     * a {@link Event.Type#DELIVERY} event per delivery.
+     *
+     * Defaults to false.
+     *
+     * @param emitDeliveryBatchEvents true if batch events should be emitted, false otherwise
+     */
+    void setEmitDeliveryBatchEvents(boolean emitDeliveryBatchEvents);
+
+    boolean isEmitDeliveryBatchEvents();
+
     /**
      * Set an upper limit on the size of outgoing frames that will be sent
      * to the peer. Allows constraining the transport not to emit Transfer
@@ -321,4 +350,26 @@ public interface Transport extends Endpoint
     void setOutboundFrameSizeLimit(int size);
 
     int getOutboundFrameSizeLimit();
+
+    /**
+     * @return the times at which this transport passed each phase of connection establishment.
+     */
+    HandshakeTimings getHandshakeTimings();
+
+    /**
+     * Set a recorder to aggregate the phase timings of this transport, which may be shared with
+     * other transports. Phases this transport has already reached are recorded when it is set.
+     *
+     * @param recorder the recorder, or null for none.
+     */
+    void setHandshakeTimingsRecorder(HandshakeTimingsRecorder recorder);
+
+    HandshakeTimingsRecorder getHandshakeTimingsRecorder();
+
+    /**
+     * Records that the TCP connection carrying this transport was established, for
+     * {@link HandshakeTimings.Phase#SOCKET_CONNECTED}. The reactor calls this itself;
+     * applications doing their own I/O should call it once their socket is connected.
+     */
+    void socketConnected();
 }
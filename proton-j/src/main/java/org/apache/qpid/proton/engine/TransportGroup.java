@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine;
+
+import java.util.List;
+
+import org.apache.qpid.proton.engine.impl.TransportGroupImpl;
+
+/**
+ * Processes many transports in batched phases, for event loops that own a large number of
+ * connections and would otherwise process, and check the output of, each in turn.
+ *
+ * The loop reads into the {@link Transport#tail()} of each transport with input and tells the
+ * group with {@link #inputWritten(Transport)}. A call to {@link #process()} then processes the
+ * input of all of those transports, before generating output for every transport that received
+ * input or whose connection has been changed by the application since output was last
+ * generated. It returns the transports that have output pending, which the loop writes from
+ * their {@link Transport#head()} and {@link Transport#pop(int)} in a single pass.
+ *
+ * A transport may belong to one group at a time. Groups are not thread safe, and must be used
+ * from the thread that uses their transports.
+ */
+public interface TransportGroup
+{
+    public static final class Factory
+    {
+        public static TransportGroup create()
+        {
+            return new TransportGroupImpl();
+        }
+    }
+
+    /**
+     * @throws IllegalStateException if the transport belongs to another group.
+     */
+    void add(Transport transport);
+
+    void remove(Transport transport);
+
+    int size();
+
+    /**
+     * Notes that input has been written to the tail of the given transport, to be processed
+     * by the next call to {@link #process()}.
+     */
+    void inputWritten(Transport transport);
+
+    /**
+     * Notes that the given transport should have its output generated by the next call to
+     * {@link #process()} even if its connection has not changed, such as after
+     * {@link Transport#tick(long)} or closing its tail.
+     */
+    void outputWanted(Transport transport);
+
+    /**
+     * Processes the input of every transport it was written to, then generates the output of
+     * every transport that may have some.
+     *
+     * @return the transports with output pending. The list is reused by the next call.
+     */
+    List<Transport> process();
+
+    /**
+     * @return the transports found by the last call to {@link #process()} to have closed their
+     * head, which will produce no more output. The list is reused by the next call.
+     */
+    List<Transport> getClosed();
+}
@@ -23,13 +23,17 @@ package org.apache.qpid.proton.engine.impl;
 import java.util.ArrayList;
 import java.util.EnumSet;
 import java.util.Iterator;
+import java.util.LinkedHashSet;
 import java.util.List;
 import java.util.Map;
+import java.util.Set;
 
 import org.apache.qpid.proton.amqp.Symbol;
 import org.apache.qpid.proton.amqp.transport.Open;
 import org.apache.qpid.proton.engine.Collector;
+import org.apache.qpid.proton.engine.DeliveryBatch;
 import org.apache.qpid.proton.engine.EndpointState;
+import org.apache.qpid.proton.engine.EngineListener;
 import org.apache.qpid.proton.engine.Event;
 import org.apache.qpid.proton.engine.Link;
 import org.apache.qpid.proton.engine.ProtonJConnection;
@@ -40,7 +44,7 @@ public class ConnectionImpl extends EndpointImpl implements ProtonJConnection
 {
     public static final int MAX_CHANNELS = 65535;
 
-    private List<SessionImpl> _sessions = new ArrayList<SessionImpl>();
+    private Set<SessionImpl> _sessions = new LinkedHashSet<SessionImpl>();
     private EndpointImpl _transportTail;
     private EndpointImpl _transportHead;
     private int _maxChannels = MAX_CHANNELS;
@@ -73,6 +77,7 @@ public class ConnectionImpl extends EndpointImpl implements ProtonJConnection
 
     private Object _context;
     private CollectorImpl _collector;
+    private EngineListener _engineListener;
     private Reactor _reactor;
 
     private static final Symbol[] EMPTY_SYMBOL_ARRAY = new Symbol[0];
@@ -253,6 +258,11 @@ public class ConnectionImpl extends EndpointImpl implements ProtonJConnection
             endpoint.setTransportNext(null);
             endpoint.setTransportPrev(null);
             _transportHead = _transportTail = endpoint;
+
+            if(_transport != null)
+            {
+                _transport.connectionModified();
+            }
         }
         else
         {
@@ -643,13 +653,69 @@ public class ConnectionImpl extends EndpointImpl implements ProtonJConnection
 
     EventImpl put(Event.Type type, Object context)
     {
-        if (_collector != null) {
+        if (_engineListener != null) {
+            dispatch(type, context);
+            return null;
+        } else if (_collector != null) {
             return _collector.put(type, context);
         } else {
             return null;
         }
     }
 
+    /**
+     * Reports a transfer received for the given delivery, passing the listener what it is likely
+     * to need without it having to query the delivery.
+     */
+    void putTransfer(DeliveryImpl delivery)
+    {
+        if (_engineListener != null) {
+            _engineListener.onTransfer((ReceiverImpl) delivery.getLink(), delivery,
+                                       delivery.available(), delivery.isPartial());
+        } else {
+            put(Event.Type.DELIVERY, delivery);
+        }
+    }
+
+    private void dispatch(Event.Type type, Object context)
+    {
+        if (context instanceof DeliveryImpl) {
+            DeliveryImpl delivery = (DeliveryImpl) context;
+            if (type == Event.Type.DELIVERY_EXPIRED) {
+                _engineListener.onExpired(delivery);
+            } else {
+                _engineListener.onDisposition(delivery, delivery.remotelySettled());
+            }
+        } else if (context instanceof LinkImpl) {
+            LinkImpl link = (LinkImpl) context;
+            if (type == Event.Type.LINK_FLOW) {
+                _engineListener.onFlow(link, link.getCredit());
+            } else {
+                _engineListener.onLink(type, link);
+            }
+        } else if (context instanceof DeliveryBatch) {
+            _engineListener.onDeliveryBatch((DeliveryBatch) context);
+        } else if (context instanceof SessionImpl) {
+            _engineListener.onSession(type, (SessionImpl) context);
+        } else if (context instanceof ConnectionImpl) {
+            _engineListener.onConnection(type, (ConnectionImpl) context);
+        } else if (context instanceof TransportImpl) {
+            _engineListener.onTransport(type, (TransportImpl) context);
+        }
+    }
+
+    @Override
+    public void setEngineListener(EngineListener listener)
+    {
+        _engineListener = listener;
+    }
+
+    @Override
+    public EngineListener getEngineListener()
+    {
+        return _engineListener;
+    }
+
     @Override
     void localOpen()
     {
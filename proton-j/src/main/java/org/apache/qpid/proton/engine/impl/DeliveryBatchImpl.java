@@ -0,0 +1,69 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+package org.apache.qpid.proton.engine.impl;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.Iterator;
+import java.util.List;
+
+import org.apache.qpid.proton.engine.Delivery;
+import org.apache.qpid.proton.engine.DeliveryBatch;
+
+class DeliveryBatchImpl implements DeliveryBatch
+{
+    private final LinkImpl _link;
+    private final List<Delivery> _deliveries = new ArrayList<Delivery>();
+
+    DeliveryBatchImpl(LinkImpl link)
+    {
+        _link = link;
+    }
+
+    void add(DeliveryImpl delivery)
+    {
+        _deliveries.add(delivery);
+    }
+
+    @Override
+    public LinkImpl getLink()
+    {
+        return _link;
+    }
+
+    @Override
+    public int size()
+    {
+        return _deliveries.size();
+    }
+
+    @Override
+    public Iterator<Delivery> iterator()
+    {
+        return Collections.unmodifiableList(_deliveries).iterator();
+    }
+
+    @Override
+    public String toString()
+    {
+        return "DeliveryBatchImpl [_link=" + _link + ", size=" + _deliveries.size() + "]";
+    }
+}
@@ -71,10 +71,14 @@ public class DeliveryImpl implements Delivery
     private boolean _updated;
     private boolean _done;
     private boolean _aborted;
+    private long _expiryTime;
+    private boolean _expired;
 
     private CompositeReadableBuffer _dataBuffer;
     private ReadableBuffer _dataView;
 
+    private DeliveryJournalImpl.Entry _journalEntry;
+
     DeliveryImpl(final byte[] tag, final LinkImpl link, DeliveryImpl previous)
     {
         _tag = tag;
@@ -148,6 +152,11 @@ public class DeliveryImpl implements Delivery
 
         _settled = true;
         _link.decrementUnsettled();
+        if (_journalEntry != null)
+        {
+            _journalEntry.settled();
+            _journalEntry = null;
+        }
         if(!_remoteSettled)
         {
             addToTransportWorkList();
@@ -417,6 +426,26 @@ public class DeliveryImpl implements Delivery
         getOrCreateDataBuffer().append(data);
     }
 
+    void discardData()
+    {
+        _dataView = _dataBuffer = null;
+    }
+
+    /**
+     * Discards the data yet to be sent, first marking a buffer given to sendNoCopy as read so
+     * that one which releases itself once read, such as a {@link org.apache.qpid.proton.codec.SharedPayload}
+     * view, is released.
+     */
+    void releaseData()
+    {
+        if (_dataView != null && _dataView != _dataBuffer)
+        {
+            _dataView.position(_dataView.limit());
+            _dataView.reclaimRead();
+        }
+        discardData();
+    }
+
     private CompositeReadableBuffer getOrCreateDataBuffer()
     {
         if (_dataBuffer == null)
@@ -432,6 +461,16 @@ public class DeliveryImpl implements Delivery
         getOrCreateDataBuffer().append(data);
     }
 
+    DeliveryJournalImpl.Entry getJournalEntry()
+    {
+        return _journalEntry;
+    }
+
+    void setJournalEntry(DeliveryJournalImpl.Entry journalEntry)
+    {
+        _journalEntry = journalEntry;
+    }
+
     void afterSend()
     {
         if (_dataView != null)
@@ -491,6 +530,29 @@ public class DeliveryImpl implements Delivery
         return _aborted;
     }
 
+    @Override
+    public void setExpiryTime(long expiryTime)
+    {
+        _expiryTime = expiryTime;
+    }
+
+    @Override
+    public long getExpiryTime()
+    {
+        return _expiryTime;
+    }
+
+    void setExpired()
+    {
+        _expired = true;
+    }
+
+    @Override
+    public boolean isExpired()
+    {
+        return _expired;
+    }
+
     @Override
     public boolean isPartial()
     {
@@ -0,0 +1,649 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine.impl;
+
+import java.io.File;
+import java.io.IOException;
+import java.io.RandomAccessFile;
+import java.nio.ByteBuffer;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.TreeMap;
+
+import org.apache.qpid.proton.ProtonException;
+import org.apache.qpid.proton.codec.ReadableBuffer;
+import org.apache.qpid.proton.codec.WritableBuffer;
+import org.apache.qpid.proton.engine.DeliveryJournal;
+
+public class DeliveryJournalImpl implements DeliveryJournal
+{
+    public static final int DEFAULT_SEGMENT_SIZE = 16 * 1024 * 1024;
+    private static final int MIN_SEGMENT_SIZE = 4096;
+
+    private static final String SEGMENT_PREFIX = "journal-";
+    private static final String SEGMENT_SUFFIX = ".seg";
+
+    // Each record is its length, its type and the id of its delivery, followed by
+    //   PAYLOAD:  some of the data sent for the delivery
+    //   COMPLETE: the message format, then the link name and the tag, each preceded by its length
+    // The length is written last, so a record cut short by a failure reads as the end of the segment.
+    private static final byte PAYLOAD = 1;
+    private static final byte COMPLETE = 2;
+    // Set on the type of the first record of a delivery in each of its segments once it is settled
+    private static final byte SETTLED_FLAG = (byte) 0x80;
+    private static final int LENGTH_SIZE = 4;
+    private static final int HEADER_SIZE = LENGTH_SIZE + 1 + 8;
+
+    private final File _directory;
+    private final int _segmentSize;
+    private final TreeMap<Long, Segment> _segments = new TreeMap<>();
+    private final Map<Key, Recovered> _recovered = new LinkedHashMap<>();
+
+    private Segment _active;
+    private long _nextId;
+    private int _unsettled;
+    private boolean _closed;
+
+    public DeliveryJournalImpl(File directory, int segmentSize) throws IOException
+    {
+        if (segmentSize < MIN_SEGMENT_SIZE)
+        {
+            throw new IllegalArgumentException("segmentSize must be at least " + MIN_SEGMENT_SIZE + ": " + segmentSize);
+        }
+        if (!directory.isDirectory() && !directory.mkdirs())
+        {
+            throw new IOException("Cannot create journal directory " + directory);
+        }
+
+        _directory = directory;
+        _segmentSize = segmentSize;
+        recover();
+    }
+
+    /**
+     * Appends data sent for the given delivery.
+     */
+    void sent(DeliveryImpl delivery, byte[] bytes, int offset, int length)
+    {
+        if (length == 0)
+        {
+            return;
+        }
+
+        Entry entry = entryFor(delivery);
+        do
+        {
+            int start = beginRecord(entry, PAYLOAD, 1);
+            ByteBuffer buffer = _active._buffer;
+            int chunk = Math.min(length, buffer.remaining());
+            buffer.put(bytes, offset, chunk);
+            endRecord(start);
+
+            offset += chunk;
+            length -= chunk;
+        }
+        while (length > 0);
+    }
+
+    /**
+     * Appends data sent for the given delivery, without consuming it from the given buffer.
+     */
+    void sent(DeliveryImpl delivery, ReadableBuffer data)
+    {
+        if (!data.hasRemaining())
+        {
+            return;
+        }
+        if (data.hasArray())
+        {
+            sent(delivery, data.array(), data.arrayOffset() + data.position(), data.remaining());
+            return;
+        }
+
+        Entry entry = entryFor(delivery);
+        ReadableBuffer source = data.duplicate();
+        do
+        {
+            int start = beginRecord(entry, PAYLOAD, 1);
+            ByteBuffer buffer = _active._buffer;
+            int limit = source.limit();
+            source.limit(source.position() + Math.min(source.remaining(), buffer.remaining()));
+            source.get(WritableBuffer.ByteBufferWrapper.wrap(buffer));
+            source.limit(limit);
+            endRecord(start);
+        }
+        while (source.hasRemaining());
+    }
+
+    /**
+     * Records that all the data of the given delivery has been sent, superseding any recovered
+     * delivery sent with the same tag on a link with the same name.
+     */
+    void completed(DeliveryImpl delivery)
+    {
+        Entry entry = entryFor(delivery);
+        String linkName = delivery.getLink().getName();
+        byte[] name = linkName.getBytes(StandardCharsets.UTF_8);
+        byte[] tag = delivery.getTag();
+
+        int bodySize = 4 + 2 + name.length + 2 + tag.length;
+        if (HEADER_SIZE + bodySize > _segmentSize || name.length > 0xFFFF || tag.length > 0xFFFF)
+        {
+            throw new ProtonException("Link name and delivery tag too large to journal");
+        }
+
+        int start = beginRecord(entry, COMPLETE, bodySize);
+        ByteBuffer buffer = _active._buffer;
+        buffer.putInt(delivery.getMessageFormat());
+        buffer.putShort((short) name.length);
+        buffer.put(name);
+        buffer.putShort((short) tag.length);
+        buffer.put(tag);
+        endRecord(start);
+
+        Recovered superseded = _recovered.remove(new Key(linkName, tag));
+        if (superseded != null)
+        {
+            settle(superseded);
+        }
+    }
+
+    private Entry entryFor(DeliveryImpl delivery)
+    {
+        if (_closed)
+        {
+            throw new IllegalStateException("The delivery journal is closed");
+        }
+
+        Entry entry = delivery.getJournalEntry();
+        if (entry == null)
+        {
+            entry = new Entry(_nextId++);
+            delivery.setJournalEntry(entry);
+            _unsettled++;
+        }
+        return entry;
+    }
+
+    /**
+     * Starts a record for the given entry in the active segment, first rolling to a new segment
+     * if there is no room for the header and the given number of bytes after it.
+     *
+     * @return the offset of the record, with the active segment positioned at its body.
+     */
+    private int beginRecord(Entry entry, byte type, int minimumBodySize)
+    {
+        if (_active == null || _active._buffer.remaining() < HEADER_SIZE + minimumBodySize)
+        {
+            roll();
+        }
+
+        ByteBuffer buffer = _active._buffer;
+        int start = buffer.position();
+        touch(entry, _active, start);
+        _active._dirty = true;
+
+        buffer.position(start + LENGTH_SIZE);
+        buffer.put(type);
+        buffer.putLong(entry._id);
+        return start;
+    }
+
+    private void endRecord(int start)
+    {
+        ByteBuffer buffer = _active._buffer;
+        buffer.putInt(start, buffer.position() - start - LENGTH_SIZE);
+    }
+
+    private void touch(Entry entry, Segment segment, int recordOffset)
+    {
+        List<Segment> segments = entry._segments;
+        if (segments.isEmpty() || segments.get(segments.size() - 1) != segment)
+        {
+            if (entry._offsets.length == segments.size())
+            {
+                entry._offsets = Arrays.copyOf(entry._offsets, segments.size() * 2);
+            }
+            entry._offsets[segments.size()] = recordOffset;
+            segments.add(segment);
+            segment._live++;
+        }
+    }
+
+    private void roll()
+    {
+        Segment previous = _active;
+        long sequence = _segments.isEmpty() ? 0 : _segments.lastKey() + 1;
+        try
+        {
+            _active = mapSegment(sequence, true);
+        }
+        catch (IOException e)
+        {
+            throw new ProtonException("Cannot create journal segment " + segmentName(sequence), e);
+        }
+        _segments.put(sequence, _active);
+
+        if (previous != null && previous._live == 0)
+        {
+            delete(previous);
+        }
+    }
+
+    private void settle(Entry entry)
+    {
+        if (entry._settled || _closed)
+        {
+            return;
+        }
+        entry._settled = true;
+        _unsettled--;
+
+        // The segments may be deleted in any order, so the delivery is flagged in each of them
+        // for it not to be recovered from whichever outlives the others
+        List<Segment> segments = entry._segments;
+        for (int i = 0; i < segments.size(); i++)
+        {
+            Segment segment = segments.get(i);
+            ByteBuffer buffer = segment._buffer;
+            int typeIndex = entry._offsets[i] + LENGTH_SIZE;
+            buffer.put(typeIndex, (byte) (buffer.get(typeIndex) | SETTLED_FLAG));
+            segment._dirty = true;
+
+            if (--segment._live == 0 && segment != _active)
+            {
+                delete(segment);
+            }
+        }
+    }
+
+    private void delete(Segment segment)
+    {
+        _segments.remove(segment._sequence);
+        // The mapping itself is released once the buffer is collected
+        if (!segment._file.delete())
+        {
+            segment._file.deleteOnExit();
+        }
+    }
+
+    private Segment mapSegment(long sequence, boolean create) throws IOException
+    {
+        File file = new File(_directory, segmentName(sequence));
+        try (RandomAccessFile randomAccessFile = new RandomAccessFile(file, "rw"))
+        {
+            if (create)
+            {
+                randomAccessFile.setLength(_segmentSize);
+            }
+            MappedByteBuffer buffer = randomAccessFile.getChannel().map(FileChannel.MapMode.READ_WRITE, 0, randomAccessFile.length());
+            return new Segment(sequence, file, buffer);
+        }
+    }
+
+    private static String segmentName(long sequence)
+    {
+        return String.format("%s%020d%s", SEGMENT_PREFIX, sequence, SEGMENT_SUFFIX);
+    }
+
+    private void recover() throws IOException
+    {
+        List<Long> sequences = new ArrayList<>();
+        String[] names = _directory.list();
+        for (String name : names == null ? new String[0] : names)
+        {
+            if (name.startsWith(SEGMENT_PREFIX) && name.endsWith(SEGMENT_SUFFIX))
+            {
+                try
+                {
+                    sequences.add(Long.parseLong(name.substring(SEGMENT_PREFIX.length(), name.length() - SEGMENT_SUFFIX.length())));
+                }
+                catch (NumberFormatException e)
+                {
+                    // Not one of ours
+                }
+            }
+        }
+        Collections.sort(sequences);
+
+        Map<Long, Recovered> entries = new LinkedHashMap<>();
+        for (Long sequence : sequences)
+        {
+            Segment segment = mapSegment(sequence, false);
+            _segments.put(sequence, segment);
+            scan(segment, entries);
+        }
+
+        for (Recovered entry : entries.values())
+        {
+            if (entry._settled)
+            {
+                continue;
+            }
+            if (entry._linkName == null)
+            {
+                // Never completed, so the publisher cannot have expected it to be delivered
+                settle(entry);
+                continue;
+            }
+
+            Recovered previous = _recovered.put(new Key(entry._linkName, entry._tag), entry);
+            if (previous != null)
+            {
+                settle(previous);
+            }
+        }
+
+        for (Segment segment : new ArrayList<>(_segments.values()))
+        {
+            if (segment._live == 0)
+            {
+                delete(segment);
+            }
+        }
+    }
+
+    private void scan(Segment segment, Map<Long, Recovered> entries)
+    {
+        ByteBuffer buffer = segment._buffer;
+        int position = 0;
+        while (position + HEADER_SIZE <= buffer.capacity())
+        {
+            int length = buffer.getInt(position);
+            if (length < HEADER_SIZE - LENGTH_SIZE || length > buffer.capacity() - position - LENGTH_SIZE)
+            {
+                // The end of what was written, or a record cut short
+                break;
+            }
+
+            byte type = buffer.get(position + LENGTH_SIZE);
+            long id = buffer.getLong(position + LENGTH_SIZE + 1);
+            Recovered entry = entries.get(id);
+            if (entry == null)
+            {
+                entry = new Recovered(id);
+                entry._settled = (type & SETTLED_FLAG) != 0;
+                entries.put(id, entry);
+                if (!entry._settled)
+                {
+                    _unsettled++;
+                }
+                _nextId = Math.max(_nextId, id + 1);
+            }
+
+            if (!entry._settled)
+            {
+                touch(entry, segment, position);
+
+                int body = position + HEADER_SIZE;
+                int bodyLength = length - (HEADER_SIZE - LENGTH_SIZE);
+                if ((type & ~SETTLED_FLAG) == PAYLOAD)
+                {
+                    entry.addChunk(segment, body, bodyLength);
+                }
+                else if ((type & ~SETTLED_FLAG) == COMPLETE)
+                {
+                    entry.readComplete(buffer, body);
+                }
+            }
+
+            position += LENGTH_SIZE + length;
+        }
+    }
+
+    @Override
+    public Collection<RecoveredDelivery> getRecovered()
+    {
+        return Collections.unmodifiableList(new ArrayList<RecoveredDelivery>(_recovered.values()));
+    }
+
+    @Override
+    public void discard(RecoveredDelivery delivery)
+    {
+        Recovered recovered = (Recovered) delivery;
+        if (_recovered.get(recovered.getKey()) == recovered)
+        {
+            _recovered.remove(recovered.getKey());
+            settle(recovered);
+        }
+    }
+
+    @Override
+    public int getUnsettledCount()
+    {
+        return _unsettled;
+    }
+
+    @Override
+    public int getSegmentCount()
+    {
+        return _segments.size();
+    }
+
+    @Override
+    public void flush() throws IOException
+    {
+        for (Segment segment : _segments.values())
+        {
+            if (segment._dirty)
+            {
+                segment._buffer.force();
+                segment._dirty = false;
+            }
+        }
+    }
+
+    @Override
+    public void close() throws IOException
+    {
+        if (!_closed)
+        {
+            flush();
+            _closed = true;
+            // Lets the mappings be collected once the application drops any recovered payloads
+            _segments.clear();
+            _recovered.clear();
+            _active = null;
+        }
+    }
+
+    @Override
+    public String toString()
+    {
+        return "DeliveryJournalImpl [directory=" + _directory + ", unsettled=" + _unsettled
+            + ", segments=" + _segments.size() + "]";
+    }
+
+    /**
+     * The journal's record of one delivery.
+     */
+    class Entry
+    {
+        private final long _id;
+        // The segments holding the delivery's records, which may not be consecutive, and the
+        // offset of the delivery's first record in each
+        private final List<Segment> _segments = new ArrayList<>(1);
+        private int[] _offsets = new int[1];
+        private boolean _settled;
+
+        private Entry(long id)
+        {
+            _id = id;
+        }
+
+        /**
+         * Forgets the delivery once it has been settled.
+         */
+        void settled()
+        {
+            settle(this);
+        }
+    }
+
+    private final class Recovered extends Entry implements RecoveredDelivery
+    {
+        private final List<Chunk> _chunks = new ArrayList<>(1);
+        private String _linkName;
+        private byte[] _tag;
+        private int _messageFormat;
+
+        private Recovered(long id)
+        {
+            super(id);
+        }
+
+        private void addChunk(Segment segment, int offset, int length)
+        {
+            _chunks.add(new Chunk(segment, offset, length));
+        }
+
+        private void readComplete(ByteBuffer buffer, int offset)
+        {
+            ByteBuffer body = buffer.duplicate();
+            body.position(offset);
+            _messageFormat = body.getInt();
+            byte[] name = new byte[body.getShort() & 0xFFFF];
+            body.get(name);
+            _tag = new byte[body.getShort() & 0xFFFF];
+            body.get(_tag);
+            _linkName = new String(name, StandardCharsets.UTF_8);
+        }
+
+        private Key getKey()
+        {
+            return new Key(_linkName, _tag);
+        }
+
+        @Override
+        public String getLinkName()
+        {
+            return _linkName;
+        }
+
+        @Override
+        public byte[] getTag()
+        {
+            return _tag;
+        }
+
+        @Override
+        public int getMessageFormat()
+        {
+            return _messageFormat;
+        }
+
+        @Override
+        public ReadableBuffer getPayload()
+        {
+            if (_chunks.size() == 1)
+            {
+                return ReadableBuffer.ByteBufferReader.wrap(_chunks.get(0).view());
+            }
+
+            int size = 0;
+            for (Chunk chunk : _chunks)
+            {
+                size += chunk._length;
+            }
+            ByteBuffer payload = ByteBuffer.allocate(size);
+            for (Chunk chunk : _chunks)
+            {
+                payload.put(chunk.view());
+            }
+            payload.flip();
+            return ReadableBuffer.ByteBufferReader.wrap(payload);
+        }
+    }
+
+    private static final class Chunk
+    {
+        private final Segment _segment;
+        private final int _offset;
+        private final int _length;
+
+        private Chunk(Segment segment, int offset, int length)
+        {
+            _segment = segment;
+            _offset = offset;
+            _length = length;
+        }
+
+        private ByteBuffer view()
+        {
+            ByteBuffer view = _segment._buffer.duplicate();
+            view.limit(_offset + _length);
+            view.position(_offset);
+            return view.slice();
+        }
+    }
+
+    private static final class Segment
+    {
+        private final long _sequence;
+        private final File _file;
+        private final MappedByteBuffer _buffer;
+        // The number of unsettled deliveries with records in the segment
+        private int _live;
+        private boolean _dirty;
+
+        private Segment(long sequence, File file, MappedByteBuffer buffer)
+        {
+            _sequence = sequence;
+            _file = file;
+            _buffer = buffer;
+        }
+    }
+
+    private static final class Key
+    {
+        private final String _linkName;
+        private final byte[] _tag;
+
+        private Key(String linkName, byte[] tag)
+        {
+            _linkName = linkName;
+            _tag = tag;
+        }
+
+        @Override
+        public int hashCode()
+        {
+            return 31 * _linkName.hashCode() + Arrays.hashCode(_tag);
+        }
+
+        @Override
+        public boolean equals(Object obj)
+        {
+            if (!(obj instanceof Key))
+            {
+                return false;
+            }
+            Key other = (Key) obj;
+            return _linkName.equals(other._linkName) && Arrays.equals(_tag, other._tag);
+        }
+    }
+}
@@ -24,6 +24,7 @@ import java.util.Iterator;
 
 import org.apache.qpid.proton.engine.Connection;
 import org.apache.qpid.proton.engine.Delivery;
+import org.apache.qpid.proton.engine.DeliveryBatch;
 import org.apache.qpid.proton.engine.Event;
 import org.apache.qpid.proton.engine.EventType;
 import org.apache.qpid.proton.engine.Handler;
@@ -185,6 +186,8 @@ class EventImpl implements Event
     {
         if (context instanceof Link) {
             return (Link) context;
+        } else if (context instanceof DeliveryBatch) {
+            return ((DeliveryBatch) context).getLink();
         } else {
             Delivery dlv = getDelivery();
             if (dlv == null) {
@@ -232,6 +235,16 @@ class EventImpl implements Event
         }
     }
 
+    @Override
+    public DeliveryBatch getDeliveryBatch()
+    {
+        if (context instanceof DeliveryBatch) {
+            return (DeliveryBatch) context;
+        } else {
+            return null;
+        }
+    }
+
     @Override
     public Transport getTransport()
     {
@@ -275,6 +288,8 @@ class EventImpl implements Event
             return ((Delivery)context).getLink().getSession().getConnection().getReactor();
         } else if (context instanceof Link) {
             return ((Link)context).getSession().getConnection().getReactor();
+        } else if (context instanceof DeliveryBatch) {
+            return ((DeliveryBatch)context).getLink().getSession().getConnection().getReactor();
         } else if (context instanceof Session) {
             return ((Session)context).getConnection().getReactor();
         } else if (context instanceof Connection) {
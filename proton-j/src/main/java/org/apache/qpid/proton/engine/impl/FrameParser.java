@@ -23,6 +23,7 @@ package org.apache.qpid.proton.engine.impl;
 
 import static org.apache.qpid.proton.engine.impl.AmqpHeader.HEADER;
 import static org.apache.qpid.proton.engine.impl.ByteBufferUtils.newWriteableBuffer;
+import static org.apache.qpid.proton.engine.impl.ByteBufferUtils.pour;
 
 import java.nio.ByteBuffer;
 import java.util.logging.Level;
@@ -543,6 +544,37 @@ class FrameParser implements TransportInput
         }
     }
 
+    /**
+     * Parses frames directly from the given buffer rather than first copying it into
+     * the input buffer.  Only an incomplete trailing frame is copied, and bytes that
+     * arrive while a frame is being held are retained up to the input buffer capacity.
+     */
+    @Override
+    public void process(ByteBuffer input) throws TransportException
+    {
+        if (_tail_closed)
+        {
+            throw new TransportException("tail closed");
+        }
+
+        // Bytes retained from earlier input must be parsed ahead of the new ones.
+        while (_inputBuffer != null && _inputBuffer.position() > 0 && input.hasRemaining() && capacity() > 0)
+        {
+            pour(input, _inputBuffer);
+            process();
+        }
+
+        if ((_inputBuffer == null || _inputBuffer.position() == 0) && input.hasRemaining() && !_tail_closed)
+        {
+            input(input);
+
+            if (input.hasRemaining() && !_tail_closed)
+            {
+                pour(input, tail());
+            }
+        }
+    }
+
     @Override
     public void close_tail()
     {
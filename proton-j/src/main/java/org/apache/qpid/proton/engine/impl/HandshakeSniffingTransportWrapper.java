@@ -116,6 +116,19 @@ public abstract class HandshakeSniffingTransportWrapper<T1 extends TransportWrap
         }
     }
 
+    @Override
+    public void process(ByteBuffer input) throws TransportException
+    {
+        if (isDeterminationMade())
+        {
+            _selectedTransportWrapper.process(input);
+        }
+        else
+        {
+            TransportWrapper.super.process(input);
+        }
+    }
+
     @Override
     public void close_tail()
     {
@@ -0,0 +1,115 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine.impl;
+
+import java.util.EnumMap;
+import java.util.Map;
+
+import org.apache.qpid.proton.engine.HandshakeTimings;
+import org.apache.qpid.proton.engine.HandshakeTimingsRecorder;
+
+public class HandshakeTimingsImpl implements HandshakeTimings
+{
+    private final long _startNanos = System.nanoTime();
+    private final long[] _nanos = new long[Phase.values().length];
+    private HandshakeTimingsRecorder _recorder;
+
+    HandshakeTimingsImpl()
+    {
+        for (int i = 0; i < _nanos.length; i++)
+        {
+            _nanos[i] = -1;
+        }
+    }
+
+    /**
+     * Records the current time against the given phase, unless it was reached earlier.
+     */
+    public void phaseReached(Phase phase)
+    {
+        int index = phase.ordinal();
+        if (_nanos[index] == -1)
+        {
+            long now = System.nanoTime();
+            _nanos[index] = now;
+            if (_recorder != null)
+            {
+                _recorder.record(phase, now - _startNanos);
+            }
+        }
+    }
+
+    /**
+     * Sets the recorder, recording into it the phases already reached, such as the socket having
+     * connected before the handlers of an accepted connection could set it.
+     */
+    void setRecorder(HandshakeTimingsRecorder recorder)
+    {
+        if (recorder != null && recorder != _recorder)
+        {
+            for (Phase phase : Phase.values())
+            {
+                long nanos = _nanos[phase.ordinal()];
+                if (nanos != -1)
+                {
+                    recorder.record(phase, nanos - _startNanos);
+                }
+            }
+        }
+        _recorder = recorder;
+    }
+
+    HandshakeTimingsRecorder getRecorder()
+    {
+        return _recorder;
+    }
+
+    @Override
+    public long getStartNanos()
+    {
+        return _startNanos;
+    }
+
+    @Override
+    public long getNanos(Phase phase)
+    {
+        return _nanos[phase.ordinal()];
+    }
+
+    @Override
+    public long getElapsedNanos(Phase phase)
+    {
+        long nanos = _nanos[phase.ordinal()];
+        return nanos == -1 ? -1 : nanos - _startNanos;
+    }
+
+    @Override
+    public String toString()
+    {
+        Map<Phase, Long> elapsed = new EnumMap<Phase, Long>(Phase.class);
+        for (Phase phase : Phase.values())
+        {
+            if (_nanos[phase.ordinal()] != -1)
+            {
+                elapsed.put(phase, getElapsedNanos(phase));
+            }
+        }
+        return "HandshakeTimingsImpl " + elapsed;
+    }
+}
@@ -0,0 +1,159 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine.impl;
+
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.atomic.AtomicLongArray;
+
+import org.apache.qpid.proton.engine.HandshakeTimings.Phase;
+import org.apache.qpid.proton.engine.HandshakeTimingsRecorder;
+
+public class HandshakeTimingsRecorderImpl implements HandshakeTimingsRecorder
+{
+    private static final int BUCKETS = 64;
+
+    private final AtomicLongArray[] _buckets = new AtomicLongArray[Phase.values().length];
+    private final AtomicLong[] _max = new AtomicLong[Phase.values().length];
+
+    public HandshakeTimingsRecorderImpl()
+    {
+        for (int i = 0; i < _buckets.length; i++)
+        {
+            _buckets[i] = new AtomicLongArray(BUCKETS);
+            _max[i] = new AtomicLong();
+        }
+    }
+
+    @Override
+    public void record(Phase phase, long elapsedNanos)
+    {
+        long nanos = Math.max(0, elapsedNanos);
+        _buckets[phase.ordinal()].incrementAndGet(bucketOf(nanos));
+
+        AtomicLong max = _max[phase.ordinal()];
+        long current;
+        while ((current = max.get()) < nanos && !max.compareAndSet(current, nanos))
+        {
+            // Lost the race to another recording, so try again
+        }
+    }
+
+    @Override
+    public long getCount(Phase phase)
+    {
+        long count = 0;
+        AtomicLongArray buckets = _buckets[phase.ordinal()];
+        for (int i = 0; i < BUCKETS; i++)
+        {
+            count += buckets.get(i);
+        }
+        return count;
+    }
+
+    @Override
+    public long getMaxNanos(Phase phase)
+    {
+        return _max[phase.ordinal()].get();
+    }
+
+    @Override
+    public long getPercentileNanos(Phase phase, double percentile)
+    {
+        if (percentile < 0 || percentile > 100)
+        {
+            throw new IllegalArgumentException("percentile must be between 0 and 100: " + percentile);
+        }
+
+        long[] counts = getBucketCounts(phase);
+        long total = 0;
+        for (long count : counts)
+        {
+            total += count;
+        }
+        if (total == 0)
+        {
+            return 0;
+        }
+
+        long rank = Math.max(1, (long) Math.ceil(total * percentile / 100));
+        long seen = 0;
+        for (int i = 0; i < BUCKETS; i++)
+        {
+            seen += counts[i];
+            if (seen >= rank)
+            {
+                return Math.min(upperBoundOf(i), getMaxNanos(phase));
+            }
+        }
+        return getMaxNanos(phase);
+    }
+
+    @Override
+    public long[] getBucketCounts(Phase phase)
+    {
+        long[] counts = new long[BUCKETS];
+        AtomicLongArray buckets = _buckets[phase.ordinal()];
+        for (int i = 0; i < BUCKETS; i++)
+        {
+            counts[i] = buckets.get(i);
+        }
+        return counts;
+    }
+
+    @Override
+    public void reset()
+    {
+        for (int i = 0; i < _buckets.length; i++)
+        {
+            for (int j = 0; j < BUCKETS; j++)
+            {
+                _buckets[i].set(j, 0);
+            }
+            _max[i].set(0);
+        }
+    }
+
+    static int bucketOf(long nanos)
+    {
+        return Math.min(BUCKETS - 1, 64 - Long.numberOfLeadingZeros(nanos));
+    }
+
+    private static long upperBoundOf(int bucket)
+    {
+        return bucket >= BUCKETS - 1 ? Long.MAX_VALUE : (1L << bucket) - 1;
+    }
+
+    @Override
+    public String toString()
+    {
+        StringBuilder builder = new StringBuilder("HandshakeTimingsRecorderImpl [");
+        for (Phase phase : Phase.values())
+        {
+            if (phase.ordinal() > 0)
+            {
+                builder.append(", ");
+            }
+            builder.append(phase).append("=[count=").append(getCount(phase))
+                   .append(", p50=").append(getPercentileNanos(phase, 50))
+                   .append(", p99=").append(getPercentileNanos(phase, 99))
+                   .append(", max=").append(getMaxNanos(phase)).append("]");
+        }
+        return builder.append("]").toString();
+    }
+}
@@ -60,6 +60,12 @@ public class PlainTransportWrapper implements TransportWrapper
         _inputProcessor.process();
     }
 
+    @Override
+    public void process(ByteBuffer input) throws TransportException
+    {
+        _inputProcessor.process(input);
+    }
+
     @Override
     public void close_tail()
     {
@@ -41,6 +41,7 @@ import org.apache.qpid.proton.amqp.security.SaslResponse;
 import org.apache.qpid.proton.codec.AMQPDefinedTypes;
 import org.apache.qpid.proton.codec.DecoderImpl;
 import org.apache.qpid.proton.codec.EncoderImpl;
+import org.apache.qpid.proton.engine.HandshakeTimings.Phase;
 import org.apache.qpid.proton.engine.Sasl;
 import org.apache.qpid.proton.engine.SaslListener;
 import org.apache.qpid.proton.engine.Transport;
@@ -97,7 +98,8 @@ public class SaslImpl implements Sasl, SaslFrameBody.SaslFrameBodyHandler<Void>,
         _transport = transport;
         _maxFrameSize = maxFrameSize;
 
-        AMQPDefinedTypes.registerAllTypes(_decoder,_encoder);
+        // Only SASL frames pass through this codec
+        AMQPDefinedTypes.registerSecurityTypes(_decoder,_encoder);
         _frameParser = new SaslFrameParser(this, _decoder, maxFrameSize);
         _frameWriter = new FrameWriter(_encoder, maxFrameSize, FrameWriter.SASL_FRAME_TYPE, null, _transport);
     }
@@ -155,6 +157,7 @@ public class SaslImpl implements Sasl, SaslFrameBody.SaslFrameBodyHandler<Void>,
                 }
                 writeFrame(outcome);
                 setChallengeResponse(null);
+                _transport.getHandshakeTimingsImpl().phaseReached(Phase.SASL_OUTCOME);
             }
         }
         else if(_role == Role.CLIENT)
@@ -416,6 +419,7 @@ public class SaslImpl implements Sasl, SaslFrameBody.SaslFrameBodyHandler<Void>,
             }
         }
         _done = true;
+        _transport.getHandshakeTimingsImpl().phaseReached(Phase.SASL_OUTCOME);
 
         if(_logger.isLoggable(Level.FINE))
         {
@@ -805,6 +809,11 @@ public class SaslImpl implements Sasl, SaslFrameBody.SaslFrameBodyHandler<Void>,
             currentInput.process();
         }
 
+        @Override
+        public void process(ByteBuffer input) throws TransportException {
+            currentInput.process(input);
+        }
+
         @Override
         public void close_tail() {
             currentInput.close_tail();
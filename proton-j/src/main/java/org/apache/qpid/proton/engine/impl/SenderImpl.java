@@ -21,13 +21,21 @@
 package org.apache.qpid.proton.engine.impl;
 
 import org.apache.qpid.proton.codec.ReadableBuffer;
+import org.apache.qpid.proton.engine.DeliveryJournal;
 import org.apache.qpid.proton.engine.EndpointState;
+import org.apache.qpid.proton.engine.Event;
 import org.apache.qpid.proton.engine.Sender;
 
 public class SenderImpl  extends LinkImpl implements Sender
 {
     private int _offered;
     private TransportSender _transportLink;
+    private int _queuedBytes;
+    private int _maxQueuedBytes;
+    private int _maxQueuedDeliveries;
+    private boolean _queueBlocked;
+    private boolean _writable = true;
+    private DeliveryJournalImpl _deliveryJournal;
 
     SenderImpl(SessionImpl session, String name)
     {
@@ -52,9 +60,13 @@ public class SenderImpl  extends LinkImpl implements Sender
         {
             throw new IllegalArgumentException();//TODO.
         }
+        if (_deliveryJournal != null)
+        {
+            _deliveryJournal.sent(current, bytes, offset, length);
+        }
         int sent = current.send(bytes, offset, length);
         if (sent > 0) {
-            getSession().incrementOutgoingBytes(sent);
+            incrementOutgoingBytes(sent);
         }
         return sent;
     }
@@ -71,9 +83,13 @@ public class SenderImpl  extends LinkImpl implements Sender
         {
             throw new IllegalArgumentException();
         }
+        if (_deliveryJournal != null)
+        {
+            _deliveryJournal.sent(current, buffer);
+        }
         int sent = current.send(buffer);
         if (sent > 0) {
-            getSession().incrementOutgoingBytes(sent);
+            incrementOutgoingBytes(sent);
         }
         return sent;
     }
@@ -90,13 +106,128 @@ public class SenderImpl  extends LinkImpl implements Sender
         {
             throw new IllegalArgumentException();
         }
+        if (_deliveryJournal != null)
+        {
+            _deliveryJournal.sent(current, buffer);
+        }
         int sent = current.sendNoCopy(buffer);
         if (sent > 0) {
-            getSession().incrementOutgoingBytes(sent);
+            incrementOutgoingBytes(sent);
         }
         return sent;
     }
 
+    @Override
+    public DeliveryImpl delivery(byte[] tag, int offset, int length)
+    {
+        if (!_writable)
+        {
+            throw new IllegalStateException("delivery not allowed while the sender's outgoing limits are exceeded.");
+        }
+        DeliveryImpl delivery = super.delivery(tag, offset, length);
+        updateWritable();
+        return delivery;
+    }
+
+    void incrementOutgoingBytes(int delta)
+    {
+        _queuedBytes += delta;
+        getSession().incrementOutgoingBytes(delta);
+        updateWritable();
+    }
+
+    @Override
+    void decrementQueued()
+    {
+        super.decrementQueued();
+        updateWritable();
+    }
+
+    @Override
+    public int getQueuedBytes()
+    {
+        return _queuedBytes;
+    }
+
+    @Override
+    public void setMaxQueuedBytes(int maxQueuedBytes)
+    {
+        if (maxQueuedBytes < 0)
+        {
+            throw new IllegalArgumentException("Max queued bytes must not be negative: " + maxQueuedBytes);
+        }
+        _maxQueuedBytes = maxQueuedBytes;
+        updateWritable();
+    }
+
+    @Override
+    public int getMaxQueuedBytes()
+    {
+        return _maxQueuedBytes;
+    }
+
+    @Override
+    public void setMaxQueuedDeliveries(int maxQueuedDeliveries)
+    {
+        if (maxQueuedDeliveries < 0)
+        {
+            throw new IllegalArgumentException("Max queued deliveries must not be negative: " + maxQueuedDeliveries);
+        }
+        _maxQueuedDeliveries = maxQueuedDeliveries;
+        updateWritable();
+    }
+
+    @Override
+    public int getMaxQueuedDeliveries()
+    {
+        return _maxQueuedDeliveries;
+    }
+
+    @Override
+    public boolean isWritable()
+    {
+        return _writable;
+    }
+
+    /**
+     * Re-evaluates whether the sender is writable after the amount of data queued on it or on
+     * its session has changed, emitting a {@link Event.Type#LINK_WRITABLE} event if it has
+     * become writable again.  The limits are applied with hysteresis: once reached, they stop
+     * applying only when the queued amount has drained to half the limit.
+     */
+    void updateWritable()
+    {
+        if (_queueBlocked)
+        {
+            _queueBlocked = !(SessionImpl.isBelowLowWater(_queuedBytes, _maxQueuedBytes)
+                              && SessionImpl.isBelowLowWater(getQueued(), _maxQueuedDeliveries));
+        }
+        else
+        {
+            _queueBlocked = SessionImpl.isAtLimit(_queuedBytes, _maxQueuedBytes)
+                            || SessionImpl.isAtLimit(getQueued(), _maxQueuedDeliveries);
+        }
+
+        boolean writable = !_queueBlocked && !getSession().isOutgoingBlocked();
+        if (writable && !_writable && getLocalState() != EndpointState.CLOSED)
+        {
+            getConnectionImpl().put(Event.Type.LINK_WRITABLE, this);
+        }
+        _writable = writable;
+    }
+
+    @Override
+    public void setDeliveryJournal(DeliveryJournal deliveryJournal)
+    {
+        _deliveryJournal = (DeliveryJournalImpl) deliveryJournal;
+    }
+
+    @Override
+    public DeliveryJournal getDeliveryJournal()
+    {
+        return _deliveryJournal;
+    }
+
     @Override
     public void abort()
     {
@@ -116,6 +247,10 @@ public class SenderImpl  extends LinkImpl implements Sender
         DeliveryImpl delivery = current();
         if (delivery != null) {
             delivery.setComplete();
+            if (_deliveryJournal != null)
+            {
+                _deliveryJournal.completed(delivery);
+            }
         }
 
         boolean advance = super.advance();
@@ -45,6 +45,9 @@ public class SessionImpl extends EndpointImpl implements ProtonJSession
     private int _outgoingBytes = 0;
     private int _incomingDeliveries = 0;
     private int _outgoingDeliveries = 0;
+    private int _maxOutgoingBytes = 0;
+    private int _maxOutgoingDeliveries = 0;
+    private boolean _outgoingBlocked;
     private long _outgoingWindow = Integer.MAX_VALUE;
     private Map<Symbol, Object> _properties;
     private Map<Symbol, Object> _remoteProperties;
@@ -248,6 +251,7 @@ public class SessionImpl extends EndpointImpl implements ProtonJSession
     void incrementOutgoingBytes(int delta)
     {
         _outgoingBytes += delta;
+        updateOutgoingBlocked();
     }
 
     void incrementIncomingDeliveries(int delta)
@@ -263,6 +267,80 @@ public class SessionImpl extends EndpointImpl implements ProtonJSession
     void incrementOutgoingDeliveries(int delta)
     {
         _outgoingDeliveries += delta;
+        updateOutgoingBlocked();
+    }
+
+    @Override
+    public void setMaxOutgoingBytes(int maxOutgoingBytes)
+    {
+        if (maxOutgoingBytes < 0)
+        {
+            throw new IllegalArgumentException("Max outgoing bytes must not be negative: " + maxOutgoingBytes);
+        }
+        _maxOutgoingBytes = maxOutgoingBytes;
+        updateOutgoingBlocked();
+    }
+
+    @Override
+    public int getMaxOutgoingBytes()
+    {
+        return _maxOutgoingBytes;
+    }
+
+    @Override
+    public void setMaxOutgoingDeliveries(int maxOutgoingDeliveries)
+    {
+        if (maxOutgoingDeliveries < 0)
+        {
+            throw new IllegalArgumentException("Max outgoing deliveries must not be negative: " + maxOutgoingDeliveries);
+        }
+        _maxOutgoingDeliveries = maxOutgoingDeliveries;
+        updateOutgoingBlocked();
+    }
+
+    @Override
+    public int getMaxOutgoingDeliveries()
+    {
+        return _maxOutgoingDeliveries;
+    }
+
+    boolean isOutgoingBlocked()
+    {
+        return _outgoingBlocked;
+    }
+
+    private void updateOutgoingBlocked()
+    {
+        boolean blocked;
+        if (_outgoingBlocked)
+        {
+            blocked = !(isBelowLowWater(_outgoingBytes, _maxOutgoingBytes)
+                        && isBelowLowWater(_outgoingDeliveries, _maxOutgoingDeliveries));
+        }
+        else
+        {
+            blocked = isAtLimit(_outgoingBytes, _maxOutgoingBytes)
+                      || isAtLimit(_outgoingDeliveries, _maxOutgoingDeliveries);
+        }
+
+        if (blocked != _outgoingBlocked)
+        {
+            _outgoingBlocked = blocked;
+            for (SenderImpl sender : _senders.values())
+            {
+                sender.updateWritable();
+            }
+        }
+    }
+
+    static boolean isAtLimit(int count, int limit)
+    {
+        return limit > 0 && count >= limit;
+    }
+
+    static boolean isBelowLowWater(int count, int limit)
+    {
+        return limit <= 0 || count <= limit / 2;
     }
 
     @Override
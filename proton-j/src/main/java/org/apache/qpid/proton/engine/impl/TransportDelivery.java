@@ -29,6 +29,7 @@ public class TransportDelivery
     private DeliveryImpl _delivery;
     private TransportLink _transportLink;
     private int _sessionSize = 1;
+    private long _incomingSize;
 
     TransportDelivery(UnsignedInteger currentDeliveryId, DeliveryImpl delivery, TransportLink transportLink)
     {
@@ -57,6 +58,17 @@ public class TransportDelivery
         return _sessionSize;
     }
 
+    /**
+     * Adds to the number of payload bytes received for the delivery so far.
+     *
+     * @return the new total.
+     */
+    long addIncomingSize(int size)
+    {
+        _incomingSize += size;
+        return _incomingSize;
+    }
+
     void settled()
     {
         _transportLink.settled(this);
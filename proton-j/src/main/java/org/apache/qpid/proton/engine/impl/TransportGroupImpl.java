@@ -0,0 +1,191 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine.impl;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import org.apache.qpid.proton.engine.Transport;
+import org.apache.qpid.proton.engine.TransportGroup;
+
+public class TransportGroupImpl implements TransportGroup
+{
+    private int _size;
+
+    // A transport is queued at most once per queue, which it records itself, and is only
+    // worked on by the group whose queue it is recorded as being in
+    private ArrayList<TransportImpl> _inputQueue = new ArrayList<TransportImpl>();
+    private ArrayList<TransportImpl> _outputQueue = new ArrayList<TransportImpl>();
+    private ArrayList<TransportImpl> _processingOutput = new ArrayList<TransportImpl>();
+
+    private final ArrayList<Transport> _withOutput = new ArrayList<Transport>();
+    private final ArrayList<Transport> _closed = new ArrayList<Transport>();
+
+    @Override
+    public void add(Transport transport)
+    {
+        TransportImpl transportImpl = (TransportImpl) transport;
+        if (transportImpl.getTransportGroup() == this)
+        {
+            return;
+        }
+        if (transportImpl.getTransportGroup() != null)
+        {
+            throw new IllegalStateException("Transport already belongs to another group");
+        }
+
+        transportImpl.setTransportGroup(this);
+        _size++;
+
+        // Whatever has happened to the transport before now has not been seen by the group
+        queueOutput(transportImpl);
+    }
+
+    @Override
+    public void remove(Transport transport)
+    {
+        TransportImpl transportImpl = (TransportImpl) transport;
+        if (transportImpl.getTransportGroup() == this)
+        {
+            // Left in any queue it is in, to be skipped over when the queue is next worked through
+            transportImpl.setTransportGroup(null);
+            _size--;
+        }
+    }
+
+    @Override
+    public int size()
+    {
+        return _size;
+    }
+
+    @Override
+    public void inputWritten(Transport transport)
+    {
+        TransportImpl transportImpl = member(transport);
+        if (transportImpl._inputQueuedBy != this)
+        {
+            transportImpl._inputQueuedBy = this;
+            _inputQueue.add(transportImpl);
+        }
+    }
+
+    @Override
+    public void outputWanted(Transport transport)
+    {
+        queueOutput(member(transport));
+    }
+
+    void queueOutput(TransportImpl transport)
+    {
+        if (transport._outputQueuedBy != this)
+        {
+            transport._outputQueuedBy = this;
+            _outputQueue.add(transport);
+        }
+    }
+
+    @Override
+    public List<Transport> process()
+    {
+        _withOutput.clear();
+        _closed.clear();
+
+        // Process all the input first, so that the output generated for each transport answers
+        // everything it received
+        ArrayList<TransportImpl> inputQueue = _inputQueue;
+        for (int i = 0; i < inputQueue.size(); i++)
+        {
+            TransportImpl transport = inputQueue.get(i);
+            if (transport._inputQueuedBy != this)
+            {
+                continue;
+            }
+            transport._inputQueuedBy = null;
+
+            if (transport.getTransportGroup() == this)
+            {
+                // A failure closes the transport's head, so it is reported as closed below
+                transport.processInput();
+                queueOutput(transport);
+            }
+        }
+        inputQueue.clear();
+
+        // Anything queued while generating output is left for the next call
+        ArrayList<TransportImpl> outputQueue = _outputQueue;
+        _outputQueue = _processingOutput;
+        _processingOutput = outputQueue;
+
+        for (int i = 0; i < outputQueue.size(); i++)
+        {
+            TransportImpl transport = outputQueue.get(i);
+            if (transport._outputQueuedBy != this || transport.getTransportGroup() != this)
+            {
+                if (transport._outputQueuedBy == this)
+                {
+                    transport._outputQueuedBy = null;
+                }
+                continue;
+            }
+
+            // Still recorded as queued while generating output, so that the changes made
+            // doing so do not queue it again
+            int pending = transport.pending();
+            transport._outputQueuedBy = null;
+
+            if (pending > 0)
+            {
+                _withOutput.add(transport);
+
+                // Checked again next time, in case not all of its output is written
+                queueOutput(transport);
+            }
+            else if (pending < 0)
+            {
+                _closed.add(transport);
+            }
+            else if (transport.hasModifiedEndpoints())
+            {
+                // Changes that could not be acted on yet, such as a detach held back until
+                // queued deliveries are sent, are not reported again so must be kept track of
+                queueOutput(transport);
+            }
+        }
+        outputQueue.clear();
+
+        return _withOutput;
+    }
+
+    @Override
+    public List<Transport> getClosed()
+    {
+        return _closed;
+    }
+
+    private TransportImpl member(Transport transport)
+    {
+        TransportImpl transportImpl = (TransportImpl) transport;
+        if (transportImpl.getTransportGroup() != this)
+        {
+            throw new IllegalArgumentException("Transport does not belong to this group");
+        }
+        return transportImpl;
+    }
+}
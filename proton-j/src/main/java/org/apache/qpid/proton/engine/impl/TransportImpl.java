@@ -23,8 +23,10 @@ import static org.apache.qpid.proton.engine.impl.ByteBufferUtils.pourBufferToArr
 import java.nio.ByteBuffer;
 import java.util.ArrayList;
 import java.util.HashMap;
+import java.util.HashSet;
 import java.util.List;
 import java.util.Map;
+import java.util.Set;
 
 import org.apache.qpid.proton.amqp.Binary;
 import org.apache.qpid.proton.amqp.Symbol;
@@ -51,6 +53,9 @@ import org.apache.qpid.proton.codec.ReadableBuffer;
 import org.apache.qpid.proton.engine.Connection;
 import org.apache.qpid.proton.engine.EndpointState;
 import org.apache.qpid.proton.engine.Event;
+import org.apache.qpid.proton.engine.HandshakeTimings;
+import org.apache.qpid.proton.engine.HandshakeTimings.Phase;
+import org.apache.qpid.proton.engine.HandshakeTimingsRecorder;
 import org.apache.qpid.proton.engine.ProtonJTransport;
 import org.apache.qpid.proton.engine.Sasl;
 import org.apache.qpid.proton.engine.Ssl;
@@ -95,6 +100,8 @@ public class TransportImpl extends EndpointImpl
     private boolean _headerWritten;
     private Map<Integer, TransportSession> _remoteSessions = new HashMap<Integer, TransportSession>();
     private Map<Integer, TransportSession> _localSessions = new HashMap<Integer, TransportSession>();
+    // No channel below this is free, so allocation need not look at those again
+    private int _lowestFreeLocalChannel;
 
     private TransportInput _inputProcessor;
     private TransportOutput _outputProcessor;
@@ -121,6 +128,9 @@ public class TransportImpl extends EndpointImpl
     private boolean _init;
     private boolean _processingStarted;
     private boolean _emitFlowEventOnSend = true;
+    private boolean _emitDeliveryBatchEvents;
+    // The time queued deliveries are checked for expiry against, read at most once per pass
+    private long _expiryCheckTime;
     private boolean _useReadOnlyOutputBuffer = true;
 
     private FrameHandler _frameHandler = this;
@@ -147,6 +157,12 @@ public class TransportImpl extends EndpointImpl
 
     private final PartialTransferHandler partialTransferHandler = new PartialTransferHandler();
 
+    private final HandshakeTimingsImpl _handshakeTimings = new HandshakeTimingsImpl();
+
+    private TransportGroupImpl _transportGroup;
+    TransportGroupImpl _inputQueuedBy;
+    TransportGroupImpl _outputQueuedBy;
+
     /**
      * Application code should use {@link org.apache.qpid.proton.engine.Transport.Factory#create()} instead
      */
@@ -162,7 +178,7 @@ public class TransportImpl extends EndpointImpl
      */
     TransportImpl(int maxFrameSize)
     {
-        AMQPDefinedTypes.registerAllTypes(_decoder, _encoder);
+        AMQPDefinedTypes.registerAllTypesLazily(_decoder, _encoder);
 
         _maxFrameSize = maxFrameSize;
         _frameWriter = new FrameWriter(_encoder, _remoteMaxFrameSize,
@@ -274,6 +290,9 @@ public class TransportImpl extends EndpointImpl
 
             _frameParser.flush();
         }
+
+        // The connection may have been changed before it was bound
+        connectionModified();
     }
 
     @Override
@@ -389,7 +408,7 @@ public class TransportImpl extends EndpointImpl
         if (_ssl == null)
         {
             init();
-            _ssl = new SslImpl(sslDomain, sslPeerDetails);
+            _ssl = new SslImpl(sslDomain, sslPeerDetails, _handshakeTimings);
             TransportWrapper transportWrapper = _ssl.wrap(_inputProcessor, _outputProcessor);
             _inputProcessor = transportWrapper;
             _outputProcessor = transportWrapper;
@@ -510,6 +529,7 @@ public class TransportImpl extends EndpointImpl
     {
         if(_connectionEndpoint != null && _isOpenSent && !_isCloseSent)
         {
+            _expiryCheckTime = 0;
             DeliveryImpl delivery = _connectionEndpoint.getTransportWorkHead();
             while(delivery != null)
             {
@@ -531,6 +551,41 @@ public class TransportImpl extends EndpointImpl
         }
     }
 
+    /**
+     * @return true if the given delivery has been advanced past, has not started to be written,
+     * and its expiry time has passed.
+     */
+    private boolean isExpiredBeforeSending(DeliveryImpl delivery, SenderImpl snd, TransportSender tpLink)
+    {
+        if(delivery.isDone() || delivery.getTransportDelivery() != null || delivery == snd.current()
+           || (tpLink != null && tpLink.getInProgressDelivery() == delivery))
+        {
+            return false;
+        }
+
+        if(_expiryCheckTime == 0)
+        {
+            _expiryCheckTime = System.currentTimeMillis();
+        }
+        return delivery.getExpiryTime() <= _expiryCheckTime;
+    }
+
+    private void expire(DeliveryImpl delivery, SenderImpl snd)
+    {
+        int pending = delivery.getDataLength();
+        delivery.releaseData();
+        delivery.setExpired();
+        delivery.setDone();
+
+        // Nothing was written, so give back what advancing past the delivery took from the sender
+        snd.incrementOutgoingBytes(-pending);
+        snd.incrementCredit();
+        snd.getSession().incrementOutgoingDeliveries(-1);
+        snd.decrementQueued();
+
+        getConnectionImpl().put(Event.Type.DELIVERY_EXPIRED, delivery);
+    }
+
     private boolean processTransportWorkSender(DeliveryImpl delivery,
                                                SenderImpl snd)
     {
@@ -538,6 +593,12 @@ public class TransportImpl extends EndpointImpl
         SessionImpl session = snd.getSession();
         TransportSession tpSession = session.getTransportSession();
 
+        if(delivery.getExpiryTime() != 0 && isExpiredBeforeSending(delivery, snd, tpLink))
+        {
+            expire(delivery, snd);
+            return true;
+        }
+
         boolean wasDone = delivery.isDone();
 
         if(!delivery.isDone() &&
@@ -614,7 +675,7 @@ public class TransportImpl extends EndpointImpl
 
             if (payload == null || !payload.hasRemaining())
             {
-                session.incrementOutgoingBytes(-pending);
+                snd.incrementOutgoingBytes(-pending);
 
                 if (!transfer.getMore()) {
                     // Clear the in-progress delivery marker
@@ -629,7 +690,7 @@ public class TransportImpl extends EndpointImpl
             }
             else
             {
-                session.incrementOutgoingBytes(-(pending - payload.remaining()));
+                snd.incrementOutgoingBytes(-(pending - payload.remaining()));
 
                 // Remember the delivery we are still processing
                 // the body transfer frames for
@@ -641,7 +702,7 @@ public class TransportImpl extends EndpointImpl
             }
         }
 
-        if(wasDone && delivery.getLocalState() != null)
+        if(wasDone && delivery.getLocalState() != null && delivery.getTransportDelivery() != null)
         {
             TransportDelivery tpDelivery = delivery.getTransportDelivery();
             Disposition disposition = new Disposition();
@@ -826,6 +887,11 @@ public class TransportImpl extends EndpointImpl
 
                             writeFrame(transportSession.getLocalChannel(), attach, null, null);
                             transportLink.sentAttach();
+
+                            if(link.getRemoteState() == EndpointState.ACTIVE)
+                            {
+                                _handshakeTimings.phaseReached(Phase.FIRST_ATTACH_ACTIVE);
+                            }
                         }
                     }
                 }
@@ -876,6 +942,7 @@ public class TransportImpl extends EndpointImpl
             _isOpenSent = true;
 
             writeFrame(0, open, null, null);
+            _handshakeTimings.phaseReached(Phase.OPEN_SENT);
         }
     }
 
@@ -954,12 +1021,13 @@ public class TransportImpl extends EndpointImpl
 
     private int allocateLocalChannel(TransportSession transportSession)
     {
-        for (int i = 0; i < _connectionEndpoint.getMaxChannels(); i++)
+        for (int i = _lowestFreeLocalChannel; i < _connectionEndpoint.getMaxChannels(); i++)
         {
             if (!_localSessions.containsKey(i))
             {
                 _localSessions.put(i, transportSession);
                 transportSession.setLocalChannel(i);
+                _lowestFreeLocalChannel = i + 1;
                 return i;
             }
         }
@@ -971,6 +1039,7 @@ public class TransportImpl extends EndpointImpl
     {
         final int channel = transportSession.getLocalChannel();
         _localSessions.remove(channel);
+        _lowestFreeLocalChannel = Math.min(_lowestFreeLocalChannel, channel);
         transportSession.freeLocalChannel();
         return channel;
     }
@@ -979,6 +1048,10 @@ public class TransportImpl extends EndpointImpl
     {
         if(_connectionEndpoint != null && _isOpenSent)
         {
+            // Found with one walk of the endpoints the first time a closing session needs it,
+            // rather than a walk per closing session
+            Set<SessionImpl> sessionsWithSendableMessages = null;
+
             EndpointImpl endpoint = _connectionEndpoint.getTransportHead();
             while(endpoint != null)
             {
@@ -990,7 +1063,10 @@ public class TransportImpl extends EndpointImpl
                         && (transportSession = session.getTransportSession()).isLocalChannelSet()
                         && !_isCloseSent)
                     {
-                        if (hasSendableMessages(session)) {
+                        if (sessionsWithSendableMessages == null) {
+                            sessionsWithSendableMessages = findSessionsWithSendableMessages();
+                        }
+                        if (sessionsWithSendableMessages.contains(session)) {
                             endpoint = endpoint.transportNext();
                             continue;
                         }
@@ -1014,6 +1090,35 @@ public class TransportImpl extends EndpointImpl
         }
     }
 
+    /**
+     * @return the sessions that {@link #hasSendableMessages(SessionImpl)} is true for.
+     */
+    private Set<SessionImpl> findSessionsWithSendableMessages()
+    {
+        Set<SessionImpl> sessions = new HashSet<SessionImpl>();
+        if(_connectionEndpoint == null || _closeReceived)
+        {
+            return sessions;
+        }
+
+        EndpointImpl endpoint = _connectionEndpoint.getTransportHead();
+        while(endpoint != null)
+        {
+            if(endpoint instanceof SenderImpl)
+            {
+                SenderImpl sender = (SenderImpl) endpoint;
+                if(sender.getQueued() != 0
+                   && !getTransportState(sender).detachReceived()
+                   && !sender.getSession().getTransportSession().endReceived())
+                {
+                    sessions.add(sender.getSession());
+                }
+            }
+            endpoint = endpoint.transportNext();
+        }
+        return sessions;
+    }
+
     private boolean hasSendableMessages(SessionImpl session)
     {
         if (_connectionEndpoint == null) {
@@ -1102,6 +1207,7 @@ public class TransportImpl extends EndpointImpl
     @Override
     public void handleOpen(Open open, Binary payload, Integer channel)
     {
+        _handshakeTimings.phaseReached(Phase.OPEN_RECEIVED);
         setRemoteState(EndpointState.ACTIVE);
         if(_connectionEndpoint != null)
         {
@@ -1236,6 +1342,10 @@ public class TransportImpl extends EndpointImpl
                 }
 
                 link.setRemoteState(EndpointState.ACTIVE);
+                if(transportLink.attachSent())
+                {
+                    _handshakeTimings.phaseReached(Phase.FIRST_ATTACH_ACTIVE);
+                }
                 link.setRemoteSource(attach.getSource());
                 link.setRemoteTarget(attach.getTarget());
 
@@ -1475,6 +1585,24 @@ public class TransportImpl extends EndpointImpl
         }
     }
 
+    @Override
+    public TransportResult processInput(ByteBuffer input)
+    {
+        _processingStarted = true;
+
+        try {
+            init();
+            int beforePosition = _inputProcessor.position();
+            int beforeRemaining = input.remaining();
+            _inputProcessor.process(input);
+            _bytesInput += beforeRemaining - input.remaining() + beforePosition - _inputProcessor.position();
+            return TransportResultFactory.ok();
+        } catch (TransportException e) {
+            _head_closed = true;
+            return TransportResultFactory.error(e);
+        }
+    }
+
     @Override
     public ByteBuffer getOutputBuffer()
     {
@@ -1758,6 +1886,18 @@ public class TransportImpl extends EndpointImpl
         return _emitFlowEventOnSend;
     }
 
+    @Override
+    public void setEmitDeliveryBatchEvents(boolean emitDeliveryBatchEvents)
+    {
+        _emitDeliveryBatchEvents = emitDeliveryBatchEvents;
+    }
+
+    @Override
+    public boolean isEmitDeliveryBatchEvents()
+    {
+        return _emitDeliveryBatchEvents;
+    }
+
     @Override
     public void setUseReadOnlyOutputBuffer(boolean value)
     {
@@ -1803,4 +1943,59 @@ public class TransportImpl extends EndpointImpl
     public int getOutboundFrameSizeLimit() {
         return _outboundFrameSizeLimit;
     }
+
+    @Override
+    public HandshakeTimings getHandshakeTimings()
+    {
+        return _handshakeTimings;
+    }
+
+    HandshakeTimingsImpl getHandshakeTimingsImpl()
+    {
+        return _handshakeTimings;
+    }
+
+    TransportGroupImpl getTransportGroup()
+    {
+        return _transportGroup;
+    }
+
+    void setTransportGroup(TransportGroupImpl transportGroup)
+    {
+        _transportGroup = transportGroup;
+    }
+
+    /**
+     * Called when the bound connection has its first endpoint change since output was last generated.
+     */
+    void connectionModified()
+    {
+        if (_transportGroup != null)
+        {
+            _transportGroup.queueOutput(this);
+        }
+    }
+
+    boolean hasModifiedEndpoints()
+    {
+        return _connectionEndpoint != null && _connectionEndpoint.getTransportHead() != null;
+    }
+
+    @Override
+    public void setHandshakeTimingsRecorder(HandshakeTimingsRecorder recorder)
+    {
+        _handshakeTimings.setRecorder(recorder);
+    }
+
+    @Override
+    public HandshakeTimingsRecorder getHandshakeTimingsRecorder()
+    {
+        return _handshakeTimings.getRecorder();
+    }
+
+    @Override
+    public void socketConnected()
+    {
+        _handshakeTimings.phaseReached(Phase.SOCKET_CONNECTED);
+    }
 }
@@ -22,6 +22,7 @@ package org.apache.qpid.proton.engine.impl;
 
 import java.nio.ByteBuffer;
 
+import org.apache.qpid.proton.engine.Transport;
 import org.apache.qpid.proton.engine.TransportException;
 
 
@@ -38,4 +39,23 @@ public interface TransportInput
 
     void close_tail();
 
+    /**
+     * Processes as much of the given buffer as this input can currently accept, advancing
+     * its position past the bytes consumed.  Implementations able to parse directly from
+     * the supplied buffer should override this, the default pours the bytes through
+     * {@link #tail()} and {@link #process()}.
+     *
+     * @param input the buffer holding the bytes to process
+     * @throws TransportException if the tail is closed or the input is invalid
+     */
+    default void process(ByteBuffer input) throws TransportException
+    {
+        if (capacity() == Transport.END_OF_STREAM)
+        {
+            throw new TransportException("tail closed");
+        }
+
+        ByteBufferUtils.pourAll(input, this);
+    }
+
 }
@@ -23,7 +23,6 @@ package org.apache.qpid.proton.engine.impl;
 
 import org.apache.qpid.proton.amqp.UnsignedInteger;
 import org.apache.qpid.proton.amqp.transport.Flow;
-import org.apache.qpid.proton.engine.Event;
 
 class TransportLink<T extends LinkImpl>
 {
@@ -156,9 +155,6 @@ class TransportLink<T extends LinkImpl>
     {
         _remoteDeliveryCount = flow.getDeliveryCount();
         _remoteLinkCredit = flow.getLinkCredit();
-
-
-        _link.getConnectionImpl().put(Event.Type.LINK_FLOW, _link);
     }
 
     void setLinkCredit(UnsignedInteger linkCredit)
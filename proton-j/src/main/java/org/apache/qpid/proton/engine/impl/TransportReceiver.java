@@ -27,6 +27,7 @@ import org.apache.qpid.proton.amqp.transport.Flow;
 class TransportReceiver extends TransportLink<ReceiverImpl>
 {
     private UnsignedInteger _incomingDeliveryId;
+    private boolean _discardingTransfers;
 
     TransportReceiver(ReceiverImpl link)
     {
@@ -63,4 +64,16 @@ class TransportReceiver extends TransportLink<ReceiverImpl>
         this._incomingDeliveryId = _incomingDeliveryId;
     }
 
+    /**
+     * Stops any further transfers for the link being buffered, used once it is being detached
+     * because the peer exceeded the max-message-size.
+     */
+    void discardTransfers() {
+        _discardingTransfers = true;
+    }
+
+    boolean isDiscardingTransfers() {
+        return _discardingTransfers;
+    }
+
 }
@@ -21,15 +21,22 @@
 
 package org.apache.qpid.proton.engine.impl;
 
+import java.util.ArrayList;
+import java.util.Collections;
 import java.util.HashMap;
+import java.util.List;
 import java.util.Map;
 
 import org.apache.qpid.proton.amqp.Binary;
 import org.apache.qpid.proton.amqp.UnsignedInteger;
+import org.apache.qpid.proton.amqp.UnsignedLong;
 import org.apache.qpid.proton.amqp.transport.Disposition;
+import org.apache.qpid.proton.amqp.transport.ErrorCondition;
 import org.apache.qpid.proton.amqp.transport.Flow;
+import org.apache.qpid.proton.amqp.transport.LinkError;
 import org.apache.qpid.proton.amqp.transport.Role;
 import org.apache.qpid.proton.amqp.transport.Transfer;
+import org.apache.qpid.proton.engine.EndpointState;
 import org.apache.qpid.proton.engine.Event;
 
 class TransportSession
@@ -55,6 +62,8 @@ class TransportSession
     private final Map<UnsignedInteger, TransportLink<?>> _remoteHandlesMap = new HashMap<UnsignedInteger, TransportLink<?>>();
     private final Map<UnsignedInteger, TransportLink<?>> _localHandlesMap = new HashMap<UnsignedInteger, TransportLink<?>>();
     private final Map<String, TransportLink> _halfOpenLinks = new HashMap<String, TransportLink>();
+    // No local handle below this is free, so allocation need not look at those again
+    private int _lowestFreeLocalHandle;
 
 
     private UnsignedInteger _incomingDeliveryId = null;
@@ -150,6 +159,7 @@ class TransportSession
             tl.clearLocalHandle();
         }
         _localHandlesMap.clear();
+        _lowestFreeLocalHandle = 0;
     }
 
     public void unsetRemoteChannel()
@@ -218,13 +228,14 @@ class TransportSession
 
     public UnsignedInteger allocateLocalHandle(TransportLink transportLink)
     {
-        for(int i = 0; i <= HANDLE_MAX; i++)
+        for(int i = _lowestFreeLocalHandle; i <= HANDLE_MAX; i++)
         {
             UnsignedInteger handle = UnsignedInteger.valueOf(i);
             if(!_localHandlesMap.containsKey(handle))
             {
                 _localHandlesMap.put(handle, transportLink);
                 transportLink.setLocalHandle(handle);
+                _lowestFreeLocalHandle = i + 1;
                 return handle;
             }
         }
@@ -243,7 +254,10 @@ class TransportSession
 
     public void freeLocalHandle(UnsignedInteger handle)
     {
-        _localHandlesMap.remove(handle);
+        if(_localHandlesMap.remove(handle) != null)
+        {
+            _lowestFreeLocalHandle = Math.min(_lowestFreeLocalHandle, handle.intValue());
+        }
     }
 
     public void freeRemoteHandle(UnsignedInteger handle)
@@ -267,6 +281,12 @@ class TransportSession
         incrementNextIncomingId(); // The conceptual/non-wire transfer-id, for the session window.
 
         TransportReceiver transportReceiver = (TransportReceiver) getLinkFromRemoteHandle(transfer.getHandle());
+        if (transportReceiver.isDiscardingTransfers())
+        {
+            discardTransfer(transportReceiver, transfer);
+            return;
+        }
+
         UnsignedInteger linkIncomingDeliveryId = transportReceiver.getIncomingDeliveryId();
         UnsignedInteger deliveryId = transfer.getDeliveryId();
 
@@ -305,8 +325,21 @@ class TransportSession
         boolean aborted = transfer.getAborted();
         if (payload != null && !aborted)
         {
-            delivery.append(payload);
-            getSession().incrementIncomingBytes(payload.getLength());
+            long size = delivery.getTransportDelivery().addIncomingSize(payload.getLength());
+            if (exceedsMaxMessageSize(transportReceiver.getReceiver(), size))
+            {
+                // Drop what has been buffered so far and treat the delivery as aborted, the
+                // link is detached and anything else the peer sends on it is discarded.
+                getSession().incrementIncomingBytes(-delivery.pending());
+                delivery.discardData();
+                rejectOversizeDelivery(transportReceiver, size);
+                aborted = true;
+            }
+            else
+            {
+                delivery.append(payload);
+                getSession().incrementIncomingBytes(payload.getLength());
+            }
         }
 
         delivery.updateWork();
@@ -336,7 +369,45 @@ class TransportSession
             delivery.getLink().modified(false);
         }
 
-        getSession().getConnection().put(Event.Type.DELIVERY, delivery);
+        getSession().getConnection().putTransfer(delivery);
+    }
+
+    private boolean exceedsMaxMessageSize(ReceiverImpl receiver, long size)
+    {
+        UnsignedLong maxMessageSize = receiver.getMaxMessageSize();
+        return maxMessageSize != null && !UnsignedLong.ZERO.equals(maxMessageSize) &&
+               maxMessageSize.compareTo(UnsignedLong.valueOf(size)) < 0;
+    }
+
+    private void rejectOversizeDelivery(TransportReceiver transportReceiver, long size)
+    {
+        ReceiverImpl receiver = transportReceiver.getReceiver();
+        transportReceiver.discardTransfers();
+
+        if (receiver.getLocalState() != EndpointState.CLOSED)
+        {
+            receiver.setCondition(new ErrorCondition(LinkError.MESSAGE_SIZE_EXCEEDED,
+                "Delivery of at least " + size + " bytes exceeds the link max-message-size of " + receiver.getMaxMessageSize()));
+            receiver.close();
+        }
+    }
+
+    /**
+     * Accounts for a transfer received on a link that is being detached because of an oversize
+     * delivery, without buffering its payload or creating a delivery for it.
+     */
+    private void discardTransfer(TransportReceiver transportReceiver, Transfer transfer)
+    {
+        UnsignedInteger deliveryId = transfer.getDeliveryId();
+        if (deliveryId != null)
+        {
+            _incomingDeliveryId = deliveryId;
+        }
+
+        _incomingWindowSize = _incomingWindowSize.subtract(UnsignedInteger.ONE);
+        if (_incomingWindowSize.equals(UnsignedInteger.ZERO)) {
+            transportReceiver.getReceiver().modified(false);
+        }
     }
 
     private void verifyNewDeliveryIdSequence(UnsignedInteger previousId, UnsignedInteger linkIncomingId, UnsignedInteger newDeliveryId) {
@@ -402,7 +473,8 @@ class TransportSession
             TransportLink transportLink = getLinkFromRemoteHandle(flow.getHandle());
             transportLink.handleFlow(flow);
 
-
+            // Only once the link's credit reflects the flow, as an engine listener reads it straight away
+            getSession().getConnection().put(Event.Type.LINK_FLOW, transportLink.getLink());
         }
     }
 
@@ -418,33 +490,103 @@ class TransportSession
 
     void handleDisposition(Disposition disposition)
     {
-        UnsignedInteger id = disposition.getFirst();
-        UnsignedInteger last = disposition.getLast() == null ? id : disposition.getLast();
+        UnsignedInteger first = disposition.getFirst();
+        UnsignedInteger last = disposition.getLast() == null ? first : disposition.getLast();
         final Map<UnsignedInteger, DeliveryImpl> unsettledDeliveries =
                 disposition.getRole() == Role.RECEIVER ? _unsettledOutgoingDeliveriesById
                         : _unsettledIncomingDeliveriesById;
 
-        while(id.compareTo(last)<=0)
+        if (last.compareTo(first) < 0 || unsettledDeliveries.isEmpty())
+        {
+            return;
+        }
+
+        final List<DeliveryBatchImpl> batches =
+                _transport.isEmitDeliveryBatchEvents() ? new ArrayList<DeliveryBatchImpl>(1) : null;
+
+        if (last.longValue() - first.longValue() >= unsettledDeliveries.size())
         {
-            DeliveryImpl delivery = unsettledDeliveries.get(id);
-            if(delivery != null)
+            // The range spans more ids than there are unsettled deliveries, so visit
+            // those in range rather than looking up every id it covers.
+            List<UnsignedInteger> ids = new ArrayList<UnsignedInteger>();
+            for (UnsignedInteger id : unsettledDeliveries.keySet())
             {
-                if(disposition.getState() != null)
-                {
-                    delivery.setRemoteDeliveryState(disposition.getState());
-                }
-                if(Boolean.TRUE.equals(disposition.getSettled()))
+                if (id.compareTo(first) >= 0 && id.compareTo(last) <= 0)
                 {
-                    delivery.setRemoteSettled(true);
-                    unsettledDeliveries.remove(id);
+                    ids.add(id);
                 }
-                delivery.updateWork();
+            }
+            Collections.sort(ids);
+
+            for (UnsignedInteger id : ids)
+            {
+                applyDisposition(disposition, unsettledDeliveries, id, batches);
+            }
+        }
+        else
+        {
+            UnsignedInteger id = first;
+            while(id.compareTo(last)<=0)
+            {
+                applyDisposition(disposition, unsettledDeliveries, id, batches);
+                id = id.add(UnsignedInteger.ONE);
+            }
+        }
 
+        if (batches != null)
+        {
+            for (DeliveryBatchImpl batch : batches)
+            {
+                getSession().getConnection().put(Event.Type.DELIVERY_BATCH, batch);
+            }
+        }
+    }
+
+    private void applyDisposition(Disposition disposition,
+                                  Map<UnsignedInteger, DeliveryImpl> unsettledDeliveries,
+                                  UnsignedInteger id,
+                                  List<DeliveryBatchImpl> batches)
+    {
+        DeliveryImpl delivery = unsettledDeliveries.get(id);
+        if(delivery != null)
+        {
+            if(disposition.getState() != null)
+            {
+                delivery.setRemoteDeliveryState(disposition.getState());
+            }
+            if(Boolean.TRUE.equals(disposition.getSettled()))
+            {
+                delivery.setRemoteSettled(true);
+                unsettledDeliveries.remove(id);
+            }
+            delivery.updateWork();
+
+            if (batches == null)
+            {
                 getSession().getConnection().put(Event.Type.DELIVERY, delivery);
             }
-            id = id.add(UnsignedInteger.ONE);
+            else
+            {
+                batchFor(batches, delivery.getLink()).add(delivery);
+            }
         }
-        //TODO - Implement.
+    }
+
+    private static DeliveryBatchImpl batchFor(List<DeliveryBatchImpl> batches, LinkImpl link)
+    {
+        // Deliveries covered by one disposition are usually all on the same link
+        for (int i = batches.size() - 1; i >= 0; --i)
+        {
+            DeliveryBatchImpl batch = batches.get(i);
+            if (batch.getLink() == link)
+            {
+                return batch;
+            }
+        }
+
+        DeliveryBatchImpl batch = new DeliveryBatchImpl(link);
+        batches.add(batch);
+        return batch;
     }
 
     void addUnsettledOutgoing(UnsignedInteger deliveryId, DeliveryImpl delivery)
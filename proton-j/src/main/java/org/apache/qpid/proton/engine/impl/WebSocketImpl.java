@@ -0,0 +1,844 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+package org.apache.qpid.proton.engine.impl;
+
+import static org.apache.qpid.proton.engine.impl.ByteBufferUtils.newWriteableBuffer;
+
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+import java.security.MessageDigest;
+import java.security.NoSuchAlgorithmException;
+import java.security.SecureRandom;
+import java.util.Base64;
+import java.util.HashMap;
+import java.util.Locale;
+import java.util.Map;
+
+import org.apache.qpid.proton.engine.Transport;
+import org.apache.qpid.proton.engine.TransportException;
+
+/**
+ * A {@link TransportLayer} carrying the transport's byte stream in binary WebSocket frames, as
+ * described by the AMQP WebSocket binding, so that AMQP can be spoken over WebSockets without a
+ * separate proxy.
+ * <p>
+ * The layer is added using {@link TransportInternal#addTransportLayer(TransportLayer)}.  Layers
+ * wrap those added before them, so for SASL and TLS to be used the layer should be added after
+ * {@link Transport#sasl()} and before {@link Transport#ssl(org.apache.qpid.proton.engine.SslDomain)}
+ * are called.  A client sends the HTTP upgrade request before anything else and a server answers
+ * one before sending anything else.
+ * <p>
+ * All the output pending when a frame is started is sent as a single WebSocket frame, so large
+ * AMQP frames are never split across WebSocket frames.  Masking and unmasking are done eight bytes
+ * at a time, and a server writes large frame payloads straight from the output of the layer
+ * beneath rather than copying them.
+ */
+public class WebSocketImpl implements TransportLayer
+{
+    public enum Mode { CLIENT, SERVER }
+
+    public static final int DEFAULT_BUFFER_SIZE = 16 * 1024;
+    public static final String AMQP_SUBPROTOCOL = "amqp";
+
+    static final int OPCODE_CONTINUATION = 0x0;
+    static final int OPCODE_TEXT = 0x1;
+    static final int OPCODE_BINARY = 0x2;
+    static final int OPCODE_CLOSE = 0x8;
+    static final int OPCODE_PING = 0x9;
+    static final int OPCODE_PONG = 0xA;
+
+    /**
+     * Payloads at least this large are written by a server straight from the underlying output,
+     * smaller ones are copied in behind their frame header so the two go out in one write.
+     */
+    static final int DIRECT_PAYLOAD_THRESHOLD = 1024;
+
+    private static final int MIN_BUFFER_SIZE = 1024;
+    private static final String WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    private static final String WEBSOCKET_VERSION = "13";
+
+    private static final int FIN = 0x80;
+    private static final int RSV_BITS = 0x70;
+    private static final int OPCODE_BITS = 0x0F;
+    private static final int MASK_BIT = 0x80;
+    private static final int PAYLOAD_LENGTH_BITS = 0x7F;
+    private static final int PAYLOAD_LENGTH_16 = 126;
+    private static final int PAYLOAD_LENGTH_64 = 127;
+    private static final int MAX_CONTROL_PAYLOAD = 125;
+    private static final int CLOSE_NORMAL = 1000;
+
+    private final Mode _mode;
+    private final String _host;
+    private final String _path;
+    private final int _bufferSize;
+
+    /**
+     * @param mode whether this end sends or answers the upgrade request.
+     * @param host the value of the Host header sent by a client, ignored by a server.
+     * @param path the request path sent by a client, ignored by a server.
+     */
+    public WebSocketImpl(Mode mode, String host, String path)
+    {
+        this(mode, host, path, DEFAULT_BUFFER_SIZE);
+    }
+
+    /**
+     * @param bufferSize the size of the input and output buffers, which must hold the upgrade
+     *        request and response.
+     */
+    public WebSocketImpl(Mode mode, String host, String path, int bufferSize)
+    {
+        if (mode == null)
+        {
+            throw new IllegalArgumentException("A mode must be given");
+        }
+        if (mode == Mode.CLIENT && (host == null || path == null))
+        {
+            throw new IllegalArgumentException("A client must be given the host and path to request");
+        }
+        if (bufferSize < MIN_BUFFER_SIZE)
+        {
+            throw new IllegalArgumentException("Buffer size must be at least " + MIN_BUFFER_SIZE + ": " + bufferSize);
+        }
+
+        _mode = mode;
+        _host = host;
+        _path = path;
+        _bufferSize = bufferSize;
+    }
+
+    public Mode getMode()
+    {
+        return _mode;
+    }
+
+    @Override
+    public TransportWrapper wrap(TransportInput input, TransportOutput output)
+    {
+        return new WebSocketTransportWrapper(input, output);
+    }
+
+    /**
+     * Copies length bytes from source to target, XORing them with the given mask key starting at
+     * byte maskIndex of the key, and advancing the position of both buffers.  The buffers may be
+     * views of the same bytes to mask in place, and must be in big endian order.
+     *
+     * @return the index into the mask key of the byte following those masked.
+     */
+    static int mask(ByteBuffer source, ByteBuffer target, int length, int maskKey, int maskIndex)
+    {
+        int key = Integer.rotateLeft(maskKey, maskIndex << 3);
+        long longKey = ((long) key << 32) | (key & 0xFFFFFFFFL);
+
+        int remaining = length;
+        while (remaining >= 8)
+        {
+            target.putLong(source.getLong() ^ longKey);
+            remaining -= 8;
+        }
+
+        if (remaining >= 4)
+        {
+            target.putInt(source.getInt() ^ key);
+            remaining -= 4;
+        }
+
+        for (int shift = 24; remaining > 0; remaining--, shift -= 8)
+        {
+            target.put((byte) (source.get() ^ (key >>> shift)));
+        }
+
+        return (maskIndex + length) & 3;
+    }
+
+    static String acceptKey(String key)
+    {
+        try
+        {
+            MessageDigest sha1 = MessageDigest.getInstance("SHA-1");
+            byte[] digest = sha1.digest((key + WEBSOCKET_GUID).getBytes(StandardCharsets.US_ASCII));
+            return Base64.getEncoder().encodeToString(digest);
+        }
+        catch (NoSuchAlgorithmException e)
+        {
+            throw new IllegalStateException("SHA-1 is not available", e);
+        }
+    }
+
+    private static int frameHeaderSize(int payloadLength, boolean masked)
+    {
+        int size = payloadLength <= MAX_CONTROL_PAYLOAD ? 2 : payloadLength <= 0xFFFF ? 4 : 10;
+        return masked ? size + 4 : size;
+    }
+
+    private static boolean isControlFrame(int opcode)
+    {
+        return (opcode & 0x8) != 0;
+    }
+
+    private static boolean containsToken(String value, String token)
+    {
+        if (value != null)
+        {
+            for (String element : value.split(","))
+            {
+                if (element.trim().equalsIgnoreCase(token))
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    private class WebSocketTransportWrapper implements TransportWrapper
+    {
+        private final TransportInput _underlyingInput;
+        private final TransportOutput _underlyingOutput;
+
+        private final ByteBuffer _inputBuffer;
+        private final ByteBuffer _outputBuffer;
+        private final ByteBuffer _head;
+        private final ByteBuffer _controlPayload = ByteBuffer.allocate(MAX_CONTROL_PAYLOAD);
+        private final SecureRandom _random;
+
+        private String _upgradeKey;
+        private boolean _handshakeSent;
+        private boolean _handshakeComplete;
+
+        private boolean _tail_closed;
+        private int _inputOpcode;
+        private long _inputRemaining;
+        private boolean _inputMasked;
+        private int _inputMaskKey;
+        private int _inputMaskIndex;
+        private int _unmaskedBytes;
+
+        private boolean _head_closed;
+        private int _outputRemaining;
+        private int _outputMaskKey;
+        private int _outputMaskIndex;
+        private int _directRemaining;
+        private ByteBuffer _directHead;
+        private byte[] _pongPayload;
+        private byte[] _closePayload;
+        private boolean _closeSent;
+
+        private WebSocketTransportWrapper(TransportInput input, TransportOutput output)
+        {
+            _underlyingInput = input;
+            _underlyingOutput = output;
+
+            _inputBuffer = newWriteableBuffer(_bufferSize);
+            _outputBuffer = newWriteableBuffer(_bufferSize);
+            _head = _outputBuffer.duplicate();
+            _head.limit(0);
+
+            _random = _mode == Mode.CLIENT ? new SecureRandom() : null;
+        }
+
+        @Override
+        public int capacity()
+        {
+            if (_tail_closed) return Transport.END_OF_STREAM;
+            return _inputBuffer.remaining();
+        }
+
+        @Override
+        public int position()
+        {
+            if (_tail_closed) return Transport.END_OF_STREAM;
+            return _inputBuffer.position();
+        }
+
+        @Override
+        public ByteBuffer tail()
+        {
+            if (_tail_closed) throw new TransportException("tail closed");
+            return _inputBuffer;
+        }
+
+        @Override
+        public void process() throws TransportException
+        {
+            if (_tail_closed) throw new TransportException("tail closed");
+
+            _inputBuffer.flip();
+
+            try
+            {
+                processInput();
+            }
+            finally
+            {
+                if (_tail_closed)
+                {
+                    _inputBuffer.position(_inputBuffer.limit());
+                }
+                _inputBuffer.compact();
+            }
+        }
+
+        @Override
+        public void close_tail()
+        {
+            if (!_tail_closed)
+            {
+                _tail_closed = true;
+                _underlyingInput.close_tail();
+            }
+        }
+
+        @Override
+        public int pending()
+        {
+            if (!_head_closed)
+            {
+                fillOutputBuffer();
+            }
+
+            _head.limit(_outputBuffer.position());
+
+            if (_outputBuffer.position() > 0)
+            {
+                return _outputBuffer.position();
+            }
+            else if (_directRemaining > 0)
+            {
+                return directHead().remaining();
+            }
+            else if (_head_closed || _closeSent)
+            {
+                return Transport.END_OF_STREAM;
+            }
+
+            return 0;
+        }
+
+        @Override
+        public ByteBuffer head()
+        {
+            pending();
+
+            if (_outputBuffer.position() == 0 && _directRemaining > 0)
+            {
+                return directHead();
+            }
+
+            return _head;
+        }
+
+        @Override
+        public void pop(int bytes)
+        {
+            if (_outputBuffer.position() > 0)
+            {
+                _outputBuffer.flip();
+                _outputBuffer.position(bytes);
+                _outputBuffer.compact();
+                _head.position(0);
+                _head.limit(_outputBuffer.position());
+            }
+            else if (_directRemaining > 0)
+            {
+                _underlyingOutput.pop(bytes);
+                _directRemaining -= bytes;
+                _directHead = null;
+            }
+        }
+
+        @Override
+        public void close_head()
+        {
+            _head_closed = true;
+            _underlyingOutput.close_head();
+
+            _outputBuffer.clear();
+            _head.position(0);
+            _head.limit(0);
+            _directRemaining = 0;
+            _directHead = null;
+        }
+
+        /**
+         * A view of the part of the underlying output making up the rest of the payload of the
+         * frame being written directly, kept until popped so that consumers of the head see
+         * their own progress through it.
+         */
+        private ByteBuffer directHead()
+        {
+            if (_directHead == null)
+            {
+                _directHead = _underlyingOutput.head().slice();
+                _directHead.limit(Math.min(_directRemaining, _directHead.remaining()));
+            }
+
+            return _directHead;
+        }
+
+        private void processInput() throws TransportException
+        {
+            if (!_handshakeComplete && !readHandshake())
+            {
+                return;
+            }
+
+            while (!_tail_closed)
+            {
+                if (_unmaskedBytes > 0)
+                {
+                    if (!passUnmaskedInput())
+                    {
+                        break;
+                    }
+                }
+                else if (_inputRemaining > 0)
+                {
+                    int length = (int) Math.min(_inputBuffer.remaining(), _inputRemaining);
+                    if (length == 0)
+                    {
+                        break;
+                    }
+
+                    _inputRemaining -= length;
+
+                    if (isControlFrame(_inputOpcode))
+                    {
+                        _inputMaskIndex = mask(_inputBuffer, _controlPayload, length, _inputMaskKey, _inputMaskIndex);
+                        if (_inputRemaining == 0)
+                        {
+                            handleControlFrame();
+                        }
+                    }
+                    else
+                    {
+                        if (_inputMasked)
+                        {
+                            ByteBuffer payload = _inputBuffer.duplicate();
+                            _inputMaskIndex = mask(payload, _inputBuffer.duplicate(), length, _inputMaskKey, _inputMaskIndex);
+                        }
+                        _unmaskedBytes = length;
+                    }
+                }
+                else if (!readFrameHeader())
+                {
+                    break;
+                }
+            }
+        }
+
+        /**
+         * @return true if all the unmasked payload at the front of the input buffer was taken by
+         *         the underlying input.
+         */
+        private boolean passUnmaskedInput() throws TransportException
+        {
+            ByteBuffer payload = _inputBuffer.duplicate();
+            payload.limit(payload.position() + _unmaskedBytes);
+
+            _underlyingInput.process(payload);
+
+            _unmaskedBytes -= payload.position() - _inputBuffer.position();
+            _inputBuffer.position(payload.position());
+
+            return _unmaskedBytes == 0;
+        }
+
+        private boolean readFrameHeader() throws TransportException
+        {
+            int available = _inputBuffer.remaining();
+            if (available < 2)
+            {
+                return false;
+            }
+
+            int position = _inputBuffer.position();
+            int b0 = _inputBuffer.get(position) & 0xFF;
+            int b1 = _inputBuffer.get(position + 1) & 0xFF;
+            boolean masked = (b1 & MASK_BIT) != 0;
+            int lengthCode = b1 & PAYLOAD_LENGTH_BITS;
+
+            int headerSize = 2 + (masked ? 4 : 0);
+            if (lengthCode == PAYLOAD_LENGTH_16)
+            {
+                headerSize += 2;
+            }
+            else if (lengthCode == PAYLOAD_LENGTH_64)
+            {
+                headerSize += 8;
+            }
+
+            if (available < headerSize)
+            {
+                return false;
+            }
+
+            if ((b0 & RSV_BITS) != 0)
+            {
+                throw new TransportException("WebSocket frame has reserved bits set: " + b0);
+            }
+            if (masked != (_mode == Mode.SERVER))
+            {
+                throw new TransportException(masked ? "Masked WebSocket frame received from server"
+                                                    : "Unmasked WebSocket frame received from client");
+            }
+
+            _inputBuffer.position(position + 2);
+
+            long length;
+            if (lengthCode == PAYLOAD_LENGTH_16)
+            {
+                length = _inputBuffer.getShort() & 0xFFFF;
+            }
+            else if (lengthCode == PAYLOAD_LENGTH_64)
+            {
+                length = _inputBuffer.getLong();
+                if (length < 0)
+                {
+                    throw new TransportException("Invalid WebSocket frame length: " + length);
+                }
+            }
+            else
+            {
+                length = lengthCode;
+            }
+
+            int opcode = b0 & OPCODE_BITS;
+            switch (opcode)
+            {
+                case OPCODE_BINARY:
+                case OPCODE_CONTINUATION:
+                    break;
+                case OPCODE_CLOSE:
+                case OPCODE_PING:
+                case OPCODE_PONG:
+                    if (length > MAX_CONTROL_PAYLOAD || (b0 & FIN) == 0)
+                    {
+                        throw new TransportException("Invalid WebSocket control frame, opcode " + opcode + " length " + length);
+                    }
+                    _controlPayload.clear();
+                    break;
+                default:
+                    throw new TransportException("Unsupported WebSocket frame opcode: " + opcode);
+            }
+
+            _inputOpcode = opcode;
+            _inputRemaining = length;
+            _inputMasked = masked;
+            _inputMaskKey = masked ? _inputBuffer.getInt() : 0;
+            _inputMaskIndex = 0;
+
+            if (length == 0 && isControlFrame(opcode))
+            {
+                handleControlFrame();
+            }
+
+            return true;
+        }
+
+        private void handleControlFrame()
+        {
+            _controlPayload.flip();
+
+            if (_inputOpcode == OPCODE_PING)
+            {
+                _pongPayload = new byte[_controlPayload.remaining()];
+                _controlPayload.get(_pongPayload);
+            }
+            else if (_inputOpcode == OPCODE_CLOSE)
+            {
+                // Echo the status code, then treat the close as the end of the byte stream.
+                if (_closePayload == null)
+                {
+                    _closePayload = new byte[Math.min(2, _controlPayload.remaining())];
+                    _controlPayload.get(_closePayload);
+                }
+                close_tail();
+            }
+
+            _controlPayload.clear();
+        }
+
+        /**
+         * @return true once the whole upgrade request or response has been read.
+         */
+        private boolean readHandshake() throws TransportException
+        {
+            int start = _inputBuffer.position();
+            int end = -1;
+            for (int i = start; i + 3 < _inputBuffer.limit(); i++)
+            {
+                if (_inputBuffer.get(i) == '\r' && _inputBuffer.get(i + 1) == '\n'
+                    && _inputBuffer.get(i + 2) == '\r' && _inputBuffer.get(i + 3) == '\n')
+                {
+                    end = i;
+                    break;
+                }
+            }
+
+            if (end < 0)
+            {
+                if (_inputBuffer.limit() == _inputBuffer.capacity())
+                {
+                    throw new TransportException("WebSocket upgrade " + (_mode == Mode.SERVER ? "request" : "response")
+                                                 + " exceeds " + _inputBuffer.capacity() + " bytes");
+                }
+                return false;
+            }
+
+            byte[] bytes = new byte[end - start];
+            _inputBuffer.get(bytes);
+            _inputBuffer.position(end + 4);
+
+            String[] lines = new String(bytes, StandardCharsets.ISO_8859_1).split("\r\n");
+            Map<String, String> headers = new HashMap<String, String>();
+            for (int i = 1; i < lines.length; i++)
+            {
+                int colon = lines[i].indexOf(':');
+                if (colon > 0)
+                {
+                    headers.put(lines[i].substring(0, colon).trim().toLowerCase(Locale.ROOT), lines[i].substring(colon + 1).trim());
+                }
+            }
+
+            if (_mode == Mode.SERVER)
+            {
+                acceptUpgrade(lines[0], headers);
+            }
+            else
+            {
+                verifyUpgrade(lines[0], headers);
+            }
+
+            _handshakeComplete = true;
+            return true;
+        }
+
+        private void acceptUpgrade(String requestLine, Map<String, String> headers) throws TransportException
+        {
+            if (!requestLine.startsWith("GET ") || !requestLine.endsWith(" HTTP/1.1"))
+            {
+                throw new TransportException("Invalid WebSocket upgrade request: " + requestLine);
+            }
+
+            String key = headers.get("sec-websocket-key");
+            if (!"websocket".equalsIgnoreCase(headers.get("upgrade"))
+                || !containsToken(headers.get("connection"), "upgrade")
+                || !WEBSOCKET_VERSION.equals(headers.get("sec-websocket-version"))
+                || key == null)
+            {
+                throw new TransportException("Invalid WebSocket upgrade request headers: " + headers);
+            }
+            if (!containsToken(headers.get("sec-websocket-protocol"), AMQP_SUBPROTOCOL))
+            {
+                throw new TransportException("WebSocket upgrade request does not offer the "
+                                             + AMQP_SUBPROTOCOL + " subprotocol");
+            }
+
+            writeHandshake("HTTP/1.1 101 Switching Protocols\r\n" +
+                           "Upgrade: websocket\r\n" +
+                           "Connection: Upgrade\r\n" +
+                           "Sec-WebSocket-Accept: " + acceptKey(key) + "\r\n" +
+                           "Sec-WebSocket-Protocol: " + AMQP_SUBPROTOCOL + "\r\n\r\n");
+        }
+
+        private void verifyUpgrade(String statusLine, Map<String, String> headers) throws TransportException
+        {
+            if (!statusLine.startsWith("HTTP/1.1 101"))
+            {
+                throw new TransportException("WebSocket upgrade refused: " + statusLine);
+            }
+            if (!acceptKey(_upgradeKey).equals(headers.get("sec-websocket-accept")))
+            {
+                throw new TransportException("Invalid Sec-WebSocket-Accept in WebSocket upgrade response: "
+                                             + headers.get("sec-websocket-accept"));
+            }
+            if (!AMQP_SUBPROTOCOL.equals(headers.get("sec-websocket-protocol")))
+            {
+                throw new TransportException("WebSocket upgrade response did not select the "
+                                             + AMQP_SUBPROTOCOL + " subprotocol");
+            }
+        }
+
+        private void writeUpgradeRequest() throws TransportException
+        {
+            byte[] nonce = new byte[16];
+            _random.nextBytes(nonce);
+            _upgradeKey = Base64.getEncoder().encodeToString(nonce);
+
+            writeHandshake("GET " + _path + " HTTP/1.1\r\n" +
+                           "Host: " + _host + "\r\n" +
+                           "Upgrade: websocket\r\n" +
+                           "Connection: Upgrade\r\n" +
+                           "Sec-WebSocket-Key: " + _upgradeKey + "\r\n" +
+                           "Sec-WebSocket-Protocol: " + AMQP_SUBPROTOCOL + "\r\n" +
+                           "Sec-WebSocket-Version: " + WEBSOCKET_VERSION + "\r\n\r\n");
+        }
+
+        private void writeHandshake(String handshake) throws TransportException
+        {
+            byte[] bytes = handshake.getBytes(StandardCharsets.ISO_8859_1);
+            if (bytes.length > _outputBuffer.remaining())
+            {
+                throw new TransportException("WebSocket upgrade exceeds " + _outputBuffer.capacity() + " bytes");
+            }
+
+            _outputBuffer.put(bytes);
+            _handshakeSent = true;
+        }
+
+        private void fillOutputBuffer()
+        {
+            if (!_handshakeSent && _mode == Mode.CLIENT)
+            {
+                writeUpgradeRequest();
+            }
+
+            if (!_handshakeComplete || _closeSent)
+            {
+                return;
+            }
+
+            boolean masked = _mode == Mode.CLIENT;
+            while (_directRemaining == 0)
+            {
+                if (_outputRemaining > 0)
+                {
+                    if (!copyPayload(masked))
+                    {
+                        return;
+                    }
+                }
+                else if (_pongPayload != null)
+                {
+                    if (!writeControlFrame(OPCODE_PONG, _pongPayload, masked))
+                    {
+                        return;
+                    }
+                    _pongPayload = null;
+                }
+                else if (_closePayload != null)
+                {
+                    _closeSent = writeControlFrame(OPCODE_CLOSE, _closePayload, masked);
+                    return;
+                }
+                else
+                {
+                    int pending = _underlyingOutput.pending();
+                    if (pending == Transport.END_OF_STREAM)
+                    {
+                        _closePayload = new byte[] { (byte) (CLOSE_NORMAL >> 8), (byte) CLOSE_NORMAL };
+                    }
+                    else if (pending == 0 || _outputBuffer.remaining() < frameHeaderSize(pending, masked))
+                    {
+                        return;
+                    }
+                    else
+                    {
+                        _outputMaskKey = masked ? _random.nextInt() : 0;
+                        _outputMaskIndex = 0;
+                        writeFrameHeader(OPCODE_BINARY, pending, masked, _outputMaskKey);
+
+                        if (!masked && pending >= DIRECT_PAYLOAD_THRESHOLD)
+                        {
+                            _directRemaining = pending;
+                        }
+                        else
+                        {
+                            _outputRemaining = pending;
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * Copies as much of the current frame's payload from the underlying output as fits,
+         * masking it if required.
+         *
+         * @return true if the payload is now complete.
+         */
+        private boolean copyPayload(boolean masked)
+        {
+            ByteBuffer head = _underlyingOutput.head().duplicate();
+            int length = Math.min(_outputRemaining, Math.min(head.remaining(), _outputBuffer.remaining()));
+            if (length == 0)
+            {
+                return false;
+            }
+
+            if (masked)
+            {
+                _outputMaskIndex = mask(head, _outputBuffer, length, _outputMaskKey, _outputMaskIndex);
+            }
+            else
+            {
+                head.limit(head.position() + length);
+                _outputBuffer.put(head);
+            }
+
+            _underlyingOutput.pop(length);
+            _outputRemaining -= length;
+
+            return _outputRemaining == 0;
+        }
+
+        private boolean writeControlFrame(int opcode, byte[] payload, boolean masked)
+        {
+            if (_outputBuffer.remaining() < frameHeaderSize(payload.length, masked) + payload.length)
+            {
+                return false;
+            }
+
+            int maskKey = masked ? _random.nextInt() : 0;
+            writeFrameHeader(opcode, payload.length, masked, maskKey);
+            mask(ByteBuffer.wrap(payload), _outputBuffer, payload.length, maskKey, 0);
+            return true;
+        }
+
+        private void writeFrameHeader(int opcode, int payloadLength, boolean masked, int maskKey)
+        {
+            int maskBit = masked ? MASK_BIT : 0;
+
+            _outputBuffer.put((byte) (FIN | opcode));
+            if (payloadLength <= MAX_CONTROL_PAYLOAD)
+            {
+                _outputBuffer.put((byte) (maskBit | payloadLength));
+            }
+            else if (payloadLength <= 0xFFFF)
+            {
+                _outputBuffer.put((byte) (maskBit | PAYLOAD_LENGTH_16));
+                _outputBuffer.putShort((short) payloadLength);
+            }
+            else
+            {
+                _outputBuffer.put((byte) (maskBit | PAYLOAD_LENGTH_64));
+                _outputBuffer.putLong(payloadLength);
+            }
+
+            if (masked)
+            {
+                _outputBuffer.putInt(maskKey);
+            }
+        }
+    }
+}
@@ -0,0 +1,439 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+package org.apache.qpid.proton.engine.impl;
+
+import java.io.BufferedOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.logging.Level;
+import java.util.logging.Logger;
+
+import org.apache.qpid.proton.engine.TransportException;
+
+/**
+ * A transport layer that records the bytes passing through it in both directions, with
+ * the time each chunk was seen, so that the traffic of a connection can later be read back
+ * with {@link #read(InputStream)} and replayed through a fresh transport.
+ *
+ * The layer sits where it is added with {@link TransportInternal#addTransportLayer(TransportLayer)},
+ * above any SSL layer, so a capture holds the unencrypted AMQP (and SASL) bytes.
+ *
+ * A capture is the {@link #MAGIC} number followed by one record per chunk: the
+ * {@link Direction} ordinal as a byte, the nanoseconds elapsed since the previous record
+ * and the chunk length, both as unsigned variable length integers, then the chunk bytes.
+ *
+ * If writing to the capture stream fails, capturing stops and the transport carries on.
+ */
+public class WireCaptureImpl implements TransportLayer
+{
+    private static final Logger _logger = Logger.getLogger(WireCaptureImpl.class.getName());
+
+    public static final int MAGIC = 0x50574331; // "PWC1"
+
+    public enum Direction
+    {
+        INPUT,
+        OUTPUT,
+        INPUT_CLOSED,
+        OUTPUT_CLOSED
+    }
+
+    /**
+     * A chunk of bytes read back from a capture.
+     */
+    public static final class Chunk
+    {
+        private final Direction _direction;
+        private final long _timestamp;
+        private final byte[] _data;
+
+        Chunk(Direction direction, long timestamp, byte[] data)
+        {
+            _direction = direction;
+            _timestamp = timestamp;
+            _data = data;
+        }
+
+        public Direction getDirection()
+        {
+            return _direction;
+        }
+
+        /**
+         * @return the nanoseconds elapsed between the start of the capture and this chunk.
+         */
+        public long getTimestamp()
+        {
+            return _timestamp;
+        }
+
+        public byte[] getData()
+        {
+            return _data;
+        }
+    }
+
+    private static final byte[] NO_DATA = new byte[0];
+
+    private final DataOutputStream _out;
+    private long _lastRecord = System.nanoTime();
+    private byte[] _scratch = NO_DATA;
+    private boolean _failed;
+
+    public WireCaptureImpl(OutputStream out)
+    {
+        _out = new DataOutputStream(out instanceof BufferedOutputStream ? out : new BufferedOutputStream(out));
+
+        try
+        {
+            _out.writeInt(MAGIC);
+        }
+        catch (IOException e)
+        {
+            failed(e);
+        }
+    }
+
+    @Override
+    public TransportWrapper wrap(TransportInput input, TransportOutput output)
+    {
+        return new WireCaptureTransportWrapper(input, output);
+    }
+
+    /**
+     * Writes out any records still buffered.
+     */
+    public void flush()
+    {
+        if (!_failed)
+        {
+            try
+            {
+                _out.flush();
+            }
+            catch (IOException e)
+            {
+                failed(e);
+            }
+        }
+    }
+
+    /**
+     * Writes out any records still buffered and closes the capture stream.
+     */
+    public void close()
+    {
+        flush();
+
+        try
+        {
+            _out.close();
+        }
+        catch (IOException e)
+        {
+            _logger.log(Level.FINE, "Failed to close wire capture", e);
+        }
+        _failed = true;
+    }
+
+    public boolean isCapturing()
+    {
+        return !_failed;
+    }
+
+    /**
+     * Reads back every chunk of a capture written by this layer.
+     *
+     * @param in the stream to read the capture from, which is read until its end.
+     * @return the chunks of the capture in the order they were recorded.
+     * @throws IOException if the stream does not hold a valid capture or cannot be read.
+     */
+    public static List<Chunk> read(InputStream in) throws IOException
+    {
+        DataInputStream data = new DataInputStream(in);
+        if (data.readInt() != MAGIC)
+        {
+            throw new IOException("Not a wire capture");
+        }
+
+        Direction[] directions = Direction.values();
+        List<Chunk> chunks = new ArrayList<Chunk>();
+        long timestamp = 0;
+
+        int type;
+        while ((type = data.read()) != -1)
+        {
+            if (type >= directions.length)
+            {
+                throw new IOException("Unknown wire capture record type: " + type);
+            }
+
+            timestamp += readVarLong(data);
+            long length = readVarLong(data);
+            if (length > Integer.MAX_VALUE)
+            {
+                throw new IOException("Invalid wire capture record length: " + length);
+            }
+
+            byte[] chunk = length == 0 ? NO_DATA : new byte[(int) length];
+            data.readFully(chunk);
+            chunks.add(new Chunk(directions[type], timestamp, chunk));
+        }
+
+        return chunks;
+    }
+
+    private void record(Direction direction, ByteBuffer buffer)
+    {
+        int length = buffer.remaining();
+        if (buffer.hasArray())
+        {
+            record(direction, buffer.array(), buffer.arrayOffset() + buffer.position(), length);
+        }
+        else
+        {
+            buffer.duplicate().get(scratch(length), 0, length);
+            record(direction, _scratch, 0, length);
+        }
+    }
+
+    private void record(Direction direction, byte[] data, int offset, int length)
+    {
+        if (_failed)
+        {
+            return;
+        }
+
+        long now = System.nanoTime();
+        try
+        {
+            _out.writeByte(direction.ordinal());
+            writeVarLong(_out, now - _lastRecord);
+            writeVarLong(_out, length);
+            _out.write(data, offset, length);
+        }
+        catch (IOException e)
+        {
+            failed(e);
+        }
+        _lastRecord = now;
+    }
+
+    private byte[] scratch(int length)
+    {
+        if (_scratch.length < length)
+        {
+            _scratch = new byte[Math.max(length, _scratch.length * 2)];
+        }
+        return _scratch;
+    }
+
+    private void failed(IOException e)
+    {
+        _failed = true;
+        _logger.log(Level.WARNING, "Wire capture stopped after failing to write", e);
+    }
+
+    private static void writeVarLong(DataOutputStream out, long value) throws IOException
+    {
+        while ((value & ~0x7FL) != 0)
+        {
+            out.writeByte((int) ((value & 0x7F) | 0x80));
+            value >>>= 7;
+        }
+        out.writeByte((int) value);
+    }
+
+    private static long readVarLong(DataInputStream in) throws IOException
+    {
+        long value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            int b = in.read();
+            if (b == -1)
+            {
+                throw new EOFException("Truncated wire capture record");
+            }
+
+            value |= (long) (b & 0x7F) << shift;
+            if ((b & 0x80) == 0)
+            {
+                return value;
+            }
+        }
+
+        throw new IOException("Malformed wire capture record");
+    }
+
+    private class WireCaptureTransportWrapper implements TransportWrapper
+    {
+        private final TransportInput _underlyingInput;
+        private final TransportOutput _underlyingOutput;
+        // The buffer last handed out by tail(), and where the input not yet recorded starts
+        private ByteBuffer _tail;
+        private int _tailStart;
+        // The buffer last handed out by head() and its position at the time
+        private ByteBuffer _head;
+        private int _headStart;
+
+        private WireCaptureTransportWrapper(TransportInput input, TransportOutput output)
+        {
+            _underlyingInput = input;
+            _underlyingOutput = output;
+        }
+
+        @Override
+        public int capacity()
+        {
+            return _underlyingInput.capacity();
+        }
+
+        @Override
+        public int position()
+        {
+            return _underlyingInput.position();
+        }
+
+        @Override
+        public ByteBuffer tail() throws TransportException
+        {
+            ByteBuffer tail = _underlyingInput.tail();
+            if (_tail != tail)
+            {
+                _tail = tail;
+                _tailStart = tail.position();
+            }
+            return tail;
+        }
+
+        @Override
+        public void process() throws TransportException
+        {
+            if (_tail != null)
+            {
+                // Recorded before processing as layers beneath may transform the bytes in place
+                ByteBuffer written = _tail.duplicate();
+                written.flip();
+                written.position(Math.min(_tailStart, written.limit()));
+                if (written.hasRemaining())
+                {
+                    record(Direction.INPUT, written);
+                }
+            }
+
+            try
+            {
+                _underlyingInput.process();
+            }
+            finally
+            {
+                if (_tail != null)
+                {
+                    // Whatever is left unprocessed is kept at the start of the buffer, so further
+                    // input is written after it whether or not tail() is called again first
+                    _tailStart = _tail.position();
+                }
+            }
+        }
+
+        @Override
+        public void process(ByteBuffer input) throws TransportException
+        {
+            int start = input.position();
+            int length = input.remaining();
+            byte[] copy = null;
+            if (!_failed)
+            {
+                copy = scratch(length);
+                input.duplicate().get(copy, 0, length);
+            }
+
+            try
+            {
+                _underlyingInput.process(input);
+            }
+            finally
+            {
+                if (copy != null)
+                {
+                    record(Direction.INPUT, copy, 0, input.position() - start);
+                }
+            }
+        }
+
+        @Override
+        public void close_tail()
+        {
+            record(Direction.INPUT_CLOSED, NO_DATA, 0, 0);
+            flush();
+            _underlyingInput.close_tail();
+        }
+
+        @Override
+        public int pending()
+        {
+            return _underlyingOutput.pending();
+        }
+
+        @Override
+        public ByteBuffer head()
+        {
+            ByteBuffer head = _underlyingOutput.head();
+            _head = head;
+            _headStart = head.position();
+            return head;
+        }
+
+        @Override
+        public void pop(int bytes)
+        {
+            if (bytes > 0 && !_failed)
+            {
+                // The bytes popped are those of the last head(), asking the layer beneath for
+                // its head again could produce more output as a side effect of capturing
+                ByteBuffer head = _head != null ? _head : _underlyingOutput.head();
+                ByteBuffer consumed = head.duplicate();
+                int start = _head != null ? _headStart : head.position();
+                consumed.limit(start + bytes);
+                consumed.position(start);
+                record(Direction.OUTPUT, consumed);
+            }
+
+            _head = null;
+            _underlyingOutput.pop(bytes);
+        }
+
+        @Override
+        public void close_head()
+        {
+            record(Direction.OUTPUT_CLOSED, NO_DATA, 0, 0);
+            flush();
+            _underlyingOutput.close_head();
+        }
+    }
+}
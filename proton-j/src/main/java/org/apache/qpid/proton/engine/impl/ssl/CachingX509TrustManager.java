@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine.impl.ssl;
+
+import java.net.Socket;
+import java.security.cert.CertificateException;
+import java.security.cert.X509Certificate;
+
+import javax.net.ssl.SSLEngine;
+import javax.net.ssl.SSLParameters;
+import javax.net.ssl.X509ExtendedTrustManager;
+import javax.net.ssl.X509TrustManager;
+
+/**
+ * Skips validating a peer certificate chain that the delegate trust manager accepted recently,
+ * as remembered by a {@link SslPeerValidationCacheImpl}.
+ *
+ * Validations that depend on the peer's host name, because an endpoint identification algorithm
+ * is set on the engine or socket, are always passed to the delegate.
+ */
+class CachingX509TrustManager extends X509ExtendedTrustManager
+{
+    private final X509TrustManager _delegate;
+    private final SslPeerValidationCacheImpl _cache;
+
+    CachingX509TrustManager(X509TrustManager delegate, SslPeerValidationCacheImpl cache)
+    {
+        _delegate = delegate;
+        _cache = cache;
+    }
+
+    @Override
+    public void checkClientTrusted(X509Certificate[] chain, String authType) throws CertificateException
+    {
+        SslPeerValidationCacheImpl.Key key = _cache.keyFor(_delegate, chain, authType, true);
+        if (key == null || !_cache.isValidated(key))
+        {
+            _delegate.checkClientTrusted(chain, authType);
+            validated(key, chain);
+        }
+    }
+
+    @Override
+    public void checkServerTrusted(X509Certificate[] chain, String authType) throws CertificateException
+    {
+        SslPeerValidationCacheImpl.Key key = _cache.keyFor(_delegate, chain, authType, false);
+        if (key == null || !_cache.isValidated(key))
+        {
+            _delegate.checkServerTrusted(chain, authType);
+            validated(key, chain);
+        }
+    }
+
+    @Override
+    public void checkClientTrusted(X509Certificate[] chain, String authType, SSLEngine engine) throws CertificateException
+    {
+        if (!(_delegate instanceof X509ExtendedTrustManager))
+        {
+            checkClientTrusted(chain, authType);
+            return;
+        }
+
+        SslPeerValidationCacheImpl.Key key = identifiesEndpoint(engine) ? null : _cache.keyFor(_delegate, chain, authType, true);
+        if (key == null || !_cache.isValidated(key))
+        {
+            ((X509ExtendedTrustManager) _delegate).checkClientTrusted(chain, authType, engine);
+            validated(key, chain);
+        }
+    }
+
+    @Override
+    public void checkServerTrusted(X509Certificate[] chain, String authType, SSLEngine engine) throws CertificateException
+    {
+        if (!(_delegate instanceof X509ExtendedTrustManager))
+        {
+            checkServerTrusted(chain, authType);
+            return;
+        }
+
+        SslPeerValidationCacheImpl.Key key = identifiesEndpoint(engine) ? null : _cache.keyFor(_delegate, chain, authType, false);
+        if (key == null || !_cache.isValidated(key))
+        {
+            ((X509ExtendedTrustManager) _delegate).checkServerTrusted(chain, authType, engine);
+            validated(key, chain);
+        }
+    }
+
+    @Override
+    public void checkClientTrusted(X509Certificate[] chain, String authType, Socket socket) throws CertificateException
+    {
+        if (_delegate instanceof X509ExtendedTrustManager)
+        {
+            ((X509ExtendedTrustManager) _delegate).checkClientTrusted(chain, authType, socket);
+        }
+        else
+        {
+            checkClientTrusted(chain, authType);
+        }
+    }
+
+    @Override
+    public void checkServerTrusted(X509Certificate[] chain, String authType, Socket socket) throws CertificateException
+    {
+        if (_delegate instanceof X509ExtendedTrustManager)
+        {
+            ((X509ExtendedTrustManager) _delegate).checkServerTrusted(chain, authType, socket);
+        }
+        else
+        {
+            checkServerTrusted(chain, authType);
+        }
+    }
+
+    @Override
+    public X509Certificate[] getAcceptedIssuers()
+    {
+        return _delegate.getAcceptedIssuers();
+    }
+
+    private void validated(SslPeerValidationCacheImpl.Key key, X509Certificate[] chain)
+    {
+        if (key != null)
+        {
+            _cache.validated(key, chain);
+        }
+    }
+
+    private static boolean identifiesEndpoint(SSLEngine engine)
+    {
+        if (engine == null)
+        {
+            return false;
+        }
+
+        SSLParameters parameters = engine.getSSLParameters();
+        String algorithm = parameters.getEndpointIdentificationAlgorithm();
+        return algorithm != null && !algorithm.isEmpty();
+    }
+}
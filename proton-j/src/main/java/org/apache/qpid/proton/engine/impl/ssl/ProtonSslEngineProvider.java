@@ -28,4 +28,15 @@ public interface ProtonSslEngineProvider
      * @param peerDetails the details of the remote peer. If non-null, may be used to assist SSL session resumption.
      */
     public ProtonSslEngine createSslEngine(SslPeerDetails peerDetails);
+
+    /**
+     * Returns an SSL engine for a server handshaking with a client that asked for the given server name.
+     *
+     * @param peerDetails the details of the remote peer. If non-null, may be used to assist SSL session resumption.
+     * @param serverName the server name sent by the client, or null if none was sent.
+     */
+    public default ProtonSslEngine createSslEngine(SslPeerDetails peerDetails, String serverName)
+    {
+        return createSslEngine(peerDetails);
+    }
 }
@@ -0,0 +1,344 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+package org.apache.qpid.proton.engine.impl.ssl;
+
+import static org.apache.qpid.proton.engine.impl.ByteBufferUtils.pourAll;
+
+import java.nio.BufferUnderflowException;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+import java.util.concurrent.Executor;
+
+import org.apache.qpid.proton.engine.SslPeerDetails;
+import org.apache.qpid.proton.engine.Transport;
+import org.apache.qpid.proton.engine.TransportException;
+import org.apache.qpid.proton.engine.impl.HandshakeTimingsImpl;
+import org.apache.qpid.proton.engine.impl.TransportInput;
+import org.apache.qpid.proton.engine.impl.TransportOutput;
+
+/**
+ * Holds back the first TLS record received by a server until it is complete, reads the server
+ * name the client asked for from the ClientHello it carries, and only then creates the SSL engine,
+ * so that the engine can be created from the context mapped to that name.
+ *
+ * Anything other than a ClientHello in a single record, such as an SSLv2 hello or a ClientHello
+ * fragmented over several records, is handed to an engine created for no server name.
+ */
+class ServerNameSelectingTransportWrapper implements SslTransportWrapper
+{
+    private static final int RECORD_HEADER_SIZE = 5;
+    private static final int HANDSHAKE_CONTENT_TYPE = 22;
+    private static final int CLIENT_HELLO = 1;
+    private static final int SERVER_NAME_EXTENSION = 0;
+    private static final int HOST_NAME_TYPE = 0;
+
+    // The largest record a ClientHello can be held back for, being the largest TLS plaintext fragment
+    private static final int MAX_RECORD_SIZE = 16384;
+
+    private static final ByteBuffer EMPTY = ByteBuffer.allocate(0);
+
+    private final ProtonSslEngineProvider _sslEngineProvider;
+    private final SslPeerDetails _peerDetails;
+    private final TransportInput _underlyingInput;
+    private final TransportOutput _underlyingOutput;
+    private final Executor _recordExecutor;
+    private final HandshakeTimingsImpl _handshakeTimings;
+
+    private ByteBuffer _helloBuffer = ByteBuffer.allocate(RECORD_HEADER_SIZE);
+    private SslTransportWrapper _selectedTransportWrapper;
+    private boolean _tailClosed;
+    private boolean _headClosed;
+
+    ServerNameSelectingTransportWrapper(ProtonSslEngineProvider sslEngineProvider, SslPeerDetails peerDetails,
+                                        TransportInput underlyingInput, TransportOutput underlyingOutput,
+                                        Executor recordExecutor, HandshakeTimingsImpl handshakeTimings)
+    {
+        _sslEngineProvider = sslEngineProvider;
+        _peerDetails = peerDetails;
+        _underlyingInput = underlyingInput;
+        _underlyingOutput = underlyingOutput;
+        _recordExecutor = recordExecutor;
+        _handshakeTimings = handshakeTimings;
+    }
+
+    @Override
+    public int capacity()
+    {
+        if (isSelected())
+        {
+            return _selectedTransportWrapper.capacity();
+        }
+        if (_tailClosed)
+        {
+            return Transport.END_OF_STREAM;
+        }
+        return _helloBuffer.remaining();
+    }
+
+    @Override
+    public int position()
+    {
+        if (isSelected())
+        {
+            return _selectedTransportWrapper.position();
+        }
+        if (_tailClosed)
+        {
+            return Transport.END_OF_STREAM;
+        }
+        return _helloBuffer.position();
+    }
+
+    @Override
+    public ByteBuffer tail()
+    {
+        if (isSelected())
+        {
+            return _selectedTransportWrapper.tail();
+        }
+        return _helloBuffer;
+    }
+
+    @Override
+    public void process() throws TransportException
+    {
+        if (isSelected())
+        {
+            _selectedTransportWrapper.process();
+            return;
+        }
+
+        if (_tailClosed)
+        {
+            throw new TransportException("connection aborted");
+        }
+
+        if (_helloBuffer.hasRemaining())
+        {
+            return;
+        }
+
+        if (_helloBuffer.capacity() == RECORD_HEADER_SIZE)
+        {
+            int recordLength = _helloBuffer.getShort(3) & 0xFFFF;
+            if ((_helloBuffer.get(0) & 0xFF) != HANDSHAKE_CONTENT_TYPE || recordLength > MAX_RECORD_SIZE)
+            {
+                select(null);
+                return;
+            }
+
+            // Hold back the rest of the record
+            ByteBuffer header = _helloBuffer;
+            header.flip();
+            _helloBuffer = ByteBuffer.allocate(RECORD_HEADER_SIZE + recordLength);
+            _helloBuffer.put(header);
+            if (_helloBuffer.hasRemaining())
+            {
+                return;
+            }
+        }
+
+        _helloBuffer.flip();
+        select(readServerName(_helloBuffer));
+    }
+
+    private void select(String serverName) throws TransportException
+    {
+        SimpleSslTransportWrapper selected = new SimpleSslTransportWrapper(
+            _sslEngineProvider.createSslEngine(_peerDetails, serverName),
+            _underlyingInput, _underlyingOutput, _recordExecutor);
+        selected.setHandshakeTimings(_handshakeTimings);
+        _selectedTransportWrapper = selected;
+
+        ByteBuffer held = _helloBuffer;
+        _helloBuffer = null;
+        if (held.position() != 0)
+        {
+            held.flip();
+        }
+        pourAll(held, _selectedTransportWrapper);
+    }
+
+    @Override
+    public void process(ByteBuffer input) throws TransportException
+    {
+        if (isSelected())
+        {
+            _selectedTransportWrapper.process(input);
+        }
+        else
+        {
+            SslTransportWrapper.super.process(input);
+        }
+    }
+
+    @Override
+    public void close_tail()
+    {
+        try
+        {
+            if (isSelected())
+            {
+                _selectedTransportWrapper.close_tail();
+            }
+        }
+        finally
+        {
+            _tailClosed = true;
+        }
+    }
+
+    @Override
+    public int pending()
+    {
+        if (_headClosed)
+        {
+            return Transport.END_OF_STREAM;
+        }
+        return isSelected() ? _selectedTransportWrapper.pending() : 0;
+    }
+
+    @Override
+    public ByteBuffer head()
+    {
+        return isSelected() ? _selectedTransportWrapper.head() : EMPTY;
+    }
+
+    @Override
+    public void pop(int bytes)
+    {
+        if (isSelected())
+        {
+            _selectedTransportWrapper.pop(bytes);
+        }
+        else if (bytes > 0)
+        {
+            throw new IllegalStateException("no bytes have been read");
+        }
+    }
+
+    @Override
+    public void close_head()
+    {
+        if (isSelected())
+        {
+            _selectedTransportWrapper.close_head();
+        }
+        else
+        {
+            _headClosed = true;
+        }
+    }
+
+    @Override
+    public String getCipherName()
+    {
+        return isSelected() ? _selectedTransportWrapper.getCipherName() : null;
+    }
+
+    @Override
+    public String getProtocolName()
+    {
+        return isSelected() ? _selectedTransportWrapper.getProtocolName() : null;
+    }
+
+    private boolean isSelected()
+    {
+        return _selectedTransportWrapper != null;
+    }
+
+    /**
+     * Reads the host name from the server name extension of the ClientHello held in the given
+     * TLS record, as laid out in RFC 5246 section 7.4.1.2 and RFC 6066 section 3.
+     *
+     * @param record the record, from its header, which is not consumed.
+     * @return the host name, or null if the record holds no ClientHello naming a host.
+     */
+    static String readServerName(ByteBuffer record)
+    {
+        try
+        {
+            ByteBuffer buffer = record.duplicate();
+            if ((buffer.get() & 0xFF) != HANDSHAKE_CONTENT_TYPE)
+            {
+                return null;
+            }
+            skip(buffer, 2); // protocol version
+            int recordLength = buffer.getShort() & 0xFFFF;
+            buffer.limit(Math.min(buffer.limit(), buffer.position() + recordLength));
+
+            if ((buffer.get() & 0xFF) != CLIENT_HELLO)
+            {
+                return null;
+            }
+            skip(buffer, 3);                           // handshake message length
+            skip(buffer, 2 + 32);                      // client version and random
+            skip(buffer, buffer.get() & 0xFF);         // session id
+            skip(buffer, buffer.getShort() & 0xFFFF);  // cipher suites
+            skip(buffer, buffer.get() & 0xFF);         // compression methods
+
+            if (buffer.remaining() < 2)
+            {
+                return null; // no extensions
+            }
+            int extensionsLength = buffer.getShort() & 0xFFFF;
+            buffer.limit(Math.min(buffer.limit(), buffer.position() + extensionsLength));
+
+            while (buffer.remaining() >= 4)
+            {
+                int extensionType = buffer.getShort() & 0xFFFF;
+                int extensionLength = buffer.getShort() & 0xFFFF;
+                if (extensionType != SERVER_NAME_EXTENSION)
+                {
+                    skip(buffer, extensionLength);
+                    continue;
+                }
+
+                int listLength = buffer.getShort() & 0xFFFF;
+                buffer.limit(Math.min(buffer.limit(), buffer.position() + listLength));
+                while (buffer.remaining() >= 3)
+                {
+                    int nameType = buffer.get() & 0xFF;
+                    int nameLength = buffer.getShort() & 0xFFFF;
+                    if (nameType == HOST_NAME_TYPE)
+                    {
+                        byte[] name = new byte[nameLength];
+                        buffer.get(name);
+                        return new String(name, StandardCharsets.US_ASCII);
+                    }
+                    skip(buffer, nameLength);
+                }
+                return null;
+            }
+        }
+        catch (BufferUnderflowException | IllegalArgumentException e)
+        {
+            // Truncated or malformed, so treat as naming no host
+        }
+
+        return null;
+    }
+
+    private static void skip(ByteBuffer buffer, int length)
+    {
+        buffer.position(buffer.position() + length);
+    }
+}
@@ -24,6 +24,8 @@ package org.apache.qpid.proton.engine.impl.ssl;
 import static org.apache.qpid.proton.engine.impl.ByteBufferUtils.newWriteableBuffer;
 
 import java.nio.ByteBuffer;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.Executor;
 import java.util.logging.Level;
 import java.util.logging.Logger;
 
@@ -32,19 +34,30 @@ import javax.net.ssl.SSLEngineResult.HandshakeStatus;
 import javax.net.ssl.SSLEngineResult.Status;
 import javax.net.ssl.SSLException;
 
+import org.apache.qpid.proton.engine.HandshakeTimings.Phase;
 import org.apache.qpid.proton.engine.Transport;
 import org.apache.qpid.proton.engine.TransportException;
+import org.apache.qpid.proton.engine.impl.HandshakeTimingsImpl;
 import org.apache.qpid.proton.engine.impl.TransportInput;
 import org.apache.qpid.proton.engine.impl.TransportOutput;
 
 /**
  * TODO close the SSLEngine when told to, and modify {@link #wrapOutput()} and {@link #unwrapInput()}
  * to respond appropriately thereafter.
+ *
+ * When constructed with a record executor, bulk wrap and unwrap work is handed to that executor once
+ * the handshake is complete, so that encryption and decryption of one batch of records overlaps the
+ * AMQP processing of the previous one.  At most one wrap and one unwrap batch is in flight at a time,
+ * which keeps records in order, and anything other than steady state traffic (handshaking, closure,
+ * errors) is handled synchronously as before.
  */
 public class SimpleSslTransportWrapper implements SslTransportWrapper
 {
     private static final Logger _logger = Logger.getLogger(SimpleSslTransportWrapper.class.getName());
 
+    /** The number of packets worth of data handed to the record executor in each batch. */
+    private static final int PACKETS_PER_BATCH = 4;
+
     private final ProtonSslEngine _sslEngine;
 
     private final TransportInput _underlyingInput;
@@ -70,20 +83,54 @@ public class SimpleSslTransportWrapper implements SslTransportWrapper
     /** could change during the lifetime of the ssl connection owing to renegotiation. */
     private String _protocolName;
 
+    /** null unless wrap and unwrap batches are pipelined onto another thread. */
+    private final Executor _recordExecutor;
+
+    private ByteBuffer _wrapSource;
+    private ByteBuffer _wrapTarget;
+    private RecordBatch _wrapBatch;
+
+    private ByteBuffer[] _unwrapTargets;
+    private int _nextUnwrapTarget;
+    private RecordBatch _unwrapBatch;
+
+    /** null unless the transport's handshake timings are to be told when the handshake finishes. */
+    private HandshakeTimingsImpl _handshakeTimings;
 
     SimpleSslTransportWrapper(ProtonSslEngine sslEngine, TransportInput underlyingInput, TransportOutput underlyingOutput)
+    {
+        this(sslEngine, underlyingInput, underlyingOutput, null);
+    }
+
+    SimpleSslTransportWrapper(ProtonSslEngine sslEngine, TransportInput underlyingInput, TransportOutput underlyingOutput, Executor recordExecutor)
     {
         _underlyingInput = underlyingInput;
         _underlyingOutput = underlyingOutput;
         _sslEngine = sslEngine;
+        _recordExecutor = recordExecutor;
 
         int effectiveAppBufferMax = _sslEngine.getEffectiveApplicationBufferSize();
         int packetSize = _sslEngine.getPacketBufferSize();
 
-        // Input and output buffers need to be large enough to contain one SSL packet,
-        // as stated in SSLEngine JavaDoc.
-        _inputBuffer = newWriteableBuffer(packetSize);
-        _outputBuffer = newWriteableBuffer(packetSize);
+        if (_recordExecutor == null)
+        {
+            // Input and output buffers need to be large enough to contain one SSL packet,
+            // as stated in SSLEngine JavaDoc.
+            _inputBuffer = newWriteableBuffer(packetSize);
+            _outputBuffer = newWriteableBuffer(packetSize);
+        }
+        else
+        {
+            // Room for a batch being processed plus the next one, on both sides.
+            _wrapSource = newWriteableBuffer(PACKETS_PER_BATCH * effectiveAppBufferMax);
+            _wrapTarget = newWriteableBuffer((PACKETS_PER_BATCH + 1) * packetSize);
+            _unwrapTargets = new ByteBuffer[] {
+                newWriteableBuffer(PACKETS_PER_BATCH * packetSize + effectiveAppBufferMax),
+                newWriteableBuffer(PACKETS_PER_BATCH * packetSize + effectiveAppBufferMax) };
+
+            _inputBuffer = newWriteableBuffer(2 * PACKETS_PER_BATCH * packetSize);
+            _outputBuffer = newWriteableBuffer(2 * _wrapTarget.capacity());
+        }
         _head = _outputBuffer.asReadOnlyBuffer();
         _head.limit(0);
 
@@ -114,37 +161,9 @@ public class SimpleSslTransportWrapper implements SslTransportWrapper
             Status status = result.getStatus();
             HandshakeStatus hstatus = result.getHandshakeStatus();
 
-            int capacity = _underlyingInput.capacity();
-            if (capacity == Transport.END_OF_STREAM || capacity <= 0) {
-                _tail_closed = true;
-                if (_decodedInputBuffer.position() > 0) {
-                    throw new TransportException("bytes left unconsumed");
-                }
-            } else {
-                _decodedInputBuffer.flip();
-
-                while (_decodedInputBuffer.hasRemaining() && capacity > 0) {
-                    ByteBuffer tail = _underlyingInput.tail();
-                    int limit = _decodedInputBuffer.limit();
-                    int overflow = _decodedInputBuffer.remaining() - capacity;
-                    if (overflow > 0) {
-                        _decodedInputBuffer.limit(limit - overflow);
-                    }
-                    tail.put(_decodedInputBuffer);
-                    _decodedInputBuffer.limit(limit);
-                    _underlyingInput.process();
-                    capacity = _underlyingInput.capacity();
-                }
-
-                if (capacity == Transport.END_OF_STREAM || capacity <= 0) {
-                    _tail_closed = true;
-                    if (_decodedInputBuffer.hasRemaining()) {
-                        throw new TransportException("bytes left unconsumed");
-                    }
-                }
-
-                _decodedInputBuffer.compact();
-            }
+            _decodedInputBuffer.flip();
+            passDecodedInput(_decodedInputBuffer);
+            _decodedInputBuffer.compact();
 
             switch (status) {
             case CLOSED:
@@ -196,6 +215,167 @@ public class SimpleSslTransportWrapper implements SslTransportWrapper
         }
     }
 
+    /**
+     * Passes the readable contents of the given decoded buffer to {@link #_underlyingInput}, failing if
+     * the underlying input stops accepting bytes before all of them have been passed on.
+     */
+    private void passDecodedInput(ByteBuffer decoded)
+    {
+        int capacity = _underlyingInput.capacity();
+
+        while (decoded.hasRemaining() && capacity > 0) {
+            ByteBuffer tail = _underlyingInput.tail();
+            int limit = decoded.limit();
+            int overflow = decoded.remaining() - capacity;
+            if (overflow > 0) {
+                decoded.limit(limit - overflow);
+            }
+            tail.put(decoded);
+            decoded.limit(limit);
+            _underlyingInput.process();
+            capacity = _underlyingInput.capacity();
+        }
+
+        if (capacity == Transport.END_OF_STREAM || capacity <= 0) {
+            _tail_closed = true;
+            if (decoded.hasRemaining()) {
+                throw new TransportException("bytes left unconsumed");
+            }
+        }
+    }
+
+    /**
+     * Unwraps as much of {@link #_inputBuffer} as possible in batches on the record executor.  Each
+     * batch is decoded while the output of the previous one is passed to {@link #_underlyingInput}.
+     *
+     * On exit {@link #_inputBuffer} is positioned at the first byte not yet unwrapped, and no batch
+     * is in flight.
+     */
+    private void pipelineInput() throws SSLException
+    {
+        _unwrapBatch = submitUnwrapBatch();
+
+        while (_unwrapBatch != null) {
+            RecordBatch batch = _unwrapBatch;
+            _unwrapBatch = null;
+
+            batch.await();
+            _inputBuffer.position(batch._source.position());
+
+            if (batch.canContinue() && !_tail_closed &&
+                (batch._source.hasRemaining() ? batch._source.limit() < _inputBuffer.limit() : _inputBuffer.hasRemaining())) {
+                _unwrapBatch = submitUnwrapBatch();
+            }
+
+            batch._target.flip();
+            passDecodedInput(batch._target);
+        }
+    }
+
+    private RecordBatch submitUnwrapBatch()
+    {
+        if (_tail_closed || _decodedInputBuffer.position() > 0 || !_inputBuffer.hasRemaining() ||
+            _sslEngine.getHandshakeStatus() != HandshakeStatus.NOT_HANDSHAKING) {
+            return null;
+        }
+
+        ByteBuffer source = _inputBuffer.duplicate();
+        source.limit(Math.min(source.limit(), source.position() + PACKETS_PER_BATCH * _sslEngine.getPacketBufferSize()));
+
+        ByteBuffer target = _unwrapTargets[_nextUnwrapTarget];
+        _nextUnwrapTarget = (_nextUnwrapTarget + 1) % _unwrapTargets.length;
+        target.clear();
+
+        RecordBatch batch = new RecordBatch(source, target, false);
+        _recordExecutor.execute(batch);
+        return batch;
+    }
+
+    /**
+     * Waits for any unwrap batch abandoned by a failure part way through {@link #pipelineInput()}, as
+     * its source is a view of {@link #_inputBuffer}.
+     */
+    private void abandonUnwrapBatch()
+    {
+        if (_unwrapBatch != null) {
+            RecordBatch batch = _unwrapBatch;
+            _unwrapBatch = null;
+
+            batch.awaitQuietly();
+            _inputBuffer.position(batch._source.position());
+        }
+    }
+
+    /**
+     * Wraps the underlying transport's output in batches on the record executor, falling back to
+     * {@link #wrapOutput()} whenever the output can't be batched.  A batch may be left in flight on
+     * exit, but only while there are already encoded bytes waiting in {@link #_outputBuffer}.
+     */
+    private void pipelineOutput() throws SSLException
+    {
+        if (_wrapBatch != null) {
+            // Leave the batch until the head is drained, so pending() is stable between pops.
+            if (_outputBuffer.position() > 0) {
+                return;
+            }
+            if (!completeWrapBatch()) {
+                wrapOutput();
+                return;
+            }
+        }
+
+        // Only batch when there is room to take the result, otherwise wait for the head to be popped.
+        while (_outputBuffer.remaining() >= _wrapTarget.capacity()) {
+            if (_sslEngine.getHandshakeStatus() != HandshakeStatus.NOT_HANDSHAKING ||
+                _underlyingOutput.pending() < _sslEngine.getEffectiveApplicationBufferSize()) {
+                wrapOutput();
+                return;
+            }
+
+            ByteBuffer clear = _underlyingOutput.head().duplicate();
+            clear.limit(Math.min(clear.limit(), clear.position() + _wrapSource.capacity()));
+
+            _wrapSource.clear();
+            _wrapSource.put(clear);
+            _wrapSource.flip();
+            _wrapTarget.clear();
+
+            _wrapBatch = new RecordBatch(_wrapSource, _wrapTarget, true);
+            _recordExecutor.execute(_wrapBatch);
+
+            if (_outputBuffer.position() > 0) {
+                return;
+            }
+            if (!completeWrapBatch()) {
+                wrapOutput();
+                return;
+            }
+        }
+    }
+
+    /**
+     * Waits for the in flight wrap batch and moves its output to {@link #_outputBuffer}.
+     *
+     * @return true if batching can continue, false if the engine needs attention from {@link #wrapOutput()}.
+     */
+    private boolean completeWrapBatch() throws SSLException
+    {
+        RecordBatch batch = _wrapBatch;
+        _wrapBatch = null;
+
+        batch.await();
+
+        _underlyingOutput.pop(batch._source.position());
+        batch._target.flip();
+        _outputBuffer.put(batch._target);
+
+        if (batch._result != null && batch._result.getStatus() == Status.CLOSED) {
+            _head_closed = true;
+        }
+
+        return batch.canContinue() && !batch._source.hasRemaining();
+    }
+
     /**
      * Wrap the underlying transport's output, passing it to the output buffer.
      *
@@ -284,12 +464,22 @@ public class SimpleSslTransportWrapper implements SslTransportWrapper
         return _protocolName;
     }
 
+    void setHandshakeTimings(HandshakeTimingsImpl handshakeTimings)
+    {
+        _handshakeTimings = handshakeTimings;
+    }
+
     private void updateCipherAndProtocolName(SSLEngineResult result)
     {
         if (result.getHandshakeStatus() == HandshakeStatus.FINISHED)
         {
             _cipherName = _sslEngine.getCipherSuite();
             _protocolName = _sslEngine.getProtocol();
+
+            if (_handshakeTimings != null)
+            {
+                _handshakeTimings.phaseReached(Phase.TLS_FINISHED);
+            }
         }
     }
 
@@ -358,12 +548,16 @@ public class SimpleSslTransportWrapper implements SslTransportWrapper
         _inputBuffer.flip();
 
         try {
+            if (_recordExecutor != null) {
+                pipelineInput();
+            }
             unwrapInput();
         } catch (SSLException e) {
             _logger.log(Level.WARNING, e.getMessage());
             _inputBuffer.position(_inputBuffer.limit());
             _tail_closed = true;
         } finally {
+            abandonUnwrapBatch();
             _inputBuffer.compact();
         }
     }
@@ -382,7 +576,11 @@ public class SimpleSslTransportWrapper implements SslTransportWrapper
     public int pending()
     {
         try {
-            wrapOutput();
+            if (_recordExecutor != null) {
+                pipelineOutput();
+            } else {
+                wrapOutput();
+            }
         } catch (SSLException e) {
             _logger.log(Level.WARNING, e.getMessage());
             _head_closed = true;
@@ -425,6 +623,100 @@ public class SimpleSslTransportWrapper implements SslTransportWrapper
     }
 
 
+    /**
+     * A run of wrap or unwrap calls over one batch of records, executed on the record executor.  The
+     * batch stops early on anything other than a plain OK result outside of handshaking, leaving the
+     * rest of its source for the synchronous path.
+     */
+    private final class RecordBatch implements Runnable
+    {
+        private final ByteBuffer _source;
+        private final ByteBuffer _target;
+        private final boolean _wrap;
+        private final CountDownLatch _done = new CountDownLatch(1);
+
+        private SSLEngineResult _result;
+        private int _consumed;
+        private SSLException _failure;
+        private RuntimeException _runtimeFailure;
+
+        RecordBatch(ByteBuffer source, ByteBuffer target, boolean wrap)
+        {
+            _source = source;
+            _target = target;
+            _wrap = wrap;
+        }
+
+        @Override
+        public void run()
+        {
+            try {
+                while (_source.hasRemaining()) {
+                    if (_wrap) {
+                        _result = _sslEngine.wrap(_source, _target);
+                        logEngineClientModeAndResult(_result, "output");
+                    } else {
+                        _result = _sslEngine.unwrap(_source, _target);
+                        logEngineClientModeAndResult(_result, "input");
+                    }
+
+                    _consumed += _result.bytesConsumed();
+
+                    if (_result.getStatus() != Status.OK ||
+                        _result.getHandshakeStatus() != HandshakeStatus.NOT_HANDSHAKING ||
+                        (_result.bytesConsumed() == 0 && _result.bytesProduced() == 0)) {
+                        break;
+                    }
+                }
+            } catch (SSLException e) {
+                _failure = e;
+            } catch (RuntimeException e) {
+                _runtimeFailure = e;
+            } finally {
+                _done.countDown();
+            }
+        }
+
+        /**
+         * @return true if the engine is still in a state where further batches can be processed.
+         */
+        boolean canContinue()
+        {
+            return _result != null && _consumed > 0 &&
+                   _result.getHandshakeStatus() == HandshakeStatus.NOT_HANDSHAKING &&
+                   (_result.getStatus() == Status.OK || (!_wrap && _result.getStatus() == Status.BUFFER_UNDERFLOW));
+        }
+
+        void await() throws SSLException
+        {
+            awaitQuietly();
+
+            if (_failure != null) {
+                throw _failure;
+            }
+            if (_runtimeFailure != null) {
+                throw _runtimeFailure;
+            }
+        }
+
+        void awaitQuietly()
+        {
+            boolean interrupted = false;
+            while (true) {
+                try {
+                    _done.await();
+                    break;
+                } catch (InterruptedException e) {
+                    interrupted = true;
+                }
+            }
+
+            if (interrupted) {
+                Thread.currentThread().interrupt();
+            }
+        }
+    }
+
     @Override
     public String toString()
     {
@@ -435,6 +727,7 @@ public class SimpleSslTransportWrapper implements SslTransportWrapper
             .append(", decodedInputBuffer=").append(_decodedInputBuffer)
             .append(", cipherName=").append(_cipherName)
             .append(", protocolName=").append(_protocolName)
+            .append(", recordExecutor=").append(_recordExecutor)
             .append("]");
         return builder.toString();
     }
@@ -18,11 +18,15 @@
  */
 package org.apache.qpid.proton.engine.impl.ssl;
 
+import java.util.concurrent.Executor;
+
 import javax.net.ssl.SSLContext;
 import org.apache.qpid.proton.ProtonUnsupportedOperationException;
 import org.apache.qpid.proton.engine.ProtonJSslDomain;
 import org.apache.qpid.proton.engine.SslDomain;
 import org.apache.qpid.proton.engine.SslPeerDetails;
+import org.apache.qpid.proton.engine.SslPeerValidationCache;
+import org.apache.qpid.proton.engine.SslServerNameMapping;
 
 public class SslDomainImpl implements SslDomain, ProtonSslEngineProvider, ProtonJSslDomain
 {
@@ -33,7 +37,11 @@ public class SslDomainImpl implements SslDomain, ProtonSslEngineProvider, Proton
     private String _privateKeyPassword;
     private String _trustedCaDb;
     private boolean _allowUnsecuredClient;
-    private SSLContext _sslContext;
+    // May be replaced from another thread while handshakes are creating engines from it
+    private volatile SSLContext _sslContext;
+    private Executor _recordProcessingExecutor;
+    private SslPeerValidationCache _peerValidationCache;
+    private SslServerNameMapping _serverNameMapping;
 
     private final SslEngineFacadeFactory _sslEngineFacadeFactory = new SslEngineFacadeFactory();
 
@@ -83,6 +91,7 @@ public class SslDomainImpl implements SslDomain, ProtonSslEngineProvider, Proton
     public void setSslContext(SSLContext sslContext)
     {
         _sslContext = sslContext;
+        _sslEngineFacadeFactory.resetCache();
     }
 
     @Override
@@ -139,12 +148,56 @@ public class SslDomainImpl implements SslDomain, ProtonSslEngineProvider, Proton
         return _allowUnsecuredClient;
     }
 
+    @Override
+    public void setRecordProcessingExecutor(Executor executor)
+    {
+        _recordProcessingExecutor = executor;
+    }
+
+    @Override
+    public Executor getRecordProcessingExecutor()
+    {
+        return _recordProcessingExecutor;
+    }
+
+    @Override
+    public void setPeerValidationCache(SslPeerValidationCache cache)
+    {
+        _peerValidationCache = cache;
+        _sslEngineFacadeFactory.resetCache();
+    }
+
+    @Override
+    public SslPeerValidationCache getPeerValidationCache()
+    {
+        return _peerValidationCache;
+    }
+
+    @Override
+    public void setServerNameMapping(SslServerNameMapping mapping)
+    {
+        _serverNameMapping = mapping;
+    }
+
+    @Override
+    public SslServerNameMapping getServerNameMapping()
+    {
+        return _serverNameMapping;
+    }
+
     @Override
     public ProtonSslEngine createSslEngine(SslPeerDetails peerDetails)
     {
         return _sslEngineFacadeFactory.createProtonSslEngine(this, peerDetails);
     }
 
+    @Override
+    public ProtonSslEngine createSslEngine(SslPeerDetails peerDetails, String serverName)
+    {
+        SSLContext sslContext = _serverNameMapping == null ? null : _serverNameMapping.getContext(serverName);
+        return _sslEngineFacadeFactory.createProtonSslEngine(this, peerDetails, sslContext);
+    }
+
     @Override
     public String toString()
     {
@@ -57,8 +57,10 @@ import javax.net.ssl.TrustManager;
 import javax.net.ssl.TrustManagerFactory;
 import javax.net.ssl.X509TrustManager;
 
+import org.apache.qpid.proton.engine.ProtonJSslDomain;
 import org.apache.qpid.proton.engine.SslDomain;
 import org.apache.qpid.proton.engine.SslPeerDetails;
+import org.apache.qpid.proton.engine.SslPeerValidationCache;
 import org.apache.qpid.proton.engine.TransportException;
 
 public class SslEngineFacadeFactory
@@ -73,83 +75,89 @@ public class SslEngineFacadeFactory
      */
     private static final String TLS_PROTOCOL = "TLS";
 
-    // BouncyCastle Reflection Helpers
-    private static final Constructor<?> pemParserCons;
-    private static final Method         pemReadMethod;
-
-    private static final Constructor<?> JcaPEMKeyConverterCons;
-    private static final Class<?>       PEMKeyPairClass;
-    private static final Method         getKeyPairMethod;
-    private static final Method         getPrivateKeyMethod;
-
-    private static final Class<?>       PEMEncryptedKeyPairClass;
-    private static final Method         decryptKeyPairMethod;
-
-    private static final Constructor<?> JcePEMDecryptorProviderBuilderCons;
-    private static final Method         builderMethod;
-
-    private static final Class<?>       PrivateKeyInfoClass;
-    private static final Exception      bouncyCastleSetupException;
-
-    static
+    /**
+     * Holds the reflectively resolved BouncyCastle classes and methods used to read PEM private
+     * keys. BouncyCastle is only looked up, and its provider registered, when a private key is
+     * first read rather than whenever SSL is used.
+     */
+    private static final class BouncyCastle
     {
-        // Setup BouncyCastle Reflection artifacts
-        Constructor<?> pemParserConsResult = null;
-        Method         pemReadMethodResult = null;
-        Constructor<?> JcaPEMKeyConverterConsResult = null;
-        Class<?>       PEMKeyPairClassResult = null;
-        Method         getKeyPairMethodResult = null;
-        Method         getPrivateKeyMethodResult = null;
-        Class<?>       PEMEncryptedKeyPairClassResult = null;
-        Method         decryptKeyPairMethodResult = null;
-        Constructor<?> JcePEMDecryptorProviderBuilderConsResult = null;
-        Method         builderMethodResult = null;
-        Class<?>       PrivateKeyInfoClassResult = null;
-        Exception      bouncyCastleSetupExceptionResult = null;
+        private static final Constructor<?> pemParserCons;
+        private static final Method         pemReadMethod;
+
+        private static final Constructor<?> JcaPEMKeyConverterCons;
+        private static final Class<?>       PEMKeyPairClass;
+        private static final Method         getKeyPairMethod;
+        private static final Method         getPrivateKeyMethod;
+
+        private static final Class<?>       PEMEncryptedKeyPairClass;
+        private static final Method         decryptKeyPairMethod;
+
+        private static final Constructor<?> JcePEMDecryptorProviderBuilderCons;
+        private static final Method         builderMethod;
+
+        private static final Class<?>       PrivateKeyInfoClass;
+        private static final Exception      setupException;
+
+        static
+        {
+            Constructor<?> pemParserConsResult = null;
+            Method         pemReadMethodResult = null;
+            Constructor<?> JcaPEMKeyConverterConsResult = null;
+            Class<?>       PEMKeyPairClassResult = null;
+            Method         getKeyPairMethodResult = null;
+            Method         getPrivateKeyMethodResult = null;
+            Class<?>       PEMEncryptedKeyPairClassResult = null;
+            Method         decryptKeyPairMethodResult = null;
+            Constructor<?> JcePEMDecryptorProviderBuilderConsResult = null;
+            Method         builderMethodResult = null;
+            Class<?>       PrivateKeyInfoClassResult = null;
+            Exception      setupExceptionResult = null;
 
-        try
-        {
-            final Class<?> pemParserClass = Class.forName("org.bouncycastle.openssl.PEMParser");
-            pemParserConsResult = pemParserClass.getConstructor(Reader.class);
-            pemReadMethodResult = pemParserClass.getMethod("readObject");
+            try
+            {
+                final Class<?> pemParserClass = Class.forName("org.bouncycastle.openssl.PEMParser");
+                pemParserConsResult = pemParserClass.getConstructor(Reader.class);
+                pemReadMethodResult = pemParserClass.getMethod("readObject");
 
-            final Class<?> jcaPEMKeyConverterClass = Class.forName("org.bouncycastle.openssl.jcajce.JcaPEMKeyConverter");
-            JcaPEMKeyConverterConsResult = jcaPEMKeyConverterClass.getConstructor();
-            PEMKeyPairClassResult = Class.forName("org.bouncycastle.openssl.PEMKeyPair");
-            getKeyPairMethodResult = jcaPEMKeyConverterClass.getMethod("getKeyPair", PEMKeyPairClassResult);
+                final Class<?> jcaPEMKeyConverterClass = Class.forName("org.bouncycastle.openssl.jcajce.JcaPEMKeyConverter");
+                JcaPEMKeyConverterConsResult = jcaPEMKeyConverterClass.getConstructor();
+                PEMKeyPairClassResult = Class.forName("org.bouncycastle.openssl.PEMKeyPair");
+                getKeyPairMethodResult = jcaPEMKeyConverterClass.getMethod("getKeyPair", PEMKeyPairClassResult);
 
-            final Class<?> PEMDecrypterProvider = Class.forName("org.bouncycastle.openssl.PEMDecryptorProvider");
+                final Class<?> PEMDecrypterProvider = Class.forName("org.bouncycastle.openssl.PEMDecryptorProvider");
 
-            PEMEncryptedKeyPairClassResult = Class.forName("org.bouncycastle.openssl.PEMEncryptedKeyPair");
-            decryptKeyPairMethodResult = PEMEncryptedKeyPairClassResult.getMethod("decryptKeyPair", PEMDecrypterProvider);
+                PEMEncryptedKeyPairClassResult = Class.forName("org.bouncycastle.openssl.PEMEncryptedKeyPair");
+                decryptKeyPairMethodResult = PEMEncryptedKeyPairClassResult.getMethod("decryptKeyPair", PEMDecrypterProvider);
 
-            final Class<?> jcePEMDecryptorProviderBuilderClass = Class.forName(
-                    "org.bouncycastle.openssl.jcajce.JcePEMDecryptorProviderBuilder");
-            JcePEMDecryptorProviderBuilderConsResult = jcePEMDecryptorProviderBuilderClass.getConstructor();
-            builderMethodResult = jcePEMDecryptorProviderBuilderClass.getMethod("build", char[].class);
+                final Class<?> jcePEMDecryptorProviderBuilderClass = Class.forName(
+                        "org.bouncycastle.openssl.jcajce.JcePEMDecryptorProviderBuilder");
+                JcePEMDecryptorProviderBuilderConsResult = jcePEMDecryptorProviderBuilderClass.getConstructor();
+                builderMethodResult = jcePEMDecryptorProviderBuilderClass.getMethod("build", char[].class);
 
-            PrivateKeyInfoClassResult = Class.forName("org.bouncycastle.asn1.pkcs.PrivateKeyInfo");
-            getPrivateKeyMethodResult = jcaPEMKeyConverterClass.getMethod("getPrivateKey", PrivateKeyInfoClassResult);
+                PrivateKeyInfoClassResult = Class.forName("org.bouncycastle.asn1.pkcs.PrivateKeyInfo");
+                getPrivateKeyMethodResult = jcaPEMKeyConverterClass.getMethod("getPrivateKey", PrivateKeyInfoClassResult);
 
-            registerBouncyCastleProvider();
-        }
-        catch (Exception e)
-        {
-            bouncyCastleSetupExceptionResult = e;
-        }
-        finally {
-            pemParserCons = pemParserConsResult;
-            pemReadMethod = pemReadMethodResult;
-            JcaPEMKeyConverterCons = JcaPEMKeyConverterConsResult;
-            PEMKeyPairClass = PEMKeyPairClassResult;
-            getKeyPairMethod = getKeyPairMethodResult;
-            getPrivateKeyMethod = getPrivateKeyMethodResult;
-            PEMEncryptedKeyPairClass = PEMEncryptedKeyPairClassResult;
-            decryptKeyPairMethod = decryptKeyPairMethodResult;
-            JcePEMDecryptorProviderBuilderCons = JcePEMDecryptorProviderBuilderConsResult;
-            builderMethod = builderMethodResult;
-            PrivateKeyInfoClass = PrivateKeyInfoClassResult;
-            bouncyCastleSetupException = bouncyCastleSetupExceptionResult;
+                registerBouncyCastleProvider();
+            }
+            catch (Exception e)
+            {
+                setupExceptionResult = e;
+            }
+            finally {
+                pemParserCons = pemParserConsResult;
+                pemReadMethod = pemReadMethodResult;
+                JcaPEMKeyConverterCons = JcaPEMKeyConverterConsResult;
+                PEMKeyPairClass = PEMKeyPairClassResult;
+                getKeyPairMethod = getKeyPairMethodResult;
+                getPrivateKeyMethod = getPrivateKeyMethodResult;
+                PEMEncryptedKeyPairClass = PEMEncryptedKeyPairClassResult;
+                decryptKeyPairMethod = decryptKeyPairMethodResult;
+                JcePEMDecryptorProviderBuilderCons = JcePEMDecryptorProviderBuilderConsResult;
+                builderMethod = builderMethodResult;
+                PrivateKeyInfoClass = PrivateKeyInfoClassResult;
+                setupException = setupExceptionResult;
+            }
         }
     }
 
@@ -184,8 +192,8 @@ public class SslEngineFacadeFactory
             "SSL_DH_anon_WITH_DES_CBC_SHA",
             "SSL_DH_anon_EXPORT_WITH_DES40_CBC_SHA");
 
-    /** lazily initialized */
-    private SSLContext _sslContext;
+    /** lazily initialized, volatile as {@link #resetCache()} may be called from another thread */
+    private volatile SSLContext _sslContext;
 
 
     /**
@@ -196,7 +204,18 @@ public class SslEngineFacadeFactory
      */
     public ProtonSslEngine createProtonSslEngine(SslDomain domain, SslPeerDetails peerDetails)
     {
-        SSLEngine engine = createAndInitialiseSslEngine(domain, peerDetails);
+        return createProtonSslEngine(domain, peerDetails, null);
+    }
+
+    /**
+     * As {@link #createProtonSslEngine(SslDomain, SslPeerDetails)}, but creating the engine from
+     * the given context rather than the domain's own.
+     *
+     * @param sslContext the context to create the engine from, or null to use the domain's own.
+     */
+    public ProtonSslEngine createProtonSslEngine(SslDomain domain, SslPeerDetails peerDetails, SSLContext sslContext)
+    {
+        SSLEngine engine = createAndInitialiseSslEngine(domain, peerDetails, sslContext);
         if(_logger.isLoggable(Level.FINE))
         {
             _logger.fine("Created SSL engine: " + engineToString(engine));
@@ -215,11 +234,11 @@ public class SslEngineFacadeFactory
     }
 
 
-    private SSLEngine createAndInitialiseSslEngine(SslDomain domain, SslPeerDetails peerDetails)
+    private SSLEngine createAndInitialiseSslEngine(SslDomain domain, SslPeerDetails peerDetails, SSLContext selectedSslContext)
     {
         SslDomain.Mode mode = domain.getMode();
 
-        SSLContext sslContext = getOrCreateSslContext(domain);
+        SSLContext sslContext = selectedSslContext != null ? selectedSslContext : getOrCreateSslContext(domain);
         SSLEngine sslEngine = createSslEngine(sslContext, peerDetails);
 
         if (domain.getPeerAuthentication() == SslDomain.VerifyMode.ANONYMOUS_PEER)
@@ -280,11 +299,16 @@ public class SslEngineFacadeFactory
 
     private SSLContext getOrCreateSslContext(SslDomain sslDomain)
     {
-        if(_sslContext == null && sslDomain.getSslContext() != null)
+        // Read afresh for each engine rather than cached, so that a context replaced from another
+        // thread is used by the next handshake and cannot be overwritten by a stale copy
+        SSLContext domainSslContext = sslDomain.getSslContext();
+        if(domainSslContext != null)
         {
-            _sslContext = sslDomain.getSslContext();
+            return domainSslContext;
         }
-        else if(_sslContext == null)
+
+        SSLContext cachedSslContext = _sslContext;
+        if(cachedSslContext == null)
         {
             if(_logger.isLoggable(Level.FINE))
             {
@@ -310,11 +334,11 @@ public class SslEngineFacadeFactory
                 {
                     TrustManagerFactory tmf = TrustManagerFactory.getInstance(TrustManagerFactory.getDefaultAlgorithm());
                     tmf.init(ksKeys);
-                    trustManagers = tmf.getTrustManagers();
+                    trustManagers = wrapTrustManagers(sslDomain, tmf.getTrustManagers());
                 }
 
                 sslContext.init(kmf.getKeyManagers(), trustManagers, null);
-                _sslContext = sslContext;
+                _sslContext = cachedSslContext = sslContext;
             }
             catch (NoSuchAlgorithmException e)
             {
@@ -333,7 +357,21 @@ public class SslEngineFacadeFactory
                 throw new TransportException("Unexpected exception creating SSLContext", e);
             }
         }
-        return _sslContext;
+        return cachedSslContext;
+    }
+
+    private TrustManager[] wrapTrustManagers(SslDomain sslDomain, TrustManager[] trustManagers)
+    {
+        if (sslDomain instanceof ProtonJSslDomain)
+        {
+            SslPeerValidationCache cache = ((ProtonJSslDomain) sslDomain).getPeerValidationCache();
+            if (cache instanceof SslPeerValidationCacheImpl)
+            {
+                return ((SslPeerValidationCacheImpl) cache).wrap(trustManagers);
+            }
+        }
+
+        return trustManagers;
     }
 
     private KeyStore createKeyStoreFrom(SslDomain sslDomain, char[] dummyPassword)
@@ -495,9 +533,9 @@ public class SslEngineFacadeFactory
 
     PrivateKey readPrivateKey(String pemFile, String password)
     {
-        if (bouncyCastleSetupException != null)
+        if (BouncyCastle.setupException != null)
         {
-            throw new TransportException("BouncyCastle failed to load", bouncyCastleSetupException);
+            throw new TransportException("BouncyCastle failed to load", BouncyCastle.setupException);
         }
 
         final Object pemObject = readPemObject(pemFile);
@@ -505,31 +543,31 @@ public class SslEngineFacadeFactory
 
         try
         {
-            Object keyConverter = JcaPEMKeyConverterCons.newInstance();
+            Object keyConverter = BouncyCastle.JcaPEMKeyConverterCons.newInstance();
             setProvider(keyConverter, "BC");
 
-            if (PEMEncryptedKeyPairClass.isInstance(pemObject))
+            if (BouncyCastle.PEMEncryptedKeyPairClass.isInstance(pemObject))
             {
-                Object decryptorBuilder = JcePEMDecryptorProviderBuilderCons.newInstance();
+                Object decryptorBuilder = BouncyCastle.JcePEMDecryptorProviderBuilderCons.newInstance();
 
                 // Build a PEMDecryptProvider
-                Object decryptProvider = builderMethod.invoke(decryptorBuilder, password.toCharArray());
+                Object decryptProvider = BouncyCastle.builderMethod.invoke(decryptorBuilder, password.toCharArray());
 
-                Object decryptedKeyPair = decryptKeyPairMethod.invoke(pemObject, decryptProvider);
-                KeyPair keyPair = (KeyPair) getKeyPairMethod.invoke(keyConverter, decryptedKeyPair);
+                Object decryptedKeyPair = BouncyCastle.decryptKeyPairMethod.invoke(pemObject, decryptProvider);
+                KeyPair keyPair = (KeyPair) BouncyCastle.getKeyPairMethod.invoke(keyConverter, decryptedKeyPair);
 
                 privateKey = keyPair.getPrivate();
             }
-            else if (PEMKeyPairClass.isInstance(pemObject))
+            else if (BouncyCastle.PEMKeyPairClass.isInstance(pemObject))
             {
                 // It's a KeyPair but not encrypted.
-                KeyPair keyPair = (KeyPair) getKeyPairMethod.invoke(keyConverter, pemObject);
+                KeyPair keyPair = (KeyPair) BouncyCastle.getKeyPairMethod.invoke(keyConverter, pemObject);
                 privateKey = keyPair.getPrivate();
             }
-            else if (PrivateKeyInfoClass.isInstance(pemObject))
+            else if (BouncyCastle.PrivateKeyInfoClass.isInstance(pemObject))
             {
                 // It's an unencrypted private key
-                privateKey = (PrivateKey) getPrivateKeyMethod.invoke(keyConverter, pemObject);
+                privateKey = (PrivateKey) BouncyCastle.getPrivateKeyMethod.invoke(keyConverter, pemObject);
             }
             else
             {
@@ -558,8 +596,8 @@ public class SslEngineFacadeFactory
         try
         {
             reader = new FileReader(pemFile);
-            pemParser = pemParserCons.newInstance(reader); // = new PEMParser(reader);
-            pemObject = pemReadMethod.invoke(pemParser); // = pemParser.readObject();
+            pemParser = BouncyCastle.pemParserCons.newInstance(reader); // = new PEMParser(reader);
+            pemObject = BouncyCastle.pemReadMethod.invoke(pemParser); // = pemParser.readObject();
         }
         catch (IOException | IllegalAccessException | IllegalArgumentException | InvocationTargetException | InstantiationException e)
         {
@@ -21,13 +21,16 @@
 package org.apache.qpid.proton.engine.impl.ssl;
 
 import java.nio.ByteBuffer;
+import java.util.concurrent.Executor;
 
 import org.apache.qpid.proton.ProtonUnsupportedOperationException;
+import org.apache.qpid.proton.engine.ProtonJSslDomain;
 import org.apache.qpid.proton.engine.Ssl;
 import org.apache.qpid.proton.engine.SslDomain;
 import org.apache.qpid.proton.engine.SslPeerDetails;
 import org.apache.qpid.proton.engine.Transport;
 import org.apache.qpid.proton.engine.TransportException;
+import org.apache.qpid.proton.engine.impl.HandshakeTimingsImpl;
 import org.apache.qpid.proton.engine.impl.PlainTransportWrapper;
 import org.apache.qpid.proton.engine.impl.TransportInput;
 import org.apache.qpid.proton.engine.impl.TransportLayer;
@@ -42,6 +45,7 @@ public class SslImpl implements Ssl, TransportLayer
     private final ProtonSslEngineProvider _protonSslEngineProvider;
 
     private final SslPeerDetails _peerDetails;
+    private final HandshakeTimingsImpl _handshakeTimings;
     private TransportException _initException;
 
     /**
@@ -50,10 +54,19 @@ public class SslImpl implements Ssl, TransportLayer
      * public Proton API.
      */
     public SslImpl(SslDomain domain, SslPeerDetails peerDetails)
+    {
+        this(domain, peerDetails, null);
+    }
+
+    /**
+     * @param handshakeTimings if not null, told when the TLS handshake finishes.
+     */
+    public SslImpl(SslDomain domain, SslPeerDetails peerDetails, HandshakeTimingsImpl handshakeTimings)
     {
         _domain = domain;
         _protonSslEngineProvider = (ProtonSslEngineProvider)domain;
         _peerDetails = peerDetails;
+        _handshakeTimings = handshakeTimings;
     }
 
     public TransportWrapper wrap(TransportInput inputProcessor, TransportOutput outputProcessor)
@@ -227,9 +240,28 @@ public class SslImpl implements Ssl, TransportLayer
             try {
                 if (_initException == null && _transportWrapper == null)
                 {
-                    SslTransportWrapper sslTransportWrapper = new SimpleSslTransportWrapper
-                        (_protonSslEngineProvider.createSslEngine(_peerDetails),
-                         _inputProcessor, _outputProcessor);
+                    Executor recordExecutor = null;
+                    if (_domain instanceof ProtonJSslDomain)
+                    {
+                        recordExecutor = ((ProtonJSslDomain) _domain).getRecordProcessingExecutor();
+                    }
+
+                    SslTransportWrapper sslTransportWrapper;
+                    if (_domain.getMode() == SslDomain.Mode.SERVER && _domain instanceof ProtonJSslDomain
+                        && ((ProtonJSslDomain) _domain).getServerNameMapping() != null)
+                    {
+                        sslTransportWrapper = new ServerNameSelectingTransportWrapper
+                            (_protonSslEngineProvider, _peerDetails, _inputProcessor, _outputProcessor, recordExecutor,
+                             _handshakeTimings);
+                    }
+                    else
+                    {
+                        SimpleSslTransportWrapper simpleSslTransportWrapper = new SimpleSslTransportWrapper
+                            (_protonSslEngineProvider.createSslEngine(_peerDetails),
+                             _inputProcessor, _outputProcessor, recordExecutor);
+                        simpleSslTransportWrapper.setHandshakeTimings(_handshakeTimings);
+                        sslTransportWrapper = simpleSslTransportWrapper;
+                    }
 
                     if (_domain.allowUnsecuredClient() && _domain.getMode() == SslDomain.Mode.SERVER)
                     {
@@ -0,0 +1,353 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine.impl.ssl;
+
+import java.math.BigInteger;
+import java.security.MessageDigest;
+import java.security.NoSuchAlgorithmException;
+import java.security.cert.CertificateEncodingException;
+import java.security.cert.X509CRL;
+import java.security.cert.X509Certificate;
+import java.util.Arrays;
+import java.util.Iterator;
+import java.util.LinkedHashMap;
+import java.util.Map;
+import java.util.concurrent.atomic.AtomicLong;
+
+import javax.net.ssl.TrustManager;
+import javax.net.ssl.X509TrustManager;
+import javax.security.auth.x500.X500Principal;
+
+import org.apache.qpid.proton.engine.SslPeerValidationCache;
+
+public class SslPeerValidationCacheImpl implements SslPeerValidationCache
+{
+    private static final String FINGERPRINT_ALGORITHM = "SHA-256";
+
+    private final int _maxEntries;
+    private final long _timeToLiveMillis;
+    private final Map<Key, Entry> _entries;
+
+    private final AtomicLong _hits = new AtomicLong();
+    private final AtomicLong _misses = new AtomicLong();
+    private final AtomicLong _evictions = new AtomicLong();
+
+    public SslPeerValidationCacheImpl(int maxEntries, long timeToLiveMillis)
+    {
+        if (maxEntries <= 0)
+        {
+            throw new IllegalArgumentException("maxEntries must be positive: " + maxEntries);
+        }
+        if (timeToLiveMillis <= 0)
+        {
+            throw new IllegalArgumentException("timeToLive must be positive: " + timeToLiveMillis);
+        }
+
+        _maxEntries = maxEntries;
+        _timeToLiveMillis = timeToLiveMillis;
+        _entries = new LinkedHashMap<Key, Entry>(16, 0.75f, true)
+        {
+            private static final long serialVersionUID = 1L;
+
+            @Override
+            protected boolean removeEldestEntry(Map.Entry<Key, Entry> eldest)
+            {
+                if (size() > _maxEntries)
+                {
+                    _evictions.incrementAndGet();
+                    return true;
+                }
+                return false;
+            }
+        };
+    }
+
+    /**
+     * Wraps each X509TrustManager of the given array so that its validations go through this cache.
+     */
+    TrustManager[] wrap(TrustManager[] trustManagers)
+    {
+        TrustManager[] wrapped = new TrustManager[trustManagers.length];
+        for (int i = 0; i < trustManagers.length; i++)
+        {
+            if (trustManagers[i] instanceof X509TrustManager)
+            {
+                wrapped[i] = new CachingX509TrustManager((X509TrustManager) trustManagers[i], this);
+            }
+            else
+            {
+                wrapped[i] = trustManagers[i];
+            }
+        }
+        return wrapped;
+    }
+
+    /**
+     * @return the key the validation of the given chain by the given trust manager is remembered
+     * under, or null if the chain cannot be fingerprinted and so should not be cached. A chain
+     * accepted by one trust manager is never taken as trusted by another, which may not trust
+     * the same CAs.
+     */
+    Key keyFor(X509TrustManager trustManager, X509Certificate[] chain, String authType, boolean client)
+    {
+        if (chain == null || chain.length == 0)
+        {
+            return null;
+        }
+
+        try
+        {
+            MessageDigest digest = MessageDigest.getInstance(FINGERPRINT_ALGORITHM);
+            for (X509Certificate certificate : chain)
+            {
+                digest.update(certificate.getEncoded());
+            }
+            return new Key(trustManager, digest.digest(), authType, client);
+        }
+        catch (NoSuchAlgorithmException | CertificateEncodingException e)
+        {
+            return null;
+        }
+    }
+
+    /**
+     * @return true if the chain with the given key passed validation recently enough to be trusted again.
+     */
+    boolean isValidated(Key key)
+    {
+        synchronized (_entries)
+        {
+            Entry entry = _entries.get(key);
+            if (entry != null)
+            {
+                if (entry._expiresAt > currentTimeMillis())
+                {
+                    _hits.incrementAndGet();
+                    return true;
+                }
+                _entries.remove(key);
+            }
+        }
+
+        _misses.incrementAndGet();
+        return false;
+    }
+
+    /**
+     * Remembers that the given chain passed validation.
+     */
+    void validated(Key key, X509Certificate[] chain)
+    {
+        long expiresAt = currentTimeMillis() + _timeToLiveMillis;
+        byte[][] fingerprints = new byte[chain.length][];
+        X500Principal[] issuers = new X500Principal[chain.length];
+        BigInteger[] serialNumbers = new BigInteger[chain.length];
+
+        try
+        {
+            for (int i = 0; i < chain.length; i++)
+            {
+                expiresAt = Math.min(expiresAt, chain[i].getNotAfter().getTime());
+                fingerprints[i] = fingerprint(chain[i]);
+                issuers[i] = chain[i].getIssuerX500Principal();
+                serialNumbers[i] = chain[i].getSerialNumber();
+            }
+        }
+        catch (NoSuchAlgorithmException | CertificateEncodingException e)
+        {
+            return;
+        }
+
+        synchronized (_entries)
+        {
+            _entries.put(key, new Entry(expiresAt, fingerprints, issuers, serialNumbers));
+        }
+    }
+
+    long currentTimeMillis()
+    {
+        return System.currentTimeMillis();
+    }
+
+    @Override
+    public void invalidate(X509Certificate certificate)
+    {
+        byte[] fingerprint;
+        try
+        {
+            fingerprint = fingerprint(certificate);
+        }
+        catch (NoSuchAlgorithmException | CertificateEncodingException e)
+        {
+            // Nothing could have been cached for a certificate that cannot be fingerprinted
+            return;
+        }
+
+        synchronized (_entries)
+        {
+            Iterator<Entry> entries = _entries.values().iterator();
+            while (entries.hasNext())
+            {
+                Entry entry = entries.next();
+                for (byte[] chainFingerprint : entry._fingerprints)
+                {
+                    if (Arrays.equals(fingerprint, chainFingerprint))
+                    {
+                        entries.remove();
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    @Override
+    public void invalidate(X509CRL crl)
+    {
+        synchronized (_entries)
+        {
+            Iterator<Entry> entries = _entries.values().iterator();
+            while (entries.hasNext())
+            {
+                Entry entry = entries.next();
+                for (int i = 0; i < entry._issuers.length; i++)
+                {
+                    if (crl.getIssuerX500Principal().equals(entry._issuers[i])
+                        && crl.getRevokedCertificate(entry._serialNumbers[i]) != null)
+                    {
+                        entries.remove();
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    @Override
+    public void invalidateAll()
+    {
+        synchronized (_entries)
+        {
+            _entries.clear();
+        }
+    }
+
+    @Override
+    public int size()
+    {
+        synchronized (_entries)
+        {
+            return _entries.size();
+        }
+    }
+
+    @Override
+    public long getHits()
+    {
+        return _hits.get();
+    }
+
+    @Override
+    public long getMisses()
+    {
+        return _misses.get();
+    }
+
+    @Override
+    public long getEvictions()
+    {
+        return _evictions.get();
+    }
+
+    @Override
+    public String toString()
+    {
+        return "SslPeerValidationCacheImpl [size=" + size() + ", hits=" + getHits()
+            + ", misses=" + getMisses() + ", evictions=" + getEvictions() + "]";
+    }
+
+    private static byte[] fingerprint(X509Certificate certificate)
+        throws NoSuchAlgorithmException, CertificateEncodingException
+    {
+        return MessageDigest.getInstance(FINGERPRINT_ALGORITHM).digest(certificate.getEncoded());
+    }
+
+    static final class Key
+    {
+        private final X509TrustManager _trustManager;
+        private final byte[] _fingerprint;
+        private final String _authType;
+        private final boolean _client;
+        private final int _hashCode;
+
+        private Key(X509TrustManager trustManager, byte[] fingerprint, String authType, boolean client)
+        {
+            _trustManager = trustManager;
+            _fingerprint = fingerprint;
+            _authType = authType;
+            _client = client;
+
+            int hashCode = System.identityHashCode(trustManager);
+            hashCode = 31 * hashCode + Arrays.hashCode(fingerprint);
+            hashCode = 31 * hashCode + (authType == null ? 0 : authType.hashCode());
+            _hashCode = 31 * hashCode + (client ? 1 : 0);
+        }
+
+        @Override
+        public int hashCode()
+        {
+            return _hashCode;
+        }
+
+        @Override
+        public boolean equals(Object obj)
+        {
+            if (this == obj)
+            {
+                return true;
+            }
+            if (!(obj instanceof Key))
+            {
+                return false;
+            }
+
+            Key other = (Key) obj;
+            return _trustManager == other._trustManager
+                && _client == other._client
+                && Arrays.equals(_fingerprint, other._fingerprint)
+                && (_authType == null ? other._authType == null : _authType.equals(other._authType));
+        }
+    }
+
+    private static final class Entry
+    {
+        private final long _expiresAt;
+        private final byte[][] _fingerprints;
+        private final X500Principal[] _issuers;
+        private final BigInteger[] _serialNumbers;
+
+        private Entry(long expiresAt, byte[][] fingerprints, X500Principal[] issuers, BigInteger[] serialNumbers)
+        {
+            _expiresAt = expiresAt;
+            _fingerprints = fingerprints;
+            _issuers = issuers;
+            _serialNumbers = serialNumbers;
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine.impl.ssl;
+
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.Locale;
+import java.util.Map;
+
+import javax.net.ssl.SSLContext;
+
+import org.apache.qpid.proton.engine.SslServerNameMapping;
+
+public class SslServerNameMappingImpl implements SslServerNameMapping
+{
+    private static final String WILDCARD_PREFIX = "*.";
+
+    // Replaced rather than modified so handshakes can read it without locking
+    private volatile Map<String, SSLContext> _contexts = Collections.emptyMap();
+
+    /**
+     * Application code should use {@link org.apache.qpid.proton.engine.SslServerNameMapping.Factory#create()} instead.
+     */
+    public SslServerNameMappingImpl()
+    {
+    }
+
+    @Override
+    public synchronized void setContext(String hostname, SSLContext context)
+    {
+        Map<String, SSLContext> contexts = new HashMap<String, SSLContext>(_contexts);
+        if (context == null)
+        {
+            contexts.remove(normalise(hostname));
+        }
+        else
+        {
+            contexts.put(normalise(hostname), context);
+        }
+        _contexts = contexts;
+    }
+
+    @Override
+    public synchronized void setContexts(Map<String, SSLContext> contexts)
+    {
+        Map<String, SSLContext> replacement = new HashMap<String, SSLContext>();
+        for (Map.Entry<String, SSLContext> entry : contexts.entrySet())
+        {
+            if (entry.getValue() != null)
+            {
+                replacement.put(normalise(entry.getKey()), entry.getValue());
+            }
+        }
+        _contexts = replacement;
+    }
+
+    @Override
+    public SSLContext getContext(String serverName)
+    {
+        if (serverName == null)
+        {
+            return null;
+        }
+
+        Map<String, SSLContext> contexts = _contexts;
+        String name = normalise(serverName);
+        SSLContext context = contexts.get(name);
+        if (context == null)
+        {
+            int dot = name.indexOf('.');
+            if (dot > 0)
+            {
+                context = contexts.get(WILDCARD_PREFIX + name.substring(dot + 1));
+            }
+        }
+        return context;
+    }
+
+    private static String normalise(String hostname)
+    {
+        if (hostname == null)
+        {
+            throw new IllegalArgumentException("hostname must not be null");
+        }
+
+        String name = hostname.toLowerCase(Locale.ROOT);
+        return name.endsWith(".") ? name.substring(0, name.length() - 1) : name;
+    }
+
+    @Override
+    public String toString()
+    {
+        return "SslServerNameMappingImpl " + _contexts.keySet();
+    }
+}
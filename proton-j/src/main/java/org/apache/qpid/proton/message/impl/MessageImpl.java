@@ -22,7 +22,9 @@
 package org.apache.qpid.proton.message.impl;
 
 import java.nio.ByteBuffer;
+import java.util.ArrayList;
 import java.util.Date;
+import java.util.List;
 import org.apache.qpid.proton.amqp.Binary;
 import org.apache.qpid.proton.amqp.Symbol;
 import org.apache.qpid.proton.amqp.UnsignedByte;
@@ -33,6 +35,15 @@ import org.apache.qpid.proton.message.*;
 
 public class MessageImpl implements ProtonJMessage
 {
+    /**
+     * The message format of a delivery carrying a batch of messages, each encoded in its own
+     * {@link Data} section, as written by {@link #encodeBatch(Iterable, WritableBuffer)}.  This
+     * is the batch format already used by other AMQP implementations.
+     */
+    public static final int BATCH_MESSAGE_FORMAT = 0x80013700;
+
+    private static final byte DATA_DESCRIPTOR_CODE = (byte) 0x75;
+
     private Header _header;
     private DeliveryAnnotations _deliveryAnnotations;
     private MessageAnnotations _messageAnnotations;
@@ -45,7 +56,7 @@ public class MessageImpl implements ProtonJMessage
       DecoderImpl decoder = new DecoderImpl();
       EncoderImpl encoder = new EncoderImpl(decoder);
       {
-          AMQPDefinedTypes.registerAllTypes(decoder, encoder);
+          AMQPDefinedTypes.registerAllTypesLazily(decoder, encoder);
       }
     }
 
@@ -748,6 +759,127 @@ public class MessageImpl implements ProtonJMessage
         return length - buffer.remaining();
     }
 
+    /**
+     * Encodes the given messages one after another, each as a {@link Data} section holding the
+     * encoded message, so that they can be sent as a single delivery with the message format
+     * {@link #BATCH_MESSAGE_FORMAT}.
+     *
+     * @param messages the messages to encode.
+     * @param buffer the buffer to encode into.
+     *
+     * @return the number of bytes written.
+     */
+    public static int encodeBatch(Iterable<? extends Message> messages, WritableBuffer buffer)
+    {
+        int start = buffer.position();
+
+        for (Message message : messages)
+        {
+            buffer.put(EncodingCodes.DESCRIBED_TYPE_INDICATOR);
+            buffer.put(EncodingCodes.SMALLULONG);
+            buffer.put(DATA_DESCRIPTOR_CODE);
+            buffer.put(EncodingCodes.VBIN32);
+
+            // Reserve space for the size, encode the message in place and then write its size
+            int sizeIndex = buffer.position();
+            buffer.putInt(0);
+
+            int size = message.encode(buffer);
+
+            int endIndex = buffer.position();
+            buffer.position(sizeIndex);
+            buffer.putInt(size);
+            buffer.position(endIndex);
+        }
+
+        return buffer.position() - start;
+    }
+
+    public static int encodeBatch(Iterable<? extends Message> messages, byte[] data, int offset, int length)
+    {
+        ByteBuffer buffer = ByteBuffer.wrap(data, offset, length);
+        return encodeBatch(messages, new WritableBuffer.ByteBufferWrapper(buffer));
+    }
+
+    /**
+     * Decodes the messages of a delivery with the message format {@link #BATCH_MESSAGE_FORMAT},
+     * consuming the whole of the given buffer.
+     *
+     * @param buffer the buffer holding the batch.
+     *
+     * @return the messages in the batch, in the order they were encoded.
+     */
+    public static List<Message> decodeBatch(ReadableBuffer buffer)
+    {
+        List<Message> messages = new ArrayList<Message>();
+
+        while (buffer.hasRemaining())
+        {
+            MessageImpl message = new MessageImpl();
+            message.decode(readBatchSection(buffer));
+            messages.add(message);
+        }
+
+        return messages;
+    }
+
+    public static List<Message> decodeBatch(byte[] data, int offset, int length)
+    {
+        return decodeBatch(ReadableBuffer.ByteBufferReader.wrap(ByteBuffer.wrap(data, offset, length)));
+    }
+
+    /**
+     * Reads the next Data section of a batch, returning a view of its contents where it has the
+     * form written by {@link #encodeBatch(Iterable, WritableBuffer)} and otherwise falling back to
+     * the decoder.
+     */
+    private static ReadableBuffer readBatchSection(ReadableBuffer buffer)
+    {
+        int start = buffer.position();
+
+        if (buffer.remaining() > 4 &&
+            buffer.get(start) == EncodingCodes.DESCRIBED_TYPE_INDICATOR &&
+            buffer.get(start + 1) == EncodingCodes.SMALLULONG &&
+            buffer.get(start + 2) == DATA_DESCRIPTOR_CODE)
+        {
+            byte encodingCode = buffer.get(start + 3);
+            if (encodingCode == EncodingCodes.VBIN8 || encodingCode == EncodingCodes.VBIN32)
+            {
+                buffer.position(start + 4);
+                int size = encodingCode == EncodingCodes.VBIN8 ? buffer.get() & 0xff : buffer.getInt();
+                if (size < 0 || size > buffer.remaining())
+                {
+                    throw new DecodeException("Batch section size " + size + " exceeds the remaining " + buffer.remaining() + " bytes");
+                }
+
+                ReadableBuffer section = buffer.slice();
+                section.limit(size);
+                buffer.position(buffer.position() + size);
+                return section;
+            }
+        }
+
+        DecoderImpl decoder = tlsCodec.get().decoder;
+        decoder.setBuffer(buffer);
+        Object section;
+        try
+        {
+            section = decoder.readObject();
+        }
+        finally
+        {
+            decoder.setBuffer(null);
+        }
+
+        if (!(section instanceof Data))
+        {
+            throw new DecodeException("Batch contains a section that is not Data: " + section);
+        }
+
+        Binary value = ((Data) section).getValue();
+        return ReadableBuffer.ByteBufferReader.wrap(value.asByteBuffer());
+    }
+
     @Override
     public void clear()
     {
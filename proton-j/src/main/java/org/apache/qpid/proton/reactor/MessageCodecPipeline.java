@@ -0,0 +1,354 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+package org.apache.qpid.proton.reactor;
+
+import java.nio.ByteBuffer;
+import java.util.ArrayDeque;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.Executor;
+
+import org.apache.qpid.proton.codec.CompositeWritableBuffer;
+import org.apache.qpid.proton.codec.DroppingWritableBuffer;
+import org.apache.qpid.proton.codec.ReadableBuffer;
+import org.apache.qpid.proton.codec.WritableBuffer;
+import org.apache.qpid.proton.engine.BaseHandler;
+import org.apache.qpid.proton.engine.Delivery;
+import org.apache.qpid.proton.engine.Event;
+import org.apache.qpid.proton.engine.Link;
+import org.apache.qpid.proton.engine.Receiver;
+import org.apache.qpid.proton.engine.Sender;
+import org.apache.qpid.proton.message.Message;
+
+/**
+ * A handler that moves message decoding and encoding off the thread processing
+ * the engine, so that message (de)serialisation can use several cores while the
+ * engine itself stays single threaded.
+ * <p>
+ * Complete deliveries seen on {@link Receiver} links are taken from the link and
+ * decoded using the given {@link Executor}, the resulting messages are then passed
+ * to {@link #onMessage(Receiver, Delivery, Message)}. Messages passed to
+ * {@link #send(Sender, byte[], Message)}, which may be called from any thread, are
+ * encoded by the executor and then sent on the link.
+ * <p>
+ * Deliveries on {@link Sender} links, such as those the peer has settled, are
+ * passed to {@link #onSenderDelivery(Sender, Delivery)}.
+ * <p>
+ * Results for a link are handed back in the order the deliveries arrived or the
+ * sends were requested, and only ever on the thread processing events: either as
+ * this handler sees events, or when {@link #dispatchCompleted()} is called by an
+ * application driving the engine itself. If a {@link Reactor} is supplied it is
+ * woken up as work completes, and a handler added to the reactor's own handler
+ * dispatches the results each time it is woken, so the last results of a burst
+ * are not left waiting for another event to reach this handler. That handler is
+ * lost if the reactor's handler is later replaced with
+ * {@link Reactor#setHandler(org.apache.qpid.proton.engine.Handler)}.
+ * <p>
+ * Work still outstanding for a link when it is finalised is discarded.
+ */
+public abstract class MessageCodecPipeline extends BaseHandler {
+
+    private static final int DEFAULT_ENCODE_BUFFER_SIZE = 1024;
+
+    private final Executor executor;
+    private final Reactor reactor;
+    private final ConcurrentHashMap<Link, LinkQueue> queues = new ConcurrentHashMap<Link, LinkQueue>();
+    private final ConcurrentLinkedQueue<LinkQueue> completed = new ConcurrentLinkedQueue<LinkQueue>();
+
+    private int encodeBufferSize = DEFAULT_ENCODE_BUFFER_SIZE;
+
+    /**
+     * When a reactor is given, the pipeline must be created before the reactor is
+     * run or on the thread running it.
+     *
+     * @param executor the executor used to decode and encode messages.
+     * @param reactor the reactor to wake as work completes, or <code>null</code>
+     *        if {@link #dispatchCompleted()} is called by the application.
+     */
+    public MessageCodecPipeline(Executor executor, Reactor reactor) {
+        if (executor == null) throw new IllegalArgumentException("An executor must be provided");
+        this.executor = executor;
+        this.reactor = reactor;
+
+        if (reactor != null) {
+            // A wakeup dispatches no event to connection or link handlers, but the
+            // reactor's handler sees it quiesce again once woken
+            reactor.getHandler().add(new BaseHandler() {
+                @Override
+                public void onReactorQuiesced(Event event) {
+                    dispatchCompleted();
+                }
+            });
+        }
+    }
+
+    public MessageCodecPipeline(Executor executor) {
+        this(executor, null);
+    }
+
+    /**
+     * Sets the size of the buffer first tried when encoding a message, larger
+     * messages are encoded a second time into a buffer of the exact size.
+     *
+     * @param encodeBufferSize the initial encode buffer size in bytes.
+     */
+    public void setEncodeBufferSize(int encodeBufferSize) {
+        if (encodeBufferSize <= 0) throw new IllegalArgumentException("Buffer size must be positive");
+        this.encodeBufferSize = encodeBufferSize;
+    }
+
+    public int getEncodeBufferSize() {
+        return encodeBufferSize;
+    }
+
+    /**
+     * Called on the event processing thread with each decoded message, in the
+     * order the deliveries arrived on the link.  The delivery has already been
+     * advanced past, it is left to the application to settle it.
+     */
+    protected abstract void onMessage(Receiver receiver, Delivery delivery, Message message);
+
+    /**
+     * Called on the event processing thread once an encoded message has been
+     * sent on the link as the given delivery.
+     */
+    protected void onMessageSent(Sender sender, Delivery delivery, Message message) {
+    }
+
+    /**
+     * Called on the event processing thread with each delivery event seen on a
+     * sender link, for instance once the peer has settled a delivery.  Nothing is
+     * done by default.
+     */
+    protected void onSenderDelivery(Sender sender, Delivery delivery) {
+    }
+
+    /**
+     * Called on the event processing thread when a message could not be decoded
+     * or encoded.  The delivery is <code>null</code> for a failed encode.  By
+     * default the failure is rethrown.
+     */
+    protected void onCodecFailure(Link link, Delivery delivery, Message message, RuntimeException failure) {
+        throw failure;
+    }
+
+    /**
+     * Encodes the given message on the executor and then sends it on the sender
+     * as a new delivery with the given tag.  This method may be called from any
+     * thread, the delivery itself is created on the event processing thread.
+     */
+    public void send(Sender sender, byte[] tag, Message message) {
+        submit(sender, new EncodeJob(sender, tag, message, encodeBufferSize));
+    }
+
+    /**
+     * Hands completed work back to the application, stopping for each link at the
+     * first piece of work that is still in progress so that ordering is preserved.
+     * Must be called on the thread processing events for the connections involved.
+     */
+    public void dispatchCompleted() {
+        LinkQueue queue;
+        while ((queue = completed.poll()) != null) {
+            Job job;
+            while ((job = queue.pollDone()) != null) {
+                job.complete();
+            }
+        }
+    }
+
+    @Override
+    public void onDelivery(Event event) {
+        Delivery delivery = event.getDelivery();
+        Link link = delivery.getLink();
+
+        if (link instanceof Receiver && delivery.isReadable() && !delivery.isPartial() && !delivery.isAborted()) {
+            Receiver receiver = (Receiver) link;
+            ReadableBuffer payload = receiver.recv();
+            receiver.advance();
+            submit(receiver, new DecodeJob(receiver, delivery, payload));
+        } else if (link instanceof Sender) {
+            onSenderDelivery((Sender) link, delivery);
+        }
+
+        dispatchCompleted();
+    }
+
+    @Override
+    public void onLinkFinal(Event event) {
+        LinkQueue queue = queues.remove(event.getLink());
+        if (queue != null) {
+            queue.close();
+        }
+
+        dispatchCompleted();
+    }
+
+    @Override
+    public void onUnhandled(Event event) {
+        dispatchCompleted();
+    }
+
+    private void submit(Link link, Job job) {
+        LinkQueue queue = queues.get(link);
+        if (queue == null) {
+            LinkQueue created = new LinkQueue();
+            queue = queues.putIfAbsent(link, created);
+            if (queue == null) {
+                queue = created;
+            }
+        }
+
+        job.queue = queue;
+        queue.add(job);
+        executor.execute(job);
+    }
+
+    private static final class LinkQueue {
+
+        private final ArrayDeque<Job> jobs = new ArrayDeque<Job>();
+        private boolean closed;
+
+        synchronized void add(Job job) {
+            if (!closed) {
+                jobs.add(job);
+            }
+        }
+
+        synchronized Job pollDone() {
+            Job head = jobs.peek();
+            if (head != null && head.done) {
+                return jobs.poll();
+            }
+
+            return null;
+        }
+
+        synchronized void close() {
+            closed = true;
+            jobs.clear();
+        }
+    }
+
+    private abstract class Job implements Runnable {
+
+        LinkQueue queue;
+        RuntimeException failure;
+        volatile boolean done;
+
+        @Override
+        public final void run() {
+            try {
+                process();
+            } catch (RuntimeException e) {
+                failure = e;
+            }
+
+            done = true;
+            completed.add(queue);
+
+            if (reactor != null) {
+                reactor.wakeup();
+            }
+        }
+
+        abstract void process();
+
+        abstract void complete();
+    }
+
+    private final class DecodeJob extends Job {
+
+        private final Receiver receiver;
+        private final Delivery delivery;
+        private final ReadableBuffer payload;
+        private Message message;
+
+        DecodeJob(Receiver receiver, Delivery delivery, ReadableBuffer payload) {
+            this.receiver = receiver;
+            this.delivery = delivery;
+            this.payload = payload;
+        }
+
+        @Override
+        void process() {
+            message = Message.Factory.create();
+            message.decode(payload);
+        }
+
+        @Override
+        void complete() {
+            if (failure == null) {
+                onMessage(receiver, delivery, message);
+            } else {
+                onCodecFailure(receiver, delivery, message, failure);
+            }
+        }
+    }
+
+    private final class EncodeJob extends Job {
+
+        private final Sender sender;
+        private final byte[] tag;
+        private final Message message;
+        private final int bufferSize;
+        private byte[] encoded;
+        private int length;
+
+        EncodeJob(Sender sender, byte[] tag, Message message, int bufferSize) {
+            this.sender = sender;
+            this.tag = tag;
+            this.message = message;
+            this.bufferSize = bufferSize;
+        }
+
+        @Override
+        void process() {
+            encoded = new byte[bufferSize];
+            length = encode(encoded);
+
+            if (length > encoded.length) {
+                encoded = new byte[length];
+                length = encode(encoded);
+            }
+        }
+
+        private int encode(byte[] target) {
+            WritableBuffer.ByteBufferWrapper first = new WritableBuffer.ByteBufferWrapper(ByteBuffer.wrap(target));
+            CompositeWritableBuffer composite = new CompositeWritableBuffer(first, new DroppingWritableBuffer());
+            int start = composite.position();
+            message.encode(composite);
+            return composite.position() - start;
+        }
+
+        @Override
+        void complete() {
+            if (failure == null) {
+                Delivery delivery = sender.delivery(tag);
+                sender.sendNoCopy(ReadableBuffer.ByteBufferReader.wrap(ByteBuffer.wrap(encoded, 0, length)));
+                sender.advance();
+                onMessageSent(sender, delivery, message);
+            } else {
+                onCodecFailure(sender, null, message, failure);
+            }
+        }
+    }
+}
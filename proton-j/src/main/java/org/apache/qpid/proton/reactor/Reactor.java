@@ -303,6 +303,29 @@ public interface Reactor {
      */
     String getConnectionAddress(Connection c);
 
+    /**
+     * Sets the output of the connection to be coalesced.
+     * <p>
+     * By default whatever the connection has to write is written as soon as
+     * its socket is writable, so a handler sending a small message on each
+     * event makes a write call, and usually sends a TCP segment, per message.
+     * With coalescing, output is held back until the given number of bytes
+     * is pending, or until some output has been pending for the given delay,
+     * whichever comes first, so that a burst of small messages is written in
+     * fewer, larger writes at the cost of up to that delay in latency.
+     * <p>
+     * The delay is measured with the reactor's timer, and so is in
+     * milliseconds.  This may be set at any time, typically when handling
+     * the {@link Type#CONNECTION_INIT} event.
+     * @param c the Connection whose output is to be coalesced
+     * @param bytes the number of pending bytes that are written at once.
+     * @param delay the number of milliseconds output may be held back for,
+     *              or 0 to write output as soon as possible, as by default.
+     * @throws IllegalArgumentException if bytes is less than 1 or delay is
+     *         negative.
+     */
+    void setConnectionOutputCoalescing(Connection c, int bytes, int delay);
+
     /**
      * Creates a new acceptor.  This is equivalent to calling:
      * <pre>
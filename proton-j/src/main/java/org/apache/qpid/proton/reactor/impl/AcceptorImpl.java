@@ -73,6 +73,7 @@ public class AcceptorImpl implements Acceptor {
                     conn_recs.set(ReactorImpl.CONNECTION_PEER_ADDRESS_KEY, Address.class, addr);
                 }
                 Transport trans = Proton.transport();
+                trans.socketConnected();
 
                 int maxFrameSizeOption = reactor.getOptions().getMaxFrameSize();
                 if (maxFrameSizeOption != 0) {
@@ -160,7 +160,9 @@ public class IOHandler extends BaseHandler {
         try {
             SocketChannel socketChannel = ((ReactorImpl)reactor).getIO().socketChannel();
             socketChannel.configureBlocking(false);
-            socketChannel.connect(new InetSocketAddress(hostname, port));
+            if (socketChannel.connect(new InetSocketAddress(hostname, port))) {
+                transport.socketConnected();
+            }
             socket = socketChannel.socket();
         } catch(Exception exception) {
             ErrorCondition condition = new ErrorCondition();
@@ -206,16 +208,40 @@ public class IOHandler extends BaseHandler {
         return deadline;
     }
 
+    // Whether to write the pending output now, or leave it for the
+    // connection's output coalescer, if any, to write later
+    private static boolean writing(Selectable selectable, int pending) {
+        OutputCoalescer coalescer = ((SelectableImpl)selectable).getOutputCoalescer();
+        if (coalescer == null) {
+            return pending > 0;
+        }
+        return coalescer.isWriting(selectable, pending);
+    }
+
     // pni_connection_update from connection.c
-    private static void update(Selectable selectable) {
+    static void update(Selectable selectable) {
         SelectableImpl selectableImpl = (SelectableImpl)selectable;
         int c = capacity(selectableImpl);
         int p = pending(selectableImpl);
         selectable.setReading(c > 0);
-        selectable.setWriting(p > 0);
+        selectable.setWriting(writing(selectable, p));
         selectable.setDeadline(deadline(selectableImpl));
     }
 
+    static void setOutputCoalescer(Selectable selectable, OutputCoalescer coalescer) {
+        SelectableImpl selectableImpl = (SelectableImpl)selectable;
+        OutputCoalescer previous = selectableImpl.getOutputCoalescer();
+        if (previous == coalescer) {
+            return;
+        }
+        if (previous != null) {
+            previous.cancel();
+        }
+        selectableImpl.setOutputCoalescer(coalescer);
+        update(selectable);
+        selectable.getReactor().update(selectable);
+    }
+
     // pni_connection_readable from connection.c
     private static Callback connectionReadable = new Callback() {
         @Override
@@ -302,7 +328,7 @@ public class IOHandler extends BaseHandler {
             int c = capacity(selectable);
             int p = pending(selectable);
             selectable.setReading(c > 0);
-            selectable.setWriting(p > 0);
+            selectable.setWriting(writing(selectable, p));
             reactor.update(selectable);
         }
     };
@@ -310,6 +336,10 @@ public class IOHandler extends BaseHandler {
     private static Callback connectionFree = new Callback() {
         @Override
         public void run(Selectable selectable) {
+            OutputCoalescer coalescer = ((SelectableImpl)selectable).getOutputCoalescer();
+            if (coalescer != null) {
+                coalescer.cancel();
+            }
             Channel channel = selectable.getChannel();
             if (channel != null) {
                 try {
@@ -339,6 +369,20 @@ public class IOHandler extends BaseHandler {
         return selectable;
     }
 
+    // Applies the output coalescing set on the connection, if any, now that
+    // it has a selectable
+    private void handleCoalescing(Event event) {
+        Connection connection = event.getConnection();
+        OutputCoalescer coalescer = connection.attachments().get(ReactorImpl.CONNECTION_OUTPUT_COALESCER_KEY, OutputCoalescer.class);
+        TransportImpl transport = (TransportImpl)connection.getTransport();
+        if (coalescer != null && transport != null) {
+            Selectable selectable = transport.getSelectable();
+            if (selectable != null && !selectable.isTerminal()) {
+                setOutputCoalescer(selectable, coalescer);
+            }
+        }
+    }
+
     private void handleTransport(Reactor reactor, Event event) {
         TransportImpl transport = (TransportImpl)event.getTransport();
         Selectable selectable = transport.getSelectable();
@@ -378,6 +422,7 @@ public class IOHandler extends BaseHandler {
                 break;
             case CONNECTION_BOUND:
                 handleBound(reactor, event);
+                handleCoalescing(event);
                 break;
             case TRANSPORT:
                 handleTransport(reactor, event);
@@ -0,0 +1,116 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+package org.apache.qpid.proton.reactor.impl;
+
+import org.apache.qpid.proton.engine.BaseHandler;
+import org.apache.qpid.proton.engine.Event;
+import org.apache.qpid.proton.reactor.Selectable;
+import org.apache.qpid.proton.reactor.Task;
+
+/**
+ * Holds back the output of a connection until either enough of it is pending
+ * or it has been pending for long enough, so that a burst of small frames
+ * is written with one call rather than one call per frame.
+ *
+ * @see org.apache.qpid.proton.reactor.Reactor#setConnectionOutputCoalescing
+ */
+class OutputCoalescer extends BaseHandler {
+
+    private final int bytes;
+    private final int delay;
+    private Selectable selectable;
+    private Task flushTask;
+    private boolean flushing;
+
+    // How often held output has been let through, how often that was by
+    // the timer, and the longest the timer held any back, in milliseconds
+    private int flushes;
+    private int timerFlushes;
+    private long heldSince;
+    private long maxHeld;
+
+    OutputCoalescer(int bytes, int delay) {
+        this.bytes = bytes;
+        this.delay = delay;
+    }
+
+    // Whether the selectable should be writing with the given number of
+    // bytes pending, starting the timer if the output is being held back
+    boolean isWriting(Selectable selectable, int pending) {
+        if (pending <= 0) {
+            flushing = false;
+            cancel();
+            return false;
+        }
+        if (flushing || pending >= bytes) {
+            // Keep writing until nothing is pending, rather than stopping
+            // again once what is left drops below the threshold
+            if (!flushing) {
+                flushing = true;
+                flushes++;
+            }
+            cancel();
+            return true;
+        }
+        if (flushTask == null) {
+            this.selectable = selectable;
+            heldSince = selectable.getReactor().now();
+            flushTask = selectable.getReactor().schedule(delay, this);
+        }
+        return false;
+    }
+
+    void cancel() {
+        if (flushTask != null) {
+            flushTask.cancel();
+            flushTask = null;
+        }
+    }
+
+    @Override
+    public void onTimerTask(Event event) {
+        if (event.getTask() != flushTask) {
+            return;
+        }
+        flushTask = null;
+        flushing = true;
+        flushes++;
+        timerFlushes++;
+        maxHeld = Math.max(maxHeld, selectable.getReactor().now() - heldSince);
+        if (!selectable.isTerminal()) {
+            IOHandler.update(selectable);
+            selectable.getReactor().update(selectable);
+        }
+    }
+
+    int getFlushes() {
+        return flushes;
+    }
+
+    int getTimerFlushes() {
+        return timerFlushes;
+    }
+
+    long getMaxHeld() {
+        return maxHeld;
+    }
+}
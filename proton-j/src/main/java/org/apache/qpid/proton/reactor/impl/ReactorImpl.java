@@ -40,9 +40,11 @@ import org.apache.qpid.proton.engine.ExtendableAccessor;
 import org.apache.qpid.proton.engine.Handler;
 import org.apache.qpid.proton.engine.HandlerException;
 import org.apache.qpid.proton.engine.Record;
+import org.apache.qpid.proton.engine.Transport;
 import org.apache.qpid.proton.engine.impl.CollectorImpl;
 import org.apache.qpid.proton.engine.impl.ConnectionImpl;
 import org.apache.qpid.proton.engine.impl.RecordImpl;
+import org.apache.qpid.proton.engine.impl.TransportImpl;
 import org.apache.qpid.proton.reactor.Acceptor;
 import org.apache.qpid.proton.reactor.impl.AcceptorImpl;
 import org.apache.qpid.proton.reactor.Reactor;
@@ -74,6 +76,7 @@ public class ReactorImpl implements Reactor, Extendable {
     private final IO io;
     private final ReactorOptions options;
     protected static final String CONNECTION_PEER_ADDRESS_KEY = "pn_reactor_connection_peer_address";
+    protected static final String CONNECTION_OUTPUT_COALESCER_KEY = "pn_reactor_connection_output_coalescer";
 
     @Override
     public long mark() {
@@ -483,6 +486,25 @@ public class ReactorImpl implements Reactor, Extendable {
         }
     }
 
+    @Override
+    public void setConnectionOutputCoalescing(Connection connection,
+                                              int bytes, int delay) {
+        if (bytes < 1 || delay < 0) {
+            throw new IllegalArgumentException("Invalid output coalescing: " + bytes + " bytes, " + delay + " ms");
+        }
+        OutputCoalescer coalescer = delay > 0 ? new OutputCoalescer(bytes, delay) : null;
+        connection.attachments().set(CONNECTION_OUTPUT_COALESCER_KEY, OutputCoalescer.class, coalescer);
+
+        // Otherwise applied once the connection is bound to a transport
+        Transport transport = connection.getTransport();
+        if (transport != null) {
+            Selectable selectable = ((TransportImpl)transport).getSelectable();
+            if (selectable != null && !selectable.isTerminal()) {
+                IOHandler.setOutputCoalescer(selectable, coalescer);
+            }
+        }
+    }
+
     @Override
     public Acceptor acceptor(String host, int port) throws IOException {
         return this.acceptor(host, port, null);
@@ -49,6 +49,7 @@ public class SelectableImpl implements Selectable {
     private boolean registered;
     private Reactor reactor;
     private Transport transport;
+    private OutputCoalescer outputCoalescer;
     private boolean terminal;
     private boolean terminated;
 
@@ -227,6 +228,14 @@ public class SelectableImpl implements Selectable {
         this.transport = transport;
     }
 
+    protected OutputCoalescer getOutputCoalescer() {
+        return outputCoalescer;
+    }
+
+    protected void setOutputCoalescer(OutputCoalescer outputCoalescer) {
+        this.outputCoalescer = outputCoalescer;
+    }
+
     protected void setReactor(Reactor reactor) {
         this.reactor = reactor;
     }
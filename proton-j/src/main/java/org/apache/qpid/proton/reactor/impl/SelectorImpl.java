@@ -130,7 +130,12 @@ class SelectorImpl implements Selector {
                     SelectionKey key = iterator.next();
                     if (key.isConnectable()) {
                         try {
-                            ((SocketChannel)key.channel()).finishConnect();
+                            if (((SocketChannel)key.channel()).finishConnect()) {
+                                Transport transport = ((SelectableImpl)key.attachment()).getTransport();
+                                if (transport != null) {
+                                    transport.socketConnected();
+                                }
+                            }
                             update((Selectable)key.attachment());
                         } catch(IOException ioException) {
                             SelectableImpl selectable = (SelectableImpl)key.attachment();
@@ -0,0 +1,119 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+package org.apache.qpid.proton.amqp;
+
+import static org.junit.Assert.*;
+
+import java.nio.ByteBuffer;
+import java.util.HashMap;
+import java.util.Map;
+
+import org.apache.qpid.proton.codec.AMQPDefinedTypes;
+import org.apache.qpid.proton.codec.DecoderImpl;
+import org.apache.qpid.proton.codec.EncoderImpl;
+import org.junit.Test;
+
+public class SymbolTest
+{
+    @Test
+    public void testGetSymbolReturnsRetainedInstance()
+    {
+        Symbol symbol = Symbol.getSymbol("symbol-test-retained");
+
+        assertSame(symbol, Symbol.getSymbol("symbol-test-retained"));
+        assertSame(symbol, Symbol.valueOf("symbol-test-retained"));
+    }
+
+    @Test
+    public void testLookupReturnsRetainedInstanceWhenKnown()
+    {
+        Symbol symbol = Symbol.getSymbol("symbol-test-known");
+
+        assertSame(symbol, Symbol.lookup("symbol-test-known"));
+    }
+
+    @Test
+    public void testLookupDoesNotRetainUnknownSymbols()
+    {
+        Symbol first = Symbol.lookup("symbol-test-unknown");
+        Symbol second = Symbol.lookup("symbol-test-unknown");
+
+        assertNotSame(first, second);
+        assertEquals(first, second);
+        assertEquals(first.hashCode(), second.hashCode());
+
+        Symbol retained = Symbol.getSymbol("symbol-test-unknown");
+        assertNotSame(first, retained);
+        assertEquals(first, retained);
+        assertSame(retained, Symbol.lookup("symbol-test-unknown"));
+    }
+
+    @Test
+    public void testLookupOfNull()
+    {
+        assertNull(Symbol.lookup(null));
+        assertNull(Symbol.getSymbol(null));
+    }
+
+    @Test
+    public void testEquals()
+    {
+        Symbol symbol = Symbol.lookup("symbol-test-equals");
+
+        assertTrue(symbol.equals(symbol));
+        assertTrue(symbol.equals(Symbol.lookup("symbol-test-equals")));
+        assertFalse(symbol.equals(Symbol.lookup("symbol-test-other")));
+        assertFalse(symbol.equals("symbol-test-equals"));
+        assertFalse(symbol.equals(null));
+    }
+
+    @Test
+    public void testUnretainedSymbolsWorkAsMapKeys()
+    {
+        Map<Symbol, String> map = new HashMap<>();
+        map.put(Symbol.lookup("symbol-test-key"), "value");
+
+        assertEquals("value", map.get(Symbol.lookup("symbol-test-key")));
+        assertEquals("value", map.get(Symbol.getSymbol("symbol-test-key")));
+    }
+
+    @Test
+    public void testDecodedSymbolsAreOnlyRetainedIfKnown()
+    {
+        DecoderImpl decoder = new DecoderImpl();
+        EncoderImpl encoder = new EncoderImpl(decoder);
+        AMQPDefinedTypes.registerAllTypes(decoder, encoder);
+
+        ByteBuffer buffer = ByteBuffer.allocate(64);
+        encoder.setByteBuffer(buffer);
+        encoder.writeSymbol(Symbol.lookup("symbol-test-decoded"));
+        encoder.writeSymbol(Symbol.getSymbol("symbol-test-decoded-known"));
+        buffer.flip();
+
+        decoder.setByteBuffer(buffer);
+        Symbol decoded = decoder.readSymbol();
+        Symbol decodedKnown = decoder.readSymbol();
+
+        assertEquals(Symbol.lookup("symbol-test-decoded"), decoded);
+        assertNotSame(decoded, Symbol.getSymbol("symbol-test-decoded"));
+        assertSame(Symbol.getSymbol("symbol-test-decoded-known"), decodedKnown);
+    }
+}
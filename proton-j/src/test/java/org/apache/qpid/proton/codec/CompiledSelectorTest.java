@@ -0,0 +1,238 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.qpid.proton.codec;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assert.fail;
+
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+import org.apache.qpid.proton.amqp.Symbol;
+import org.apache.qpid.proton.amqp.UnknownDescribedType;
+import org.apache.qpid.proton.amqp.UnsignedByte;
+import org.apache.qpid.proton.amqp.UnsignedInteger;
+import org.apache.qpid.proton.amqp.UnsignedLong;
+import org.apache.qpid.proton.amqp.messaging.AmqpValue;
+import org.apache.qpid.proton.amqp.messaging.ApplicationProperties;
+import org.apache.qpid.proton.amqp.messaging.Header;
+import org.apache.qpid.proton.amqp.messaging.Properties;
+import org.apache.qpid.proton.codec.messaging.CompiledSelector;
+import org.apache.qpid.proton.message.Message;
+import org.apache.qpid.proton.message.impl.MessageImpl;
+import org.junit.Test;
+
+public class CompiledSelectorTest {
+
+    @Test
+    public void testStringComparisons() {
+        ReadableBuffer message = encode(properties("colour", "red", "shape", "square"));
+
+        assertMatches(true, "colour = 'red'", message);
+        assertMatches(false, "colour = 'blue'", message);
+        assertMatches(true, "colour <> 'blue'", message);
+        assertMatches(true, "colour IN ('blue', 'red')", message);
+        assertMatches(false, "colour NOT IN ('blue', 'red')", message);
+        assertMatches(true, "colour = 'red' AND shape = 'square'", message);
+        assertMatches(true, "colour = 'blue' OR (shape = 'square' AND NOT colour = 'green')", message);
+        assertMatches(true, "'red' = colour", message);
+    }
+
+    @Test
+    public void testNumericComparisonsAcrossEncodings() {
+        Object[] values = {
+            (byte) 42, (short) 42, 42, 42L, UnsignedByte.valueOf((byte) 42), UnsignedInteger.valueOf(42),
+            UnsignedLong.valueOf(42), 42.0f, 42.0d, 100000, 100000L, UnsignedInteger.valueOf(100000)
+        };
+
+        for (Object value : values) {
+            ReadableBuffer message = encode(properties("size", value));
+            boolean small = ((Number) value).longValue() == 42;
+
+            assertMatches(small, "size = 42", message);
+            assertMatches(small, "size BETWEEN 40 AND 50", message);
+            assertMatches(!small, "size NOT BETWEEN 40 AND 50", message);
+            assertMatches(true, "size > 41.5", message);
+            assertMatches(true, "size >= 42", message);
+            assertMatches(false, "size < -1", message);
+            assertMatches(!small, "100 < size", message);
+        }
+    }
+
+    @Test
+    public void testMissingAndMismatchedValuesAreUnknown() {
+        ReadableBuffer message = encode(properties("colour", "red", "size", 3, "nothing", null));
+
+        assertMatches(false, "missing = 'red'", message);
+        assertMatches(false, "NOT missing = 'red'", message);
+        assertMatches(false, "missing <> 'red'", message);
+        assertMatches(true, "missing IS NULL", message);
+        assertMatches(true, "nothing IS NULL", message);
+        assertMatches(true, "colour IS NOT NULL", message);
+        assertMatches(false, "colour = 3", message);
+        assertMatches(false, "NOT colour = 3", message);
+        assertMatches(false, "size = '3'", message);
+        assertMatches(true, "missing = 'red' OR colour = 'red'", message);
+        assertMatches(false, "missing = 'red' AND colour = 'red'", message);
+    }
+
+    @Test
+    public void testBooleanComparisons() {
+        ReadableBuffer message = encode(properties("urgent", true, "archived", false));
+
+        assertMatches(true, "urgent", message);
+        assertMatches(false, "archived", message);
+        assertMatches(true, "urgent = TRUE AND archived = false", message);
+        assertMatches(true, "NOT archived", message);
+        assertMatches(true, "TRUE", message);
+    }
+
+    @Test
+    public void testPropertiesFields() {
+        Message message = Message.Factory.create();
+        Properties properties = new Properties();
+        properties.setMessageId("ID:1");
+        properties.setSubject("order");
+        properties.setCorrelationId("corr");
+        properties.setGroupId("group");
+        properties.setGroupSequence(UnsignedInteger.valueOf(7));
+        message.setProperties(properties);
+        message.setHeader(new Header());
+        message.setApplicationProperties(new ApplicationProperties(properties("JMSType", "shadowed")));
+        message.setBody(new AmqpValue("body"));
+
+        ReadableBuffer encoded = encode(message);
+        assertMatches(true, "JMSMessageID = 'ID:1' AND JMSType = 'order' AND JMSCorrelationID = 'corr'", encoded);
+        assertMatches(true, "JMSXGroupID = 'group' AND JMSXGroupSeq = 7", encoded);
+
+        // Fields beyond the end of the encoded list are absent
+        message.setProperties(new Properties());
+        message.getProperties().setMessageId("ID:2");
+        assertMatches(true, "JMSXGroupID IS NULL AND JMSMessageID = 'ID:2'", encode(message));
+    }
+
+    @Test
+    public void testEvaluationStopsAtFirstMismatch() {
+        Message unfinished = Message.Factory.create();
+        unfinished.setApplicationProperties(new ApplicationProperties(properties("colour", "red", "size", 3)));
+        ReadableBuffer message = encode(unfinished);
+
+        // Chop off the last property, a str8 key and a smallint value, so that reading it fails
+        message.limit(message.limit() - ("size".length() + 2) - 2);
+
+        assertMatches(false, "colour = 'blue' AND size = 3", message);
+        try {
+            CompiledSelector.compile("colour = 'red' AND size = 3").matches(message);
+            fail("Expected the truncated message to be rejected");
+        } catch (DecodeException e) {
+            // Expected
+        }
+    }
+
+    @Test
+    public void testMessageIsNotConsumed() {
+        ReadableBuffer message = encode(properties("colour", "red"));
+        int position = message.position();
+
+        CompiledSelector.compile("colour = 'red'").matches(message);
+        assertEquals(position, message.position());
+    }
+
+    @Test
+    public void testFromFilters() {
+        Map<Symbol, Object> filters = new HashMap<>();
+        assertNull(CompiledSelector.fromFilters(null));
+        assertNull(CompiledSelector.fromFilters(filters));
+
+        filters.put(Symbol.valueOf("jms-selector"), new UnknownDescribedType(CompiledSelector.SELECTOR_FILTER_SYMBOL, "a = 1"));
+        assertEquals("a = 1", CompiledSelector.fromFilters(filters).getSelector());
+
+        filters.put(Symbol.valueOf("jms-selector"), new UnknownDescribedType(CompiledSelector.SELECTOR_FILTER_CODE, "b = 2"));
+        assertEquals("b = 2", CompiledSelector.fromFilters(filters).getSelector());
+    }
+
+    @Test
+    public void testUnsupportedSelectorsAreRejected() {
+        for (String selector : Arrays.asList("colour LIKE 'r%'", "size + 1 = 2", "a = b", "1 = 1", "colour = 'red",
+                                             "colour > 'red'", "(colour = 'red'", "colour = 'red' AND", "size IN (1, 2)")) {
+            try {
+                CompiledSelector.compile(selector);
+                fail("Expected selector to be rejected: " + selector);
+            } catch (IllegalArgumentException e) {
+                // Expected
+            }
+        }
+    }
+
+    @Test
+    public void testUnmappedJmsIdentifiersAreRejected() {
+        for (String identifier : Arrays.asList("JMSPriority", "JMSTimestamp", "JMSDeliveryMode", "JMSExpiration",
+                                               "JMSRedelivered", "JMSDestination", "JMSReplyTo", "JMSXUserID")) {
+            String selector = identifier + " IS NOT NULL";
+            try {
+                CompiledSelector.compile(selector);
+                fail("Expected selector to be rejected: " + selector);
+            } catch (IllegalArgumentException e) {
+                // Expected
+            }
+        }
+
+        Map<Symbol, Object> filters = new HashMap<>();
+        filters.put(Symbol.valueOf("jms-selector"), new UnknownDescribedType(CompiledSelector.SELECTOR_FILTER_SYMBOL, "JMSPriority > 4"));
+        try {
+            CompiledSelector.fromFilters(filters);
+            fail("Expected selector filter to be rejected");
+        } catch (IllegalArgumentException e) {
+            // Expected
+        }
+    }
+
+    private static void assertMatches(boolean expected, String selector, ReadableBuffer message) {
+        CompiledSelector compiled = CompiledSelector.compile(selector);
+        if (expected) {
+            assertTrue(selector, compiled.matches(message));
+        } else {
+            assertFalse(selector, compiled.matches(message));
+        }
+    }
+
+    private static Map<String, Object> properties(Object... keysAndValues) {
+        Map<String, Object> properties = new LinkedHashMap<>();
+        for (int i = 0; i < keysAndValues.length; i += 2) {
+            properties.put((String) keysAndValues[i], keysAndValues[i + 1]);
+        }
+        return properties;
+    }
+
+    private static ReadableBuffer encode(Map<String, Object> properties) {
+        Message message = Message.Factory.create();
+        message.setApplicationProperties(new ApplicationProperties(properties));
+        message.setBody(new AmqpValue("body"));
+        return encode(message);
+    }
+
+    private static ReadableBuffer encode(Message message) {
+        byte[] encoded = new byte[1024];
+        int length = ((MessageImpl) message).encode(encoded, 0, encoded.length);
+        return ReadableBuffer.ByteBufferReader.wrap(Arrays.copyOf(encoded, length));
+    }
+}
@@ -3237,6 +3237,149 @@ public class CompositeReadableBufferTest {
         }
     }
 
+    //----- Test various cases of byteBuffers --------------------------------//
+
+    @Test
+    public void testByteBuffersFromEmptyBuffer() {
+        CompositeReadableBuffer buffer = new CompositeReadableBuffer();
+
+        ByteBuffer[] byteBuffers = buffer.byteBuffers();
+
+        assertNotNull(byteBuffers);
+        assertEquals(0, byteBuffers.length);
+    }
+
+    @Test
+    public void testByteBuffersOnSingleArrayContent() {
+        CompositeReadableBuffer buffer = new CompositeReadableBuffer();
+
+        buffer.append(new byte[] {9, 8, 7, 6, 5, 4, 3, 2, 1, 0});
+        buffer.position(2);
+
+        ByteBuffer[] byteBuffers = buffer.byteBuffers();
+
+        assertEquals(1, byteBuffers.length);
+        assertEquals(8, byteBuffers[0].remaining());
+        assertTrue(byteBuffers[0].isReadOnly());
+
+        for (int i = 0; i < 8; ++i) {
+            assertEquals(buffer.get(i + 2), byteBuffers[0].get());
+        }
+
+        assertEquals(2, buffer.position());
+    }
+
+    @Test
+    public void testByteBuffersOnMultipleArrayContentWithLimits() {
+        CompositeReadableBuffer buffer = new CompositeReadableBuffer();
+
+        buffer.append(new byte[] {9, 8, 7}).append(new byte[] {6, 5, 4}).append(new byte[] {3, 2, 1, 0});
+
+        buffer.position(2);
+        buffer.limit(8);
+
+        ByteBuffer[] byteBuffers = buffer.byteBuffers();
+
+        assertEquals(3, byteBuffers.length);
+        assertEquals(1, byteBuffers[0].remaining());
+        assertEquals(3, byteBuffers[1].remaining());
+        assertEquals(2, byteBuffers[2].remaining());
+
+        for (ByteBuffer byteBuffer : byteBuffers) {
+            assertTrue(byteBuffer.isReadOnly());
+            while (byteBuffer.hasRemaining()) {
+                assertEquals(buffer.get(), byteBuffer.get());
+            }
+        }
+
+        assertFalse(buffer.hasRemaining());
+    }
+
+    //----- Test buffers made of many arrays ---------------------------------//
+
+    @Test
+    public void testPositionAndGetAcrossManyArrays() {
+        final int arrayCount = 1000;
+        final int arraySize = 7;
+
+        CompositeReadableBuffer buffer = new CompositeReadableBuffer();
+        for (int i = 0; i < arrayCount; ++i) {
+            byte[] array = new byte[arraySize];
+            for (int j = 0; j < arraySize; ++j) {
+                array[j] = (byte) (i * arraySize + j);
+            }
+            buffer.append(array);
+        }
+
+        assertEquals(arrayCount * arraySize, buffer.capacity());
+
+        for (int index = buffer.capacity() - 1; index >= 0; index -= 13) {
+            assertEquals((byte) index, buffer.get(index));
+            buffer.position(index);
+            assertEquals(index / arraySize, buffer.getCurrentIndex());
+            assertEquals(index % arraySize, buffer.getCurrentArrayPosition());
+            assertEquals((byte) index, buffer.get());
+        }
+
+        buffer.position(buffer.capacity());
+        assertEquals(arrayCount - 1, buffer.getCurrentIndex());
+        assertEquals(arraySize, buffer.getCurrentArrayPosition());
+    }
+
+    @Test
+    public void testIncrementalReclaimReadAcrossManyArrays() {
+        final int arraySize = 5;
+
+        CompositeReadableBuffer buffer = new CompositeReadableBuffer();
+        int appended = 0;
+        int consumed = 0;
+
+        // Interleave appends and reads so the segment ring wraps around several times.
+        for (int round = 0; round < 100; ++round) {
+            for (int i = 0; i < 3; ++i) {
+                byte[] array = new byte[arraySize];
+                for (int j = 0; j < arraySize; ++j) {
+                    array[j] = (byte) appended++;
+                }
+                buffer.append(array);
+            }
+
+            while (buffer.remaining() > 4) {
+                assertEquals((byte) consumed++, buffer.get());
+            }
+
+            buffer.reclaimRead();
+
+            assertEquals(4, buffer.remaining());
+            assertEquals(1, buffer.getArrays().size());
+            for (int i = 0; i < 4; ++i) {
+                assertEquals((byte) (consumed + i), buffer.get(buffer.position() + i));
+            }
+        }
+
+        while (buffer.hasRemaining()) {
+            assertEquals((byte) consumed++, buffer.get());
+        }
+
+        buffer.reclaimRead();
+
+        assertEquals(appended, consumed);
+        assertEquals(0, buffer.capacity());
+        assertEquals(0, buffer.getArrays().size());
+    }
+
+    @Test
+    public void testGetIntConsumingArrayMovesToNextArray() {
+        CompositeReadableBuffer buffer = new CompositeReadableBuffer();
+
+        buffer.append(int2bytes(42)).append(new byte[] {1, 2});
+
+        assertEquals(42, buffer.getInt());
+        assertEquals(1, buffer.getCurrentIndex());
+        assertEquals(1, buffer.get());
+        assertEquals(2, buffer.get());
+    }
+
     //----- Test readString ------------------------------------------//
 
     @Test
@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.qpid.proton.codec;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+import java.nio.ByteBuffer;
+
+import org.apache.qpid.proton.amqp.Binary;
+import org.apache.qpid.proton.amqp.UnsignedLong;
+import org.apache.qpid.proton.amqp.messaging.Accepted;
+import org.apache.qpid.proton.amqp.transaction.Declare;
+import org.apache.qpid.proton.amqp.transaction.Declared;
+import org.apache.qpid.proton.amqp.transaction.TransactionalState;
+import org.junit.Before;
+import org.junit.Test;
+
+/**
+ * Tests that types registered with {@link AMQPDefinedTypes#registerAllTypesLazily} are
+ * encoded and decoded as if they had been registered up front.
+ */
+public class LazyTypeRegistrationTest {
+
+    private final DecoderImpl decoder = new DecoderImpl();
+    private final EncoderImpl encoder = new EncoderImpl(decoder);
+
+    private final DecoderImpl eagerDecoder = new DecoderImpl();
+    private final EncoderImpl eagerEncoder = new EncoderImpl(eagerDecoder);
+
+    private final ByteBuffer buffer = ByteBuffer.allocate(1024);
+
+    @Before
+    public void setUp() {
+        AMQPDefinedTypes.registerAllTypesLazily(decoder, encoder);
+        AMQPDefinedTypes.registerAllTypes(eagerDecoder, eagerEncoder);
+
+        encoder.setByteBuffer(buffer);
+        decoder.setByteBuffer(buffer);
+        eagerEncoder.setByteBuffer(buffer);
+        eagerDecoder.setByteBuffer(buffer);
+    }
+
+    @Test
+    public void testDeferredTypeRoundTrip() {
+        Declared declared = new Declared();
+        declared.setTxnId(new Binary(new byte[] { 1, 2, 3 }));
+
+        encoder.writeObject(declared);
+        buffer.flip();
+
+        Object result = decoder.readObject();
+        assertTrue(result instanceof Declared);
+        assertEquals(declared.getTxnId(), ((Declared) result).getTxnId());
+    }
+
+    @Test
+    public void testDeferredTypeDecodedFromEagerEncoding() {
+        TransactionalState state = new TransactionalState();
+        state.setTxnId(new Binary(new byte[] { 4, 5, 6 }));
+        state.setOutcome(Accepted.getInstance());
+
+        eagerEncoder.writeObject(state);
+        buffer.flip();
+
+        Object result = decoder.readObject();
+        assertTrue(result instanceof TransactionalState);
+        assertEquals(state.getTxnId(), ((TransactionalState) result).getTxnId());
+        assertTrue(((TransactionalState) result).getOutcome() instanceof Accepted);
+    }
+
+    @Test
+    public void testDeferredTypesDoNotReplaceLaterRegistrations() {
+        final String replacement = "replacement";
+        decoder.register(UnsignedLong.valueOf(0x33L), new DescribedTypeConstructor<String>() {
+            @Override
+            public String newInstance(Object described) {
+                return replacement;
+            }
+
+            @Override
+            public Class<String> getTypeClass() {
+                return String.class;
+            }
+        });
+
+        // Reading another type of the deferred family must not replace the registration above
+        eagerEncoder.writeObject(new Declare());
+        Declared declared = new Declared();
+        declared.setTxnId(new Binary(new byte[] { 7 }));
+        eagerEncoder.writeObject(declared);
+        buffer.flip();
+
+        assertTrue(decoder.readObject() instanceof Declare);
+        assertEquals(replacement, decoder.readObject());
+    }
+}
@@ -0,0 +1,203 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.apache.qpid.proton.codec;
+
+import static org.junit.Assert.*;
+
+import java.nio.ByteBuffer;
+import java.util.EnumSet;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import org.apache.qpid.proton.Proton;
+import org.apache.qpid.proton.engine.Connection;
+import org.apache.qpid.proton.engine.Delivery;
+import org.apache.qpid.proton.engine.EndpointState;
+import org.apache.qpid.proton.engine.Link;
+import org.apache.qpid.proton.engine.Receiver;
+import org.apache.qpid.proton.engine.Sender;
+import org.apache.qpid.proton.engine.Session;
+import org.apache.qpid.proton.engine.Transport;
+import org.junit.Test;
+
+/**
+ * Test for API of the SharedPayload class.
+ */
+public class SharedPayloadTest {
+
+    @Test
+    public void testViewsShareTheBackingArray() {
+        byte[] data = new byte[] { 0, 1, 2, 3, 4, 5, 6, 7 };
+        SharedPayload payload = SharedPayload.wrap(data, 2, 4);
+
+        assertEquals(4, payload.length());
+
+        ReadableBuffer first = payload.retain();
+        ReadableBuffer second = payload.retain();
+
+        assertTrue(first.hasArray());
+        assertSame(data, first.array());
+        assertSame(data, second.array());
+        assertEquals(2, first.arrayOffset());
+        assertEquals(4, first.remaining());
+        assertEquals(2, first.get());
+        assertEquals(3, first.remaining());
+        assertEquals(4, second.remaining());
+        assertEquals(3, payload.refCount());
+    }
+
+    @Test
+    public void testReleasedOnceCreatorAndAllViewsAreDone() {
+        AtomicInteger released = new AtomicInteger();
+        SharedPayload payload = SharedPayload.wrap(ByteBuffer.wrap(new byte[] { 1, 2, 3 }), released::incrementAndGet);
+
+        ReadableBuffer first = payload.retain();
+        ReadableBuffer second = payload.retain();
+        payload.release();
+
+        // Partially read views keep their reference
+        first.get();
+        first.reclaimRead();
+        assertEquals(2, payload.refCount());
+
+        first.get(new byte[2]);
+        first.reclaimRead();
+        first.reclaimRead();
+        assertEquals(1, payload.refCount());
+        assertEquals(0, released.get());
+
+        second.position(second.limit());
+        second.reclaimRead();
+        assertEquals(0, payload.refCount());
+        assertEquals(1, released.get());
+    }
+
+    @Test
+    public void testRetainAfterReleaseFails() {
+        SharedPayload payload = SharedPayload.wrap(new byte[] { 1 });
+        payload.release();
+
+        try {
+            payload.retain();
+            fail("Should not be able to retain a released payload");
+        } catch (IllegalStateException ise) {
+        }
+
+        try {
+            payload.release();
+            fail("Should not be able to release a payload twice");
+        } catch (IllegalStateException ise) {
+        }
+    }
+
+    @Test
+    public void testFanOutToSendersOnSeveralConnections() {
+        byte[] data = new byte[4096];
+        for (int i = 0; i < data.length; ++i) {
+            data[i] = (byte) i;
+        }
+
+        AtomicInteger released = new AtomicInteger();
+        SharedPayload payload = SharedPayload.wrap(ByteBuffer.wrap(data), released::incrementAndGet);
+
+        Endpoints first = new Endpoints();
+        Endpoints second = new Endpoints();
+
+        first.sender.delivery(new byte[] { 1 });
+        first.sender.sendNoCopy(payload.retain());
+        first.sender.advance();
+
+        second.sender.delivery(new byte[] { 1 });
+        second.sender.sendNoCopy(payload.retain());
+        second.sender.advance();
+
+        payload.release();
+        assertEquals(2, payload.refCount());
+
+        first.pump();
+        assertEquals(1, payload.refCount());
+        assertEquals(0, released.get());
+
+        second.pump();
+        assertEquals(0, payload.refCount());
+        assertEquals(1, released.get());
+
+        assertArrayEquals(data, first.receive());
+        assertArrayEquals(data, second.receive());
+    }
+
+    private static final class Endpoints {
+
+        private final Transport clientTransport = Proton.transport();
+        private final Transport serverTransport = Proton.transport();
+        private final Sender sender;
+        private final Receiver receiver;
+
+        Endpoints() {
+            Connection clientConnection = Proton.connection();
+            Connection serverConnection = Proton.connection();
+            clientTransport.bind(clientConnection);
+            serverTransport.bind(serverConnection);
+
+            clientConnection.open();
+            Session session = clientConnection.session();
+            session.open();
+            sender = session.sender("fan-out");
+            sender.open();
+
+            pump();
+
+            serverConnection.open();
+            serverConnection.sessionHead(EnumSet.of(EndpointState.UNINITIALIZED), EnumSet.of(EndpointState.ACTIVE)).open();
+            Link link = serverConnection.linkHead(EnumSet.of(EndpointState.UNINITIALIZED), EnumSet.of(EndpointState.ACTIVE));
+            receiver = (Receiver) link;
+            receiver.open();
+            receiver.flow(1);
+
+            pump();
+        }
+
+        byte[] receive() {
+            Delivery delivery = receiver.current();
+            assertNotNull(delivery);
+            assertFalse(delivery.isPartial());
+
+            byte[] received = new byte[delivery.pending()];
+            assertEquals(received.length, receiver.recv(received, 0, received.length));
+            receiver.advance();
+            return received;
+        }
+
+        void pump() {
+            boolean moved;
+            do {
+                moved = pump(clientTransport, serverTransport);
+                moved |= pump(serverTransport, clientTransport);
+            } while (moved);
+        }
+
+        private static boolean pump(Transport from, Transport to) {
+            ByteBuffer output = from.getOutputBuffer();
+            boolean moved = output.hasRemaining();
+            if (moved) {
+                to.processInput(output).checkIsOk();
+            }
+
+            from.outputConsumed();
+            return moved;
+        }
+    }
+}
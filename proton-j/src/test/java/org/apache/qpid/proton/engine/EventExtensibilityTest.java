@@ -242,6 +242,11 @@ public class EventExtensibilityTest extends TestCase {
             return impl.getDelivery();
         }
 
+        @Override
+        public DeliveryBatch getDeliveryBatch() {
+            return impl.getDeliveryBatch();
+        }
+
         @Override
 		public Transport getTransport() {
             return impl.getTransport();
@@ -344,10 +349,16 @@ public class EventExtensibilityTest extends TestCase {
             fail();
         case DELIVERY:
             fail();
+        case DELIVERY_BATCH:
+            fail();
+        case DELIVERY_EXPIRED:
+            fail();
         case LINK_FINAL:
             fail();
         case LINK_FLOW:
             fail();
+        case LINK_WRITABLE:
+            fail();
         case LINK_INIT:
             fail();
         case LINK_LOCAL_CLOSE:
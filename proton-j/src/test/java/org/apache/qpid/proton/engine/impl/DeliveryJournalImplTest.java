@@ -0,0 +1,244 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine.impl;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+import java.io.File;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.List;
+
+import org.apache.qpid.proton.Proton;
+import org.apache.qpid.proton.codec.ReadableBuffer;
+import org.apache.qpid.proton.engine.Connection;
+import org.apache.qpid.proton.engine.Delivery;
+import org.apache.qpid.proton.engine.DeliveryJournal;
+import org.apache.qpid.proton.engine.DeliveryJournal.RecoveredDelivery;
+import org.apache.qpid.proton.engine.Sender;
+import org.apache.qpid.proton.engine.Session;
+import org.junit.Before;
+import org.junit.Rule;
+import org.junit.Test;
+import org.junit.rules.TemporaryFolder;
+
+public class DeliveryJournalImplTest
+{
+    private static final int SEGMENT_SIZE = 4096;
+
+    @Rule
+    public TemporaryFolder _folder = new TemporaryFolder();
+
+    private File _directory;
+
+    @Before
+    public void setUp() throws Exception
+    {
+        _directory = new File(_folder.getRoot(), "journal");
+    }
+
+    @Test
+    public void testUnsettledDeliveriesAreRecovered() throws Exception
+    {
+        DeliveryJournal journal = DeliveryJournal.Factory.open(_directory, SEGMENT_SIZE);
+        Sender sender = createSender("sender", journal);
+
+        Delivery first = send(sender, "tag1", "first");
+        send(sender, "tag2", "second");
+        sender.delivery("tag3".getBytes(StandardCharsets.UTF_8)).setMessageFormat(7);
+        sender.send(bytes("third"), 0, 5);
+        sender.advance();
+
+        // Never completed, so not recovered
+        sender.delivery("tag4".getBytes(StandardCharsets.UTF_8));
+        sender.send(bytes("fourth"), 0, 6);
+
+        first.settle();
+        assertEquals(3, journal.getUnsettledCount());
+        journal.close();
+
+        journal = DeliveryJournal.Factory.open(_directory, SEGMENT_SIZE);
+        List<RecoveredDelivery> recovered = new ArrayList<>(journal.getRecovered());
+        assertEquals(2, recovered.size());
+        assertRecovered(recovered.get(0), "sender", "tag2", "second");
+        assertRecovered(recovered.get(1), "sender", "tag3", "third");
+        assertEquals(7, recovered.get(1).getMessageFormat());
+        assertEquals(2, journal.getUnsettledCount());
+        journal.close();
+    }
+
+    @Test
+    public void testSegmentsAreDeletedOnceSettled() throws Exception
+    {
+        DeliveryJournal journal = DeliveryJournal.Factory.open(_directory, SEGMENT_SIZE);
+        Sender sender = createSender("sender", journal);
+
+        Delivery unsettled = send(sender, "unsettled", "kept");
+        byte[] payload = new byte[1000];
+        for (int i = 0; i < 100; i++)
+        {
+            send(sender, "tag" + i, payload).settle();
+        }
+
+        // The first segment is kept for the unsettled delivery, and one is being written
+        assertEquals(2, journal.getSegmentCount());
+        assertEquals(1, journal.getUnsettledCount());
+
+        unsettled.settle();
+        assertEquals(1, journal.getSegmentCount());
+        assertEquals(0, journal.getUnsettledCount());
+        journal.close();
+
+        journal = DeliveryJournal.Factory.open(_directory, SEGMENT_SIZE);
+        assertTrue(journal.getRecovered().isEmpty());
+        assertEquals(0, journal.getSegmentCount());
+        journal.close();
+    }
+
+    @Test
+    public void testSettledDeliveryIsNotRecoveredFromLaterSegment() throws Exception
+    {
+        DeliveryJournal journal = DeliveryJournal.Factory.open(_directory, SEGMENT_SIZE);
+        Sender sender = createSender("sender", journal);
+        Sender other = createSender("other", journal);
+
+        // Start a delivery in the first segment, then fill it so the rest goes in the second
+        Delivery spanning = sender.delivery("spanning".getBytes(StandardCharsets.UTF_8));
+        sender.send(bytes("part1"), 0, 5);
+        byte[] payload = new byte[1000];
+        for (int i = 0; i < 5; i++)
+        {
+            send(other, "tag" + i, payload).settle();
+        }
+        assertEquals(2, journal.getSegmentCount());
+
+        sender.send(bytes("part2"), 0, 5);
+        sender.advance();
+        send(other, "unsettled", "kept");
+
+        // The first segment is reclaimed, the second is kept for the unsettled delivery
+        spanning.settle();
+        assertEquals(1, journal.getSegmentCount());
+        journal.close();
+
+        journal = DeliveryJournal.Factory.open(_directory, SEGMENT_SIZE);
+        List<RecoveredDelivery> recovered = new ArrayList<>(journal.getRecovered());
+        assertEquals(1, recovered.size());
+        assertRecovered(recovered.get(0), "other", "unsettled", "kept");
+        assertEquals(1, journal.getUnsettledCount());
+        journal.close();
+    }
+
+    @Test
+    public void testPayloadSpanningSegmentsIsRecovered() throws Exception
+    {
+        DeliveryJournal journal = DeliveryJournal.Factory.open(_directory, SEGMENT_SIZE);
+        Sender sender = createSender("sender", journal);
+
+        byte[] payload = new byte[3 * SEGMENT_SIZE];
+        for (int i = 0; i < payload.length; i++)
+        {
+            payload[i] = (byte) i;
+        }
+
+        sender.delivery("large".getBytes(StandardCharsets.UTF_8));
+        sender.send(ReadableBuffer.ByteBufferReader.wrap(payload));
+        sender.advance();
+        journal.close();
+
+        journal = DeliveryJournal.Factory.open(_directory, SEGMENT_SIZE);
+        RecoveredDelivery recovered = journal.getRecovered().iterator().next();
+        ReadableBuffer recoveredPayload = recovered.getPayload();
+        byte[] copy = new byte[recoveredPayload.remaining()];
+        recoveredPayload.get(copy);
+        assertArrayEquals(payload, copy);
+        journal.close();
+    }
+
+    @Test
+    public void testSendingAgainSupersedesRecoveredDelivery() throws Exception
+    {
+        DeliveryJournal journal = DeliveryJournal.Factory.open(_directory, SEGMENT_SIZE);
+        Sender sender = createSender("sender", journal);
+        send(sender, "tag1", "first");
+        send(sender, "tag2", "second");
+        journal.close();
+
+        journal = DeliveryJournal.Factory.open(_directory, SEGMENT_SIZE);
+        sender = createSender("sender", journal);
+        List<RecoveredDelivery> recovered = new ArrayList<>(journal.getRecovered());
+        assertEquals(2, recovered.size());
+
+        RecoveredDelivery first = recovered.get(0);
+        sender.delivery(first.getTag());
+        sender.sendNoCopy(first.getPayload());
+        sender.advance();
+        journal.discard(recovered.get(1));
+
+        assertTrue(journal.getRecovered().isEmpty());
+        assertEquals(1, journal.getUnsettledCount());
+        journal.close();
+
+        journal = DeliveryJournal.Factory.open(_directory, SEGMENT_SIZE);
+        recovered = new ArrayList<>(journal.getRecovered());
+        assertEquals(1, recovered.size());
+        assertRecovered(recovered.get(0), "sender", "tag1", "first");
+        journal.close();
+    }
+
+    private Sender createSender(String name, DeliveryJournal journal)
+    {
+        Connection connection = Proton.connection();
+        Session session = connection.session();
+        Sender sender = session.sender(name);
+        sender.setDeliveryJournal(journal);
+        return sender;
+    }
+
+    private Delivery send(Sender sender, String tag, String payload)
+    {
+        return send(sender, tag, bytes(payload));
+    }
+
+    private Delivery send(Sender sender, String tag, byte[] payload)
+    {
+        Delivery delivery = sender.delivery(tag.getBytes(StandardCharsets.UTF_8));
+        sender.send(payload, 0, payload.length);
+        sender.advance();
+        return delivery;
+    }
+
+    private void assertRecovered(RecoveredDelivery recovered, String linkName, String tag, String payload)
+    {
+        assertEquals(linkName, recovered.getLinkName());
+        assertArrayEquals(bytes(tag), recovered.getTag());
+
+        ReadableBuffer recoveredPayload = recovered.getPayload();
+        byte[] copy = new byte[recoveredPayload.remaining()];
+        recoveredPayload.get(copy);
+        assertEquals(payload, new String(copy, StandardCharsets.UTF_8));
+    }
+
+    private static byte[] bytes(String value)
+    {
+        return value.getBytes(StandardCharsets.UTF_8);
+    }
+}
@@ -268,6 +268,86 @@ public class FrameParserTest
         inOrder.verify(_mockFrameHandler).handleFrame(frameMatching(channel, closeFrame));
     }
 
+    @Test
+    public void testProcessCallerBufferInPlace_invokesFrameTransportCallbacks()
+    {
+        int channel = 0;
+        Open openFrame = generateOpenFrame();
+        byte[] openFrameBytes = _amqpFramer.generateFrame(channel, openFrame);
+
+        Close closeFrame = generateCloseFrame();
+        byte[] closeFrameBytes = _amqpFramer.generateFrame(channel, closeFrame);
+
+        ByteBuffer input = ByteBuffer.allocateDirect(HEADER.length + openFrameBytes.length + closeFrameBytes.length);
+        input.put(HEADER).put(openFrameBytes).put(closeFrameBytes);
+        input.flip();
+
+        _frameParser.process(input);
+
+        assertEquals(0, input.remaining());
+        assertEquals(0, _frameParser.position());
+
+        InOrder inOrder = inOrder(_mockFrameHandler);
+        inOrder.verify(_mockFrameHandler).handleFrame(frameMatching(channel, openFrame));
+        inOrder.verify(_mockFrameHandler).handleFrame(frameMatching(channel, closeFrame));
+    }
+
+    @Test
+    public void testProcessCallerBufferInPlaceWithFrameSplitAcrossBuffers()
+    {
+        sendHeader();
+
+        int channel = 0;
+        Open openFrame = generateOpenFrame();
+        byte[] frame = _amqpFramer.generateFrame(channel, openFrame);
+        int lengthOfFirstChunk = frame.length / 2;
+
+        ByteBuffer first = ByteBuffer.wrap(frame, 0, lengthOfFirstChunk);
+        _frameParser.process(first);
+
+        assertEquals(0, first.remaining());
+        verify(_mockFrameHandler, never()).handleFrame(any(TransportFrame.class));
+
+        ByteBuffer second = ByteBuffer.wrap(frame, lengthOfFirstChunk, frame.length - lengthOfFirstChunk);
+        _frameParser.process(second);
+
+        assertEquals(0, second.remaining());
+        verify(_mockFrameHandler).handleFrame(frameMatching(channel, openFrame));
+    }
+
+    @Test
+    public void testProcessCallerBufferInPlaceRetainsInputBehindHeldFrame()
+    {
+        when(_mockFrameHandler.isHandlingFrames()).thenReturn(false);
+
+        sendHeader();
+
+        int channel = 0;
+        Open openFrame = generateOpenFrame();
+        byte[] openFrameBytes = _amqpFramer.generateFrame(channel, openFrame);
+
+        Close closeFrame = generateCloseFrame();
+        byte[] closeFrameBytes = _amqpFramer.generateFrame(channel, closeFrame);
+
+        ByteBuffer input = ByteBuffer.allocate(openFrameBytes.length + closeFrameBytes.length);
+        input.put(openFrameBytes).put(closeFrameBytes);
+        input.flip();
+
+        _frameParser.process(input);
+
+        assertEquals(0, input.remaining());
+        assertEquals(closeFrameBytes.length, _frameParser.position());
+        verify(_mockFrameHandler, never()).handleFrame(any(TransportFrame.class));
+
+        when(_mockFrameHandler.isHandlingFrames()).thenReturn(true);
+
+        _frameParser.flush();
+
+        InOrder inOrder = inOrder(_mockFrameHandler);
+        inOrder.verify(_mockFrameHandler).handleFrame(frameMatching(channel, openFrame));
+        inOrder.verify(_mockFrameHandler).handleFrame(frameMatching(channel, closeFrame));
+    }
+
     private void sendHeader() throws TransportException
     {
         ByteBuffer buffer = _frameParser.tail();
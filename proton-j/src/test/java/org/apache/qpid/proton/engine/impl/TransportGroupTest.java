@@ -0,0 +1,177 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine.impl;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assert.fail;
+
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Set;
+
+import org.apache.qpid.proton.Proton;
+import org.apache.qpid.proton.engine.Connection;
+import org.apache.qpid.proton.engine.EndpointState;
+import org.apache.qpid.proton.engine.Transport;
+import org.apache.qpid.proton.engine.TransportGroup;
+import org.junit.Test;
+
+public class TransportGroupTest
+{
+    private static final int CONNECTIONS = 50;
+
+    @Test
+    public void testGroupsOpenConnectionsInBatches() throws Exception
+    {
+        TransportGroup clients = TransportGroup.Factory.create();
+        TransportGroup servers = TransportGroup.Factory.create();
+
+        List<Transport> clientTransports = new ArrayList<>();
+        List<Transport> serverTransports = new ArrayList<>();
+        List<Connection> clientConnections = new ArrayList<>();
+        List<Connection> serverConnections = new ArrayList<>();
+
+        for (int i = 0; i < CONNECTIONS; i++)
+        {
+            Transport client = Proton.transport();
+            Connection clientConnection = Proton.connection();
+            client.bind(clientConnection);
+            clients.add(client);
+
+            Transport server = Proton.transport();
+            Connection serverConnection = Proton.connection();
+            server.bind(serverConnection);
+            servers.add(server);
+
+            clientTransports.add(client);
+            serverTransports.add(server);
+            clientConnections.add(clientConnection);
+            serverConnections.add(serverConnection);
+        }
+        assertEquals(CONNECTIONS, clients.size());
+
+        // Every transport has at least its header to send
+        assertEquals(CONNECTIONS, clients.process().size());
+        transfer(clients, clientTransports, servers, serverTransports);
+        assertEquals(CONNECTIONS, servers.process().size());
+        transfer(servers, serverTransports, clients, clientTransports);
+        clients.process();
+
+        // Nothing has changed for the clients, so none has output
+        assertEquals(0, clients.process().size());
+
+        // Opening some connections makes only their transports have output
+        for (int i = 0; i < CONNECTIONS; i += 2)
+        {
+            clientConnections.get(i).open();
+        }
+
+        List<Transport> withOutput = clients.process();
+        assertEquals(CONNECTIONS / 2, withOutput.size());
+        for (int i = 0; i < CONNECTIONS; i += 2)
+        {
+            assertTrue(withOutput.contains(clientTransports.get(i)));
+        }
+
+        transfer(clients, clientTransports, servers, serverTransports);
+        servers.process();
+        for (int i = 0; i < CONNECTIONS; i++)
+        {
+            EndpointState expected = i % 2 == 0 ? EndpointState.ACTIVE : EndpointState.UNINITIALIZED;
+            assertEquals(expected, serverConnections.get(i).getRemoteState());
+        }
+    }
+
+    @Test
+    public void testClosedTransportsAreReported() throws Exception
+    {
+        TransportGroup group = TransportGroup.Factory.create();
+        Transport transport = Proton.transport();
+        group.add(transport);
+
+        transport.getInputBuffer().put("not amqp".getBytes());
+        group.inputWritten(transport);
+
+        for (int i = 0; i < 3 && group.getClosed().isEmpty(); i++)
+        {
+            for (Transport withOutput : group.process())
+            {
+                withOutput.pop(withOutput.pending());
+            }
+        }
+
+        assertEquals(1, group.getClosed().size());
+        assertTrue(group.getClosed().contains(transport));
+    }
+
+    @Test
+    public void testTransportBelongsToOneGroup() throws Exception
+    {
+        TransportGroup group = TransportGroup.Factory.create();
+        TransportGroup other = TransportGroup.Factory.create();
+        Transport transport = Proton.transport();
+
+        group.add(transport);
+        try
+        {
+            other.add(transport);
+            fail("Expected transport to be refused");
+        }
+        catch (IllegalStateException e)
+        {
+            // Expected
+        }
+
+        group.remove(transport);
+        assertEquals(0, group.size());
+        assertEquals("A removed transport should not be processed", 0, group.process().size());
+
+        other.add(transport);
+        assertEquals(1, other.process().size());
+    }
+
+    /**
+     * Writes the output of every transport of the source group with some to its peer, and tells
+     * the target group which of its transports have input.
+     */
+    private void transfer(TransportGroup source, List<Transport> sourceTransports,
+                          TransportGroup target, List<Transport> targetTransports)
+    {
+        Set<Transport> written = new HashSet<>();
+        for (int i = 0; i < sourceTransports.size(); i++)
+        {
+            Transport from = sourceTransports.get(i);
+            Transport to = targetTransports.get(i);
+
+            ByteBuffer head = from.head();
+            if (head.hasRemaining())
+            {
+                int length = head.remaining();
+                to.tail().put(head);
+                from.pop(length);
+                target.inputWritten(to);
+                written.add(to);
+            }
+        }
+        assertTrue(!written.isEmpty());
+    }
+}
@@ -26,6 +26,7 @@ import static org.junit.Assert.assertEquals;
 import static org.junit.Assert.assertFalse;
 import static org.junit.Assert.assertNotNull;
 import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertSame;
 import static org.junit.Assert.assertTrue;
 import static org.junit.Assert.fail;
 
@@ -33,12 +34,16 @@ import java.nio.ByteBuffer;
 import java.nio.charset.StandardCharsets;
 import java.util.ArrayList;
 import java.util.Arrays;
+import java.util.EnumMap;
 import java.util.LinkedList;
+import java.util.Map;
 import java.util.Random;
+import java.util.concurrent.atomic.AtomicBoolean;
 
 import org.apache.qpid.proton.Proton;
 import org.apache.qpid.proton.amqp.Binary;
 import org.apache.qpid.proton.amqp.UnsignedInteger;
+import org.apache.qpid.proton.amqp.UnsignedLong;
 import org.apache.qpid.proton.amqp.UnsignedShort;
 import org.apache.qpid.proton.amqp.messaging.Accepted;
 import org.apache.qpid.proton.amqp.messaging.AmqpValue;
@@ -51,10 +56,12 @@ import org.apache.qpid.proton.amqp.transport.Disposition;
 import org.apache.qpid.proton.amqp.transport.End;
 import org.apache.qpid.proton.amqp.transport.Flow;
 import org.apache.qpid.proton.amqp.transport.FrameBody;
+import org.apache.qpid.proton.amqp.transport.LinkError;
 import org.apache.qpid.proton.amqp.transport.Open;
 import org.apache.qpid.proton.amqp.transport.Role;
 import org.apache.qpid.proton.amqp.transport.Transfer;
 import org.apache.qpid.proton.codec.ReadableBuffer;
+import org.apache.qpid.proton.codec.SharedPayload;
 import org.apache.qpid.proton.engine.Collector;
 import org.apache.qpid.proton.engine.Connection;
 import org.apache.qpid.proton.engine.Delivery;
@@ -96,6 +103,38 @@ public class TransportImplTest
         assertNotNull(_transport.getInputBuffer());
     }
 
+    @Test
+    public void testProcessInputFromCallerBuffer()
+    {
+        ConnectionImpl connection = new ConnectionImpl();
+        _transport.bind(connection);
+
+        Open open = new Open();
+        open.setContainerId("container");
+        byte[] openFrame = new AmqpFramer().generateFrame(0, open);
+
+        ByteBuffer input = ByteBuffer.allocate(HEADER.length + openFrame.length);
+        input.put(HEADER).put(openFrame);
+        input.flip();
+
+        _transport.processInput(input).checkIsOk();
+
+        assertFalse(input.hasRemaining());
+        assertEquals(1, _transport.getFramesInput());
+        assertEquals(EndpointState.ACTIVE, connection.getRemoteState());
+    }
+
+    @Test
+    public void testProcessInputFromCallerBufferAfterInvalidInputFails()
+    {
+        _transport.processInput(ByteBuffer.wrap("hello".getBytes(StandardCharsets.US_ASCII)));
+
+        ByteBuffer input = ByteBuffer.wrap(HEADER);
+
+        assertFalse(_transport.processInput(input).isOk());
+        assertEquals(HEADER.length, input.remaining());
+    }
+
     @Test
     public void testInitialProcessIsNoop()
     {
@@ -952,6 +991,313 @@ public class TransportImplTest
         }
     }
 
+    @Test
+    public void testSenderQueuedDeliveryLimitAppliesBackpressure()
+    {
+        MockTransportImpl transport = new MockTransportImpl();
+        Connection connection = Proton.connection();
+        transport.bind(connection);
+
+        Collector collector = Collector.Factory.create();
+        connection.collect(collector);
+
+        connection.open();
+        Session session = connection.session();
+        session.open();
+
+        String linkName = "mySender";
+        Sender sender = session.sender(linkName);
+        sender.setMaxQueuedDeliveries(2);
+        sender.open();
+
+        pumpMockTransport(transport);
+
+        // Queue deliveries while the peer has granted no credit
+        assertTrue("Sender should be writable", sender.isWritable());
+        sendMessage(sender, "tag1", "content1");
+        assertTrue("Sender should be writable", sender.isWritable());
+        sendMessage(sender, "tag2", "content2");
+        assertFalse("Sender should not be writable", sender.isWritable());
+        assertTrue("Unexpected queued bytes", sender.getQueuedBytes() > 0);
+
+        try
+        {
+            sender.delivery("tag3".getBytes(StandardCharsets.UTF_8));
+            fail("Expected delivery creation to be refused");
+        }
+        catch (IllegalStateException ise)
+        {
+            // Expected
+        }
+
+        drainEvents(collector);
+
+        grantSenderCredit(transport, linkName, 10);
+        pumpMockTransport(transport);
+
+        assertEquals("Unexpected frames written: " + getFrameTypesWritten(transport), 5, transport.writes.size());
+        assertTrue("Sender should be writable", sender.isWritable());
+        assertEquals("Unexpected queued bytes", 0, sender.getQueuedBytes());
+        assertEquals("Unexpected writable events", 1, drainEvents(collector).get(Event.Type.LINK_WRITABLE).intValue());
+
+        assertNotNull(sender.delivery("tag3".getBytes(StandardCharsets.UTF_8)));
+    }
+
+    @Test
+    public void testSessionOutgoingByteLimitAppliesBackpressure()
+    {
+        MockTransportImpl transport = new MockTransportImpl();
+        Connection connection = Proton.connection();
+        transport.bind(connection);
+
+        Collector collector = Collector.Factory.create();
+        connection.collect(collector);
+
+        connection.open();
+        Session session = connection.session();
+        session.setMaxOutgoingBytes(1);
+        session.open();
+
+        String linkName = "mySender";
+        Sender sender = session.sender(linkName);
+        sender.open();
+        Sender other = session.sender("otherSender");
+
+        pumpMockTransport(transport);
+
+        sendMessage(sender, "tag1", "content1");
+
+        assertFalse("Sender should not be writable", sender.isWritable());
+        assertFalse("Other sender should not be writable", other.isWritable());
+        assertEquals("Unexpected outgoing bytes", sender.getQueuedBytes(), session.getOutgoingBytes());
+
+        drainEvents(collector);
+
+        grantSenderCredit(transport, linkName, 10);
+        pumpMockTransport(transport);
+
+        assertEquals("Unexpected outgoing bytes", 0, session.getOutgoingBytes());
+        assertTrue("Sender should be writable", sender.isWritable());
+        assertTrue("Other sender should be writable", other.isWritable());
+        assertEquals("Unexpected writable events", 2, drainEvents(collector).get(Event.Type.LINK_WRITABLE).intValue());
+    }
+
+    @Test
+    public void testExpiredQueuedDeliveryIsDroppedBeforeSending()
+    {
+        MockTransportImpl transport = new MockTransportImpl();
+        Connection connection = Proton.connection();
+        transport.bind(connection);
+
+        Collector collector = Collector.Factory.create();
+        connection.collect(collector);
+
+        connection.open();
+        Session session = connection.session();
+        session.open();
+
+        String linkName = "mySender";
+        Sender sender = session.sender(linkName);
+        sender.open();
+
+        pumpMockTransport(transport);
+        drainEvents(collector);
+
+        // Queue deliveries while the peer has granted no credit
+        Delivery expired = sendMessage(sender, "tag1", "content1");
+        expired.setExpiryTime(1);
+        Delivery live = sendMessage(sender, "tag2", "content2");
+        live.setExpiryTime(System.currentTimeMillis() + 60000);
+        int credit = sender.getCredit();
+
+        pumpMockTransport(transport);
+
+        assertTrue("Delivery should have expired", expired.isExpired());
+        assertFalse("Delivery should not have expired", live.isExpired());
+        assertEquals("Unexpected expired events", 1, drainEvents(collector).get(Event.Type.DELIVERY_EXPIRED).intValue());
+        assertEquals("Credit taken by the expired delivery should be given back", credit + 1, sender.getCredit());
+        assertEquals("Unexpected queued deliveries", 1, sender.getQueued());
+        expired.settle();
+
+        grantSenderCredit(transport, linkName, 10);
+        pumpMockTransport(transport);
+
+        assertEquals("Unexpected frames written: " + getFrameTypesWritten(transport), 4, transport.writes.size());
+        assertTrue(transport.writes.get(3) instanceof Transfer);
+        assertArrayEquals("tag2".getBytes(StandardCharsets.UTF_8), ((Transfer) transport.writes.get(3)).getDeliveryTag().getArray());
+        assertEquals("Unexpected queued bytes", 0, sender.getQueuedBytes());
+        assertEquals("Unexpected queued deliveries", 0, sender.getQueued());
+    }
+
+    @Test
+    public void testExpiredSendNoCopyDeliveryReleasesItsPayload()
+    {
+        MockTransportImpl transport = new MockTransportImpl();
+        Connection connection = Proton.connection();
+        transport.bind(connection);
+
+        connection.open();
+        Session session = connection.session();
+        session.open();
+
+        Sender sender = session.sender("mySender");
+        sender.open();
+
+        pumpMockTransport(transport);
+
+        final AtomicBoolean released = new AtomicBoolean();
+        SharedPayload payload = SharedPayload.wrap(ByteBuffer.wrap(new byte[] { 1, 2, 3, 4 }), new Runnable()
+        {
+            @Override
+            public void run()
+            {
+                released.set(true);
+            }
+        });
+
+        Delivery delivery = sender.delivery("tag1".getBytes(StandardCharsets.UTF_8));
+        sender.sendNoCopy(payload.retain());
+        sender.advance();
+        delivery.setExpiryTime(1);
+        payload.release();
+        assertFalse("Payload should still be referenced by the delivery", released.get());
+
+        pumpMockTransport(transport);
+
+        assertTrue("Delivery should have expired", delivery.isExpired());
+        assertTrue("Payload of the expired delivery should have been released", released.get());
+        assertEquals("Unexpected queued bytes", 0, sender.getQueuedBytes());
+    }
+
+    @Test
+    public void testRangeDispositionEmitsDeliveryEventPerDelivery()
+    {
+        doRangeDispositionTestImpl(false);
+    }
+
+    @Test
+    public void testRangeDispositionEmitsSingleDeliveryBatchEvent()
+    {
+        doRangeDispositionTestImpl(true);
+    }
+
+    private void doRangeDispositionTestImpl(boolean emitDeliveryBatchEvents)
+    {
+        MockTransportImpl transport = new MockTransportImpl();
+        transport.setEmitDeliveryBatchEvents(emitDeliveryBatchEvents);
+        Connection connection = Proton.connection();
+        transport.bind(connection);
+
+        Collector collector = Collector.Factory.create();
+        connection.collect(collector);
+
+        connection.open();
+        Session session = connection.session();
+        session.open();
+
+        String linkName = "mySender";
+        Sender sender = session.sender(linkName);
+        sender.open();
+
+        pumpMockTransport(transport);
+
+        grantSenderCredit(transport, linkName, 10);
+
+        int count = 5;
+        Delivery[] deliveries = new Delivery[count];
+        for (int i = 0; i < count; ++i)
+        {
+            deliveries[i] = sendMessage(sender, "tag" + i, "content" + i);
+        }
+
+        pumpMockTransport(transport);
+        drainEvents(collector);
+
+        // Settle the whole range, and beyond, with a single disposition
+        Disposition disposition = new Disposition();
+        disposition.setRole(Role.RECEIVER);
+        disposition.setFirst(UnsignedInteger.ZERO);
+        disposition.setLast(UnsignedInteger.valueOf(1000));
+        disposition.setSettled(true);
+        disposition.setState(Accepted.getInstance());
+        transport.handleFrame(new TransportFrame(0, disposition, null));
+
+        for (Delivery delivery : deliveries)
+        {
+            assertTrue("Delivery should be remotely settled", delivery.remotelySettled());
+            assertEquals(Accepted.getInstance(), delivery.getRemoteState());
+        }
+
+        if (emitDeliveryBatchEvents)
+        {
+            Event event = collector.peek();
+            assertNotNull(event);
+            assertEquals(Event.Type.DELIVERY_BATCH, event.getType());
+            assertSame(sender, event.getLink());
+
+            int index = 0;
+            for (Delivery delivery : event.getDeliveryBatch())
+            {
+                assertSame(deliveries[index++], delivery);
+            }
+            assertEquals(count, index);
+            assertEquals(count, event.getDeliveryBatch().size());
+
+            collector.pop();
+            assertNoEvents(collector);
+        }
+        else
+        {
+            Map<Event.Type, Integer> events = drainEvents(collector);
+            assertEquals(count, events.get(Event.Type.DELIVERY).intValue());
+            assertEquals(0, events.get(Event.Type.DELIVERY_BATCH).intValue());
+        }
+    }
+
+    private void grantSenderCredit(MockTransportImpl transport, String linkName, int credit)
+    {
+        transport.handleFrame(new TransportFrame(0, new Open(), null));
+
+        Begin begin = new Begin();
+        begin.setRemoteChannel(UnsignedShort.valueOf((short) 0));
+        transport.handleFrame(new TransportFrame(0, begin, null));
+
+        Attach attach = new Attach();
+        attach.setHandle(UnsignedInteger.ZERO);
+        attach.setRole(Role.RECEIVER);
+        attach.setName(linkName);
+        attach.setInitialDeliveryCount(UnsignedInteger.ZERO);
+        transport.handleFrame(new TransportFrame(0, attach, null));
+
+        Flow flow = new Flow();
+        flow.setHandle(UnsignedInteger.ZERO);
+        flow.setDeliveryCount(UnsignedInteger.ZERO);
+        flow.setNextIncomingId(UnsignedInteger.ONE);
+        flow.setNextOutgoingId(UnsignedInteger.ZERO);
+        flow.setIncomingWindow(UnsignedInteger.valueOf(1024));
+        flow.setOutgoingWindow(UnsignedInteger.valueOf(1024));
+        flow.setLinkCredit(UnsignedInteger.valueOf(credit));
+        transport.handleFrame(new TransportFrame(0, flow, null));
+    }
+
+    private Map<Event.Type, Integer> drainEvents(Collector collector)
+    {
+        Map<Event.Type, Integer> counts = new EnumMap<Event.Type, Integer>(Event.Type.class);
+        for (Event.Type type : Event.Type.values())
+        {
+            counts.put(type, 0);
+        }
+
+        Event event;
+        while ((event = collector.peek()) != null)
+        {
+            counts.put(event.getType(), counts.get(event.getType()) + 1);
+            collector.pop();
+        }
+
+        return counts;
+    }
+
     /**
      * Verify that no Begin frame is emitted by the Transport should a Session open
      * after the Close frame was sent.
@@ -1592,6 +1938,98 @@ public class TransportImplTest
         assertEquals("Unexpected frames written: " + getFrameTypesWritten(transport), 4, transport.writes.size());
     }
 
+    /**
+     * Verify that a delivery exceeding the receiver's max-message-size stops being buffered as soon
+     * as the limit is passed, and that the link is detached with the appropriate error while further
+     * transfers for it are discarded.
+     */
+    @Test
+    public void testOversizeDeliveryDetachesReceiver()
+    {
+        MockTransportImpl transport = new MockTransportImpl();
+        Connection connection = Proton.connection();
+        transport.bind(connection);
+
+        connection.open();
+
+        Session session = connection.session();
+        session.open();
+
+        String linkName = "myReceiver";
+        Receiver receiver = session.receiver(linkName);
+        receiver.setMaxMessageSize(UnsignedLong.valueOf(10));
+        receiver.flow(5);
+        receiver.open();
+
+        pumpMockTransport(transport);
+
+        transport.handleFrame(new TransportFrame(0, new Open(), null));
+
+        Begin begin = new Begin();
+        begin.setRemoteChannel(UnsignedShort.valueOf((short) 0));
+        transport.handleFrame(new TransportFrame(0, begin, null));
+
+        Attach attach = new Attach();
+        attach.setHandle(UnsignedInteger.ZERO);
+        attach.setRole(Role.SENDER);
+        attach.setName(linkName);
+        attach.setInitialDeliveryCount(UnsignedInteger.ZERO);
+        transport.handleFrame(new TransportFrame(0, attach, null));
+
+        pumpMockTransport(transport);
+        int framesBeforeTransfers = transport.writes.size();
+
+        handlePartialTransfer(transport, 0, true, new byte[8]);
+
+        Delivery delivery = receiver.current();
+        assertNotNull("Should have a delivery", delivery);
+        assertEquals(8, delivery.pending());
+        assertEquals(EndpointState.ACTIVE, receiver.getLocalState());
+
+        // Passes the limit, buffered bytes are dropped and the link is closed
+        handlePartialTransfer(transport, 0, true, new byte[8]);
+
+        assertTrue("Delivery should be aborted", delivery.isAborted());
+        assertEquals(0, delivery.pending());
+        assertEquals(0, session.getIncomingBytes());
+        assertEquals(EndpointState.CLOSED, receiver.getLocalState());
+        assertEquals(LinkError.MESSAGE_SIZE_EXCEEDED, receiver.getCondition().getCondition());
+
+        // The rest of the delivery, and a following one, are discarded
+        handlePartialTransfer(transport, 0, false, new byte[8]);
+        handlePartialTransfer(transport, 1, false, new byte[4]);
+
+        assertEquals(0, delivery.pending());
+        assertEquals(0, session.getIncomingBytes());
+        assertEquals(delivery, receiver.current());
+
+        pumpMockTransport(transport);
+
+        Detach detach = null;
+        for (FrameBody frame : transport.writes.subList(framesBeforeTransfers, transport.writes.size()))
+        {
+            if (frame instanceof Detach)
+            {
+                detach = (Detach) frame;
+            }
+        }
+
+        assertNotNull("Unexpected frames written: " + getFrameTypesWritten(transport), detach);
+        assertEquals(LinkError.MESSAGE_SIZE_EXCEEDED, detach.getError().getCondition());
+    }
+
+    private void handlePartialTransfer(TransportImpl transport, int deliveryNumber, boolean more, byte[] payload)
+    {
+        Transfer transfer = new Transfer();
+        transfer.setDeliveryId(UnsignedInteger.valueOf(deliveryNumber));
+        transfer.setHandle(UnsignedInteger.ZERO);
+        transfer.setDeliveryTag(new Binary(("tag" + deliveryNumber).getBytes(StandardCharsets.UTF_8)));
+        transfer.setMessageFormat(UnsignedInteger.valueOf(DeliveryImpl.DEFAULT_MESSAGE_FORMAT));
+        transfer.setMore(more);
+
+        transport.handleFrame(new TransportFrame(0, transfer, new Binary(payload)));
+    }
+
     private void assertNoEvents(Collector collector)
     {
         assertEvents(collector);
@@ -0,0 +1,265 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+package org.apache.qpid.proton.engine.impl;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertTrue;
+
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+import java.util.EnumSet;
+import java.util.Random;
+
+import org.apache.qpid.proton.engine.Connection;
+import org.apache.qpid.proton.engine.Delivery;
+import org.apache.qpid.proton.engine.EndpointState;
+import org.apache.qpid.proton.engine.Receiver;
+import org.apache.qpid.proton.engine.Sender;
+import org.apache.qpid.proton.engine.Session;
+import org.apache.qpid.proton.engine.Transport;
+import org.junit.Test;
+
+public class WebSocketImplTest
+{
+    private static final String RFC_SAMPLE_KEY = "dGhlIHNhbXBsZSBub25jZQ==";
+    private static final String RFC_SAMPLE_ACCEPT = "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=";
+
+    @Test
+    public void testMaskMatchesBytewiseMasking()
+    {
+        Random random = new Random(7);
+        int maskKey = random.nextInt();
+        byte[] keyBytes = ByteBuffer.allocate(4).putInt(maskKey).array();
+
+        for (int length = 0; length < 40; length++)
+        {
+            for (int maskIndex = 0; maskIndex < 4; maskIndex++)
+            {
+                byte[] data = new byte[length];
+                random.nextBytes(data);
+
+                byte[] expected = new byte[length];
+                for (int i = 0; i < length; i++)
+                {
+                    expected[i] = (byte) (data[i] ^ keyBytes[(maskIndex + i) & 3]);
+                }
+
+                ByteBuffer source = ByteBuffer.wrap(data);
+                ByteBuffer target = ByteBuffer.allocate(length);
+                int nextIndex = WebSocketImpl.mask(source, target, length, maskKey, maskIndex);
+
+                assertArrayEquals("length " + length + " index " + maskIndex, expected, target.array());
+                assertEquals((maskIndex + length) & 3, nextIndex);
+                assertFalse(source.hasRemaining());
+                assertFalse(target.hasRemaining());
+            }
+        }
+    }
+
+    @Test
+    public void testMaskInPlaceAcrossCalls()
+    {
+        byte[] data = new byte[29];
+        new Random(3).nextBytes(data);
+        byte[] original = data.clone();
+        int maskKey = 0x01020304;
+
+        ByteBuffer buffer = ByteBuffer.wrap(data);
+        int index = WebSocketImpl.mask(buffer.duplicate(), buffer, 11, maskKey, 0);
+        WebSocketImpl.mask(buffer.duplicate(), buffer, 18, maskKey, index);
+
+        buffer.clear();
+        WebSocketImpl.mask(buffer.duplicate(), buffer, 29, maskKey, 0);
+
+        assertArrayEquals(original, data);
+    }
+
+    @Test
+    public void testAcceptKey()
+    {
+        assertEquals(RFC_SAMPLE_ACCEPT, WebSocketImpl.acceptKey(RFC_SAMPLE_KEY));
+    }
+
+    @Test
+    public void testServerAnswersUpgradeRequestAndPing()
+    {
+        TransportImpl server = new TransportImpl();
+        server.addTransportLayer(new WebSocketImpl(WebSocketImpl.Mode.SERVER, null, null));
+
+        String request = "GET /amqp HTTP/1.1\r\n" +
+                         "Host: example.com\r\n" +
+                         "Upgrade: websocket\r\n" +
+                         "Connection: keep-alive, Upgrade\r\n" +
+                         "Sec-WebSocket-Key: " + RFC_SAMPLE_KEY + "\r\n" +
+                         "Sec-WebSocket-Protocol: amqp\r\n" +
+                         "Sec-WebSocket-Version: 13\r\n\r\n";
+
+        ByteBuffer input = ByteBuffer.allocate(256);
+        input.put(request.getBytes(StandardCharsets.US_ASCII));
+
+        // A masked ping carrying "hi"
+        int maskKey = 0x11223344;
+        input.put((byte) 0x89).put((byte) 0x82).putInt(maskKey);
+        input.put((byte) ('h' ^ 0x11)).put((byte) ('i' ^ 0x22));
+        input.flip();
+
+        server.processInput(input).checkIsOk();
+
+        String output = readOutput(server);
+        assertTrue(output, output.startsWith("HTTP/1.1 101 Switching Protocols\r\n"));
+        assertTrue(output, output.contains("Sec-WebSocket-Accept: " + RFC_SAMPLE_ACCEPT + "\r\n"));
+        assertTrue(output, output.contains("Sec-WebSocket-Protocol: amqp\r\n"));
+
+        String pong = new String(new char[] { (char) 0x8A, (char) 0x02, 'h', 'i' });
+        assertTrue("Expected an unmasked pong", output.contains(pong));
+    }
+
+    @Test
+    public void testServerRejectsRequestWithoutAmqpSubprotocol()
+    {
+        TransportImpl server = new TransportImpl();
+        server.addTransportLayer(new WebSocketImpl(WebSocketImpl.Mode.SERVER, null, null));
+
+        String request = "GET / HTTP/1.1\r\n" +
+                         "Host: example.com\r\n" +
+                         "Upgrade: websocket\r\n" +
+                         "Connection: Upgrade\r\n" +
+                         "Sec-WebSocket-Key: " + RFC_SAMPLE_KEY + "\r\n" +
+                         "Sec-WebSocket-Version: 13\r\n\r\n";
+
+        assertFalse(server.processInput(ByteBuffer.wrap(request.getBytes(StandardCharsets.US_ASCII))).isOk());
+    }
+
+    @Test
+    public void testSmallAndLargeMessagesOverWebSocket()
+    {
+        byte[] small = new byte[100];
+        byte[] large = new byte[200 * 1024];
+        Random random = new Random(11);
+        random.nextBytes(small);
+        random.nextBytes(large);
+
+        doTransferTestImpl(small, large);
+    }
+
+    private void doTransferTestImpl(byte[]... payloads)
+    {
+        TransportImpl clientTransport = new TransportImpl();
+        clientTransport.addTransportLayer(new WebSocketImpl(WebSocketImpl.Mode.CLIENT, "localhost:5672", "/"));
+        TransportImpl serverTransport = new TransportImpl();
+        serverTransport.addTransportLayer(new WebSocketImpl(WebSocketImpl.Mode.SERVER, null, null));
+
+        Connection clientConnection = Connection.Factory.create();
+        Connection serverConnection = Connection.Factory.create();
+        clientTransport.bind(clientConnection);
+        serverTransport.bind(serverConnection);
+
+        clientConnection.open();
+        Session clientSession = clientConnection.session();
+        clientSession.open();
+        Sender sender = clientSession.sender("sender");
+        sender.open();
+
+        pump(clientTransport, serverTransport);
+
+        serverConnection.open();
+        Session serverSession = serverConnection.sessionHead(EnumSet.of(EndpointState.UNINITIALIZED), EnumSet.of(EndpointState.ACTIVE));
+        assertNotNull(serverSession);
+        serverSession.open();
+        Receiver receiver = (Receiver) serverConnection.linkHead(EnumSet.of(EndpointState.UNINITIALIZED), EnumSet.of(EndpointState.ACTIVE));
+        assertNotNull(receiver);
+        receiver.open();
+        receiver.flow(payloads.length);
+
+        pump(clientTransport, serverTransport);
+
+        assertEquals(payloads.length, sender.getCredit());
+
+        for (int i = 0; i < payloads.length; i++)
+        {
+            sender.delivery(new byte[] { (byte) i });
+            sender.send(payloads[i], 0, payloads[i].length);
+            sender.advance();
+        }
+
+        pump(clientTransport, serverTransport);
+
+        for (byte[] payload : payloads)
+        {
+            Delivery delivery = receiver.current();
+            assertNotNull(delivery);
+            assertFalse(delivery.isPartial());
+
+            byte[] received = new byte[delivery.pending()];
+            assertEquals(received.length, receiver.recv(received, 0, received.length));
+            assertArrayEquals(payload, received);
+            receiver.advance();
+        }
+
+        clientConnection.close();
+        serverConnection.close();
+        pump(clientTransport, serverTransport);
+
+        assertEquals(EndpointState.CLOSED, clientConnection.getRemoteState());
+        assertEquals(EndpointState.CLOSED, serverConnection.getRemoteState());
+    }
+
+    private String readOutput(Transport transport)
+    {
+        StringBuilder output = new StringBuilder();
+        while (transport.pending() > 0)
+        {
+            ByteBuffer head = transport.head();
+            while (head.hasRemaining())
+            {
+                output.append((char) (head.get() & 0xFF));
+            }
+            transport.outputConsumed();
+        }
+        return output.toString();
+    }
+
+    private void pump(Transport clientTransport, Transport serverTransport)
+    {
+        boolean moved;
+        do
+        {
+            moved = pump(clientTransport.getOutputBuffer(), clientTransport, serverTransport);
+            moved |= pump(serverTransport.getOutputBuffer(), serverTransport, clientTransport);
+        }
+        while (moved);
+    }
+
+    private boolean pump(ByteBuffer output, Transport from, Transport to)
+    {
+        boolean moved = output.hasRemaining();
+        if (moved)
+        {
+            to.processInput(output).checkIsOk();
+        }
+
+        from.outputConsumed();
+        return moved;
+    }
+}
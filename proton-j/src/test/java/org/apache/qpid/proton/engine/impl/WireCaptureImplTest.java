@@ -0,0 +1,243 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+package org.apache.qpid.proton.engine.impl;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assert.fail;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.List;
+
+import org.apache.qpid.proton.engine.Connection;
+import org.apache.qpid.proton.engine.Transport;
+import org.junit.Test;
+import org.mockito.Mockito;
+
+public class WireCaptureImplTest
+{
+    @Test
+    public void testCaptureRecordsBothDirections() throws IOException
+    {
+        ByteArrayOutputStream capture = new ByteArrayOutputStream();
+        WireCaptureImpl wireCapture = new WireCaptureImpl(capture);
+
+        TransportImpl clientTransport = new TransportImpl();
+        clientTransport.addTransportLayer(wireCapture);
+        TransportImpl serverTransport = new TransportImpl();
+
+        Connection clientConnection = Connection.Factory.create();
+        Connection serverConnection = Connection.Factory.create();
+        clientTransport.bind(clientConnection);
+        serverTransport.bind(serverConnection);
+
+        ByteArrayOutputStream clientSent = new ByteArrayOutputStream();
+        ByteArrayOutputStream clientReceived = new ByteArrayOutputStream();
+
+        clientConnection.open();
+        serverConnection.open();
+        pump(clientTransport, serverTransport, clientSent, clientReceived);
+
+        clientConnection.close();
+        serverConnection.close();
+        pump(clientTransport, serverTransport, clientSent, clientReceived);
+
+        wireCapture.close();
+
+        List<WireCaptureImpl.Chunk> chunks = WireCaptureImpl.read(new ByteArrayInputStream(capture.toByteArray()));
+
+        ByteArrayOutputStream input = new ByteArrayOutputStream();
+        ByteArrayOutputStream output = new ByteArrayOutputStream();
+        long lastTimestamp = 0;
+        for (WireCaptureImpl.Chunk chunk : chunks)
+        {
+            assertTrue("Timestamps should not go backwards", chunk.getTimestamp() >= lastTimestamp);
+            lastTimestamp = chunk.getTimestamp();
+
+            if (chunk.getDirection() == WireCaptureImpl.Direction.INPUT)
+            {
+                input.write(chunk.getData());
+            }
+            else if (chunk.getDirection() == WireCaptureImpl.Direction.OUTPUT)
+            {
+                output.write(chunk.getData());
+            }
+        }
+
+        assertTrue(clientSent.size() > 0);
+        assertTrue(clientReceived.size() > 0);
+        assertArrayEquals(clientSent.toByteArray(), output.toByteArray());
+        assertArrayEquals(clientReceived.toByteArray(), input.toByteArray());
+    }
+
+    @Test
+    public void testCaptureRecordsInputPouredThroughTail() throws IOException
+    {
+        ByteArrayOutputStream capture = new ByteArrayOutputStream();
+        WireCaptureImpl wireCapture = new WireCaptureImpl(capture);
+
+        TransportImpl transport = new TransportImpl();
+        transport.addTransportLayer(wireCapture);
+
+        byte[] header = AmqpHeader.HEADER;
+        transport.getInputBuffer().put(header, 0, 3);
+        transport.processInput().checkIsOk();
+        transport.getInputBuffer().put(header, 3, header.length - 3);
+        transport.processInput().checkIsOk();
+
+        wireCapture.close();
+
+        List<WireCaptureImpl.Chunk> chunks = WireCaptureImpl.read(new ByteArrayInputStream(capture.toByteArray()));
+        assertEquals(2, chunks.size());
+        assertArrayEquals(new byte[] { 'A', 'M', 'Q' }, chunks.get(0).getData());
+        assertArrayEquals(new byte[] { 'P', 0, 1, 0, 0 }, chunks.get(1).getData());
+    }
+
+    @Test
+    public void testCaptureRecordsInputWrittenWithoutCallingTailAgain() throws IOException
+    {
+        ByteArrayOutputStream capture = new ByteArrayOutputStream();
+        WireCaptureImpl wireCapture = new WireCaptureImpl(capture);
+
+        TransportImpl transport = new TransportImpl();
+        transport.addTransportLayer(wireCapture);
+
+        byte[] header = AmqpHeader.HEADER;
+        ByteBuffer tail = transport.tail();
+        tail.put(header, 0, 3);
+        transport.process();
+        tail.put(header, 3, header.length - 3);
+        transport.process();
+
+        wireCapture.close();
+
+        List<WireCaptureImpl.Chunk> chunks = WireCaptureImpl.read(new ByteArrayInputStream(capture.toByteArray()));
+        assertEquals(2, chunks.size());
+        assertArrayEquals(new byte[] { 'A', 'M', 'Q' }, chunks.get(0).getData());
+        assertArrayEquals(new byte[] { 'P', 0, 1, 0, 0 }, chunks.get(1).getData());
+    }
+
+    @Test
+    public void testPopRecordsFromLastHeadWithoutProducingOutput() throws IOException
+    {
+        ByteArrayOutputStream capture = new ByteArrayOutputStream();
+        WireCaptureImpl wireCapture = new WireCaptureImpl(capture);
+
+        // Produces another byte of output each time it is asked for its head
+        final ByteBuffer buffer = ByteBuffer.allocate(16);
+        final int[] heads = new int[1];
+        TransportOutput output = new TransportOutput()
+        {
+            @Override
+            public int pending()
+            {
+                return buffer.position();
+            }
+
+            @Override
+            public ByteBuffer head()
+            {
+                buffer.put((byte) ++heads[0]);
+                ByteBuffer head = buffer.duplicate();
+                head.flip();
+                return head;
+            }
+
+            @Override
+            public void pop(int bytes)
+            {
+                buffer.flip();
+                buffer.position(bytes);
+                buffer.compact();
+            }
+
+            @Override
+            public void close_head()
+            {
+            }
+        };
+        TransportWrapper wrapper = wireCapture.wrap(Mockito.mock(TransportInput.class), output);
+
+        for (int i = 0; i < 2; i++)
+        {
+            // As a socket write would, consume the head before popping it
+            ByteBuffer head = wrapper.head();
+            head.get();
+            wrapper.pop(1);
+        }
+        assertEquals(2, heads[0]);
+
+        wireCapture.close();
+
+        List<WireCaptureImpl.Chunk> chunks = WireCaptureImpl.read(new ByteArrayInputStream(capture.toByteArray()));
+        assertEquals(2, chunks.size());
+        assertArrayEquals(new byte[] { 1 }, chunks.get(0).getData());
+        assertArrayEquals(new byte[] { 2 }, chunks.get(1).getData());
+    }
+
+    @Test
+    public void testReadRejectsOtherContent()
+    {
+        try
+        {
+            WireCaptureImpl.read(new ByteArrayInputStream(new byte[] { 'A', 'M', 'Q', 'P' }));
+            fail("Expected the content to be rejected");
+        }
+        catch (IOException e)
+        {
+            // Expected
+        }
+    }
+
+    private void pump(Transport clientTransport, Transport serverTransport,
+                      ByteArrayOutputStream clientSent, ByteArrayOutputStream clientReceived)
+    {
+        boolean moved;
+        do
+        {
+            moved = pump(clientTransport, serverTransport, clientSent);
+            moved |= pump(serverTransport, clientTransport, clientReceived);
+        }
+        while (moved);
+    }
+
+    private boolean pump(Transport from, Transport to, ByteArrayOutputStream record)
+    {
+        ByteBuffer output = from.getOutputBuffer();
+        boolean moved = output.hasRemaining();
+        if (moved)
+        {
+            int start = output.position();
+            byte[] bytes = new byte[output.remaining()];
+            output.duplicate().get(bytes);
+
+            to.processInput(output).checkIsOk();
+            record.write(bytes, 0, output.position() - start);
+        }
+
+        from.outputConsumed();
+        return moved;
+    }
+}
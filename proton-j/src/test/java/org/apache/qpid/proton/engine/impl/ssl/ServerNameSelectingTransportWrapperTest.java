@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine.impl.ssl;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+
+import java.nio.ByteBuffer;
+
+import javax.net.ssl.SSLContext;
+import javax.net.ssl.SSLEngine;
+
+import org.junit.Test;
+
+public class ServerNameSelectingTransportWrapperTest
+{
+    @Test
+    public void testReadServerNameFromClientHello() throws Exception
+    {
+        ByteBuffer clientHello = clientHello("tenant.example.com");
+
+        assertEquals("tenant.example.com", ServerNameSelectingTransportWrapper.readServerName(clientHello));
+        assertEquals("The record should not be consumed", 0, clientHello.position());
+    }
+
+    @Test
+    public void testReadServerNameWithoutServerName() throws Exception
+    {
+        assertNull(ServerNameSelectingTransportWrapper.readServerName(clientHello(null)));
+    }
+
+    @Test
+    public void testReadServerNameFromTruncatedRecord() throws Exception
+    {
+        ByteBuffer clientHello = clientHello("tenant.example.com");
+        for (int length = 0; length < clientHello.limit(); length += 7)
+        {
+            ByteBuffer truncated = clientHello.duplicate();
+            truncated.limit(length);
+
+            // The name is only found if the truncation falls after it
+            String serverName = ServerNameSelectingTransportWrapper.readServerName(truncated);
+            assertTrue(serverName == null || serverName.equals("tenant.example.com"));
+        }
+    }
+
+    @Test
+    public void testServerNameMappingMatchesExactNamesBeforeWildcards() throws Exception
+    {
+        SSLContext wildcard = SSLContext.getInstance("TLS");
+        SSLContext exact = SSLContext.getInstance("TLS");
+
+        SslServerNameMappingImpl mapping = new SslServerNameMappingImpl();
+        mapping.setContext("*.Example.com", wildcard);
+        mapping.setContext("tenant2.example.com", exact);
+
+        assertEquals(wildcard, mapping.getContext("tenant1.example.com"));
+        assertEquals(exact, mapping.getContext("TENANT2.example.com."));
+        assertNull(mapping.getContext("example.com"));
+        assertNull(mapping.getContext("a.tenant1.example.com"));
+        assertNull(mapping.getContext(null));
+
+        mapping.setContext("*.example.com", null);
+        assertNull(mapping.getContext("tenant1.example.com"));
+    }
+
+    private ByteBuffer clientHello(String serverName) throws Exception
+    {
+        SSLContext context = SSLContext.getInstance("TLS");
+        context.init(null, null, null);
+
+        SSLEngine engine = serverName == null ? context.createSSLEngine() : context.createSSLEngine(serverName, 5671);
+        engine.setUseClientMode(true);
+
+        ByteBuffer record = ByteBuffer.allocate(engine.getSession().getPacketBufferSize());
+        engine.wrap(ByteBuffer.allocate(0), record);
+        record.flip();
+        return record;
+    }
+}
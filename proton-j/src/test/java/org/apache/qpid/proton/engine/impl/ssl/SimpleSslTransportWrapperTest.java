@@ -30,6 +30,8 @@ import static org.junit.Assert.fail;
 
 import java.nio.ByteBuffer;
 import java.nio.charset.StandardCharsets;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
 
 import javax.net.ssl.SSLException;
 
@@ -434,6 +436,92 @@ public class SimpleSslTransportWrapperTest
         assertFalse(_sslWrapper.head().hasRemaining());
     }
 
+    @Test
+    public void testPipelinedInputDecodesPacketsInOrder()
+    {
+        ExecutorService executor = Executors.newSingleThreadExecutor();
+        try
+        {
+            _sslWrapper = new SimpleSslTransportWrapper(_dummySslEngine, _underlyingInput, _underlyingOutput, executor);
+
+            StringBuilder encoded = new StringBuilder();
+            StringBuilder decoded = new StringBuilder();
+            for (int i = 0; i < 200; i++)
+            {
+                char c = (char) ('a' + (i % 26));
+                if (c == 'z')
+                {
+                    encoded.append("<>");
+                }
+                else
+                {
+                    encoded.append("<-").append(Character.toUpperCase(c)).append("->");
+                }
+                decoded.append(c).append('_');
+            }
+
+            // Feed in uneven pieces so that batches end part way through packets
+            String encodedBytes = encoded.toString();
+            for (int start = 0; start < encodedBytes.length(); start += 7)
+            {
+                putBytesIntoTransport(encodedBytes.substring(start, Math.min(encodedBytes.length(), start + 7)));
+            }
+
+            assertEquals(decoded.toString(), _underlyingInput.getAcceptedInput());
+        }
+        finally
+        {
+            executor.shutdownNow();
+        }
+    }
+
+    @Test
+    public void testPipelinedInputFailureRefusesFurtherInput()
+    {
+        ExecutorService executor = Executors.newSingleThreadExecutor();
+        try
+        {
+            _sslWrapper = new SimpleSslTransportWrapper(_dummySslEngine, _underlyingInput, _underlyingOutput, executor);
+            _dummySslEngine.rejectNextEncodedPacket(new SSLException("unwrap exception"));
+
+            _sslWrapper.tail().put("<-A-><-B->".getBytes(StandardCharsets.UTF_8));
+            _sslWrapper.process();
+
+            assertEquals(Transport.END_OF_STREAM, _sslWrapper.capacity());
+            assertEquals("", _underlyingInput.getAcceptedInput());
+        }
+        finally
+        {
+            executor.shutdownNow();
+        }
+    }
+
+    @Test
+    public void testPipelinedOutputEncodesPacketsInOrder()
+    {
+        ExecutorService executor = Executors.newSingleThreadExecutor();
+        try
+        {
+            _sslWrapper = new SimpleSslTransportWrapper(_dummySslEngine, _underlyingInput, _underlyingOutput, executor);
+
+            StringBuilder clear = new StringBuilder();
+            StringBuilder encoded = new StringBuilder();
+            for (int i = 0; i < 200; i++)
+            {
+                char c = (char) ('a' + (i % 25));
+                clear.append(c).append('_');
+                encoded.append("<-").append(Character.toUpperCase(c)).append("->");
+            }
+            _underlyingOutput.setOutput(clear.toString());
+
+            assertEquals(encoded.toString(), getAllBytesFromTransport());
+        }
+        finally
+        {
+            executor.shutdownNow();
+        }
+    }
+
     private void putBytesIntoTransport(String encodedBytes)
     {
         ByteBuffer byteBuffer = ByteBuffer.wrap(encodedBytes.getBytes(StandardCharsets.UTF_8));
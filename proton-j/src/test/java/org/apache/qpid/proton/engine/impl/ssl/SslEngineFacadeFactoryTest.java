@@ -31,11 +31,10 @@ public class SslEngineFacadeFactoryTest {
 
     @Test
     public void testDuplicateRegistrationOfSecurityProvider() {
-        // ensure the provider is already registered
-        SslEngineFacadeFactory factory = new SslEngineFacadeFactory();
-
         try
         {
+            // ensure the provider is already registered
+            SslEngineFacadeFactory.registerBouncyCastleProvider();
             SslEngineFacadeFactory.registerBouncyCastleProvider();
         }
         catch (Exception e)
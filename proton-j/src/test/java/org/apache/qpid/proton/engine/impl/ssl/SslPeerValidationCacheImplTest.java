@@ -0,0 +1,225 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.engine.impl.ssl;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.fail;
+
+import java.io.InputStream;
+import java.security.cert.CertificateException;
+import java.security.cert.CertificateFactory;
+import java.security.cert.X509Certificate;
+
+import javax.net.ssl.TrustManager;
+import javax.net.ssl.X509TrustManager;
+
+import org.junit.Before;
+import org.junit.Test;
+
+public class SslPeerValidationCacheImplTest
+{
+    private static final String AUTH_TYPE = "RSA";
+
+    private X509Certificate _client;
+    private X509Certificate _ca;
+    private CountingTrustManager _delegate;
+
+    @Before
+    public void setUp() throws Exception
+    {
+        _client = readCertificate("/client.crt");
+        _ca = readCertificate("/ca.crt");
+        _delegate = new CountingTrustManager();
+    }
+
+    @Test
+    public void testRepeatedValidationIsAnsweredFromCache() throws Exception
+    {
+        SslPeerValidationCacheImpl cache = new SslPeerValidationCacheImpl(16, 60000);
+        X509TrustManager trustManager = wrap(cache);
+
+        trustManager.checkClientTrusted(new X509Certificate[] { _client, _ca }, AUTH_TYPE);
+        trustManager.checkClientTrusted(new X509Certificate[] { _client, _ca }, AUTH_TYPE);
+
+        assertEquals(1, _delegate.checks);
+        assertEquals(1, cache.getMisses());
+        assertEquals(1, cache.getHits());
+        assertEquals(1, cache.size());
+
+        // The same chain presented by a server is validated separately
+        trustManager.checkServerTrusted(new X509Certificate[] { _client, _ca }, AUTH_TYPE);
+        assertEquals(2, _delegate.checks);
+    }
+
+    @Test
+    public void testFailedValidationIsNotCached() throws Exception
+    {
+        SslPeerValidationCacheImpl cache = new SslPeerValidationCacheImpl(16, 60000);
+        X509TrustManager trustManager = wrap(cache);
+        _delegate.reject = true;
+
+        for (int i = 0; i < 2; i++)
+        {
+            try
+            {
+                trustManager.checkClientTrusted(new X509Certificate[] { _client, _ca }, AUTH_TYPE);
+                fail("Expected the chain to be rejected");
+            }
+            catch (CertificateException e)
+            {
+                // Expected
+            }
+        }
+
+        assertEquals(2, _delegate.checks);
+        assertEquals(0, cache.size());
+    }
+
+    @Test
+    public void testValidationIsNotSharedBetweenTrustManagers() throws Exception
+    {
+        SslPeerValidationCacheImpl cache = new SslPeerValidationCacheImpl(16, 60000);
+        X509TrustManager trustManager = wrap(cache);
+
+        CountingTrustManager otherDelegate = new CountingTrustManager();
+        otherDelegate.reject = true;
+        X509TrustManager otherTrustManager = (X509TrustManager) cache.wrap(new TrustManager[] { otherDelegate })[0];
+
+        trustManager.checkClientTrusted(new X509Certificate[] { _client, _ca }, AUTH_TYPE);
+        try
+        {
+            otherTrustManager.checkClientTrusted(new X509Certificate[] { _client, _ca }, AUTH_TYPE);
+            fail("Expected the chain to be rejected");
+        }
+        catch (CertificateException e)
+        {
+            // Expected
+        }
+
+        assertEquals(1, otherDelegate.checks);
+        assertEquals(0, cache.getHits());
+    }
+
+    @Test
+    public void testValidationExpiresAfterTimeToLive() throws Exception
+    {
+        final long[] now = { System.currentTimeMillis() };
+        SslPeerValidationCacheImpl cache = new SslPeerValidationCacheImpl(16, 1000)
+        {
+            @Override
+            long currentTimeMillis()
+            {
+                return now[0];
+            }
+        };
+        X509TrustManager trustManager = wrap(cache);
+
+        trustManager.checkClientTrusted(new X509Certificate[] { _client, _ca }, AUTH_TYPE);
+        now[0] += 999;
+        trustManager.checkClientTrusted(new X509Certificate[] { _client, _ca }, AUTH_TYPE);
+        assertEquals(1, _delegate.checks);
+
+        now[0] += 1;
+        trustManager.checkClientTrusted(new X509Certificate[] { _client, _ca }, AUTH_TYPE);
+        assertEquals(2, _delegate.checks);
+    }
+
+    @Test
+    public void testInvalidateDropsChainsHoldingCertificate() throws Exception
+    {
+        SslPeerValidationCacheImpl cache = new SslPeerValidationCacheImpl(16, 60000);
+        X509TrustManager trustManager = wrap(cache);
+
+        trustManager.checkClientTrusted(new X509Certificate[] { _client, _ca }, AUTH_TYPE);
+        trustManager.checkClientTrusted(new X509Certificate[] { _ca }, AUTH_TYPE);
+        assertEquals(2, cache.size());
+
+        cache.invalidate(_client);
+        assertEquals(1, cache.size());
+
+        trustManager.checkClientTrusted(new X509Certificate[] { _client, _ca }, AUTH_TYPE);
+        assertEquals(3, _delegate.checks);
+
+        cache.invalidateAll();
+        assertEquals(0, cache.size());
+    }
+
+    @Test
+    public void testLeastRecentlyUsedChainIsEvicted() throws Exception
+    {
+        SslPeerValidationCacheImpl cache = new SslPeerValidationCacheImpl(1, 60000);
+        X509TrustManager trustManager = wrap(cache);
+
+        trustManager.checkClientTrusted(new X509Certificate[] { _client, _ca }, AUTH_TYPE);
+        trustManager.checkClientTrusted(new X509Certificate[] { _ca }, AUTH_TYPE);
+
+        assertEquals(1, cache.size());
+        assertEquals(1, cache.getEvictions());
+
+        trustManager.checkClientTrusted(new X509Certificate[] { _client, _ca }, AUTH_TYPE);
+        assertEquals(3, _delegate.checks);
+    }
+
+    private X509TrustManager wrap(SslPeerValidationCacheImpl cache)
+    {
+        TrustManager[] wrapped = cache.wrap(new TrustManager[] { _delegate });
+        return (X509TrustManager) wrapped[0];
+    }
+
+    private X509Certificate readCertificate(String resource) throws Exception
+    {
+        try (InputStream in = getClass().getResourceAsStream(resource))
+        {
+            return (X509Certificate) CertificateFactory.getInstance("X.509").generateCertificate(in);
+        }
+    }
+
+    private static final class CountingTrustManager implements X509TrustManager
+    {
+        private int checks;
+        private boolean reject;
+
+        @Override
+        public void checkClientTrusted(X509Certificate[] chain, String authType) throws CertificateException
+        {
+            check();
+        }
+
+        @Override
+        public void checkServerTrusted(X509Certificate[] chain, String authType) throws CertificateException
+        {
+            check();
+        }
+
+        @Override
+        public X509Certificate[] getAcceptedIssuers()
+        {
+            return new X509Certificate[0];
+        }
+
+        private void check() throws CertificateException
+        {
+            checks++;
+            if (reject)
+            {
+                throw new CertificateException("Rejected");
+            }
+        }
+    }
+}
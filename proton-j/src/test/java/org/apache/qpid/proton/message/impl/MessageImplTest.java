@@ -22,11 +22,18 @@ package org.apache.qpid.proton.message.impl;
 
 import static org.junit.Assert.assertArrayEquals;
 import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.fail;
 
 import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.List;
 
 import org.apache.qpid.proton.amqp.Binary;
+import org.apache.qpid.proton.amqp.messaging.AmqpValue;
 import org.apache.qpid.proton.amqp.messaging.Data;
+import org.apache.qpid.proton.amqp.messaging.Properties;
+import org.apache.qpid.proton.codec.DecodeException;
+import org.apache.qpid.proton.codec.ReadableBuffer;
 import org.apache.qpid.proton.codec.WritableBuffer;
 import org.apache.qpid.proton.codec.WritableBuffer.ByteBufferWrapper;
 import org.apache.qpid.proton.message.Message;
@@ -92,6 +99,84 @@ public class MessageImplTest
         assertEquals("Encoded length different than expected length", encodedLength, encodedBytes.position());
     }
 
+    @Test
+    public void testEncodeDecodeBatch()
+    {
+        List<Message> batch = new ArrayList<Message>();
+        for (int i = 0; i < 10; i++)
+        {
+            Message msg = Message.Factory.create();
+            Properties properties = new Properties();
+            properties.setMessageId("message-" + i);
+            msg.setProperties(properties);
+            msg.setBody(new AmqpValue(i % 2 == 0 ? "body-" + i : new Binary(generateByteArray(300 * i))));
+            batch.add(msg);
+        }
+
+        ByteBufferWrapper buffer = WritableBuffer.ByteBufferWrapper.allocate(16 * 1024);
+        int encodedLength = MessageImpl.encodeBatch(batch, buffer);
+        assertEquals("Encoded length different than buffer position", buffer.position(), encodedLength);
+
+        ByteBuffer encoded = buffer.byteBuffer();
+        encoded.flip();
+        List<Message> decoded = MessageImpl.decodeBatch(ReadableBuffer.ByteBufferReader.wrap(encoded));
+
+        assertEquals("Unexpected batch size", batch.size(), decoded.size());
+        assertEquals("Batch not fully consumed", 0, encoded.remaining());
+        for (int i = 0; i < batch.size(); i++)
+        {
+            assertEquals(batch.get(i).getMessageId(), decoded.get(i).getMessageId());
+            assertEquals(((AmqpValue) batch.get(i).getBody()).getValue(), ((AmqpValue) decoded.get(i).getBody()).getValue());
+        }
+    }
+
+    @Test
+    public void testDecodeBatchOfStandardEncodedDataSections()
+    {
+        ByteBufferWrapper buffer = WritableBuffer.ByteBufferWrapper.allocate(1024);
+        for (int i = 0; i < 3; i++)
+        {
+            Message inner = Message.Factory.create();
+            inner.setBody(new AmqpValue("inner-" + i));
+            byte[] encodedInner = new byte[256];
+            int length = inner.encode(encodedInner, 0, encodedInner.length);
+
+            // A message with only a Data body section is just that section when encoded
+            Message section = Message.Factory.create();
+            section.setBody(new Data(new Binary(encodedInner, 0, length)));
+            section.encode(buffer);
+        }
+
+        ByteBuffer encoded = buffer.byteBuffer();
+        encoded.flip();
+        List<Message> decoded = MessageImpl.decodeBatch(encoded.array(), 0, encoded.limit());
+
+        assertEquals("Unexpected batch size", 3, decoded.size());
+        for (int i = 0; i < 3; i++)
+        {
+            assertEquals("inner-" + i, ((AmqpValue) decoded.get(i).getBody()).getValue());
+        }
+    }
+
+    @Test
+    public void testDecodeBatchRejectsNonDataSections()
+    {
+        Message msg = Message.Factory.create();
+        msg.setBody(new AmqpValue("not-a-batch"));
+        byte[] encoded = new byte[64];
+        int length = msg.encode(encoded, 0, encoded.length);
+
+        try
+        {
+            MessageImpl.decodeBatch(encoded, 0, length);
+            fail("Expected a DecodeException");
+        }
+        catch (DecodeException e)
+        {
+            // Expected
+        }
+    }
+
     private byte[] generateByteArray(int bytesLength)
     {
         byte[] bytes = new byte[bytesLength];
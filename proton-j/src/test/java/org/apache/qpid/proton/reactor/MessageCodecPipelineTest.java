@@ -0,0 +1,262 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+package org.apache.qpid.proton.reactor;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNotNull;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.EnumSet;
+import java.util.List;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.TimeUnit;
+
+import org.apache.qpid.proton.Proton;
+import org.apache.qpid.proton.amqp.messaging.AmqpValue;
+import org.apache.qpid.proton.engine.BaseHandler;
+import org.apache.qpid.proton.engine.Collector;
+import org.apache.qpid.proton.engine.Connection;
+import org.apache.qpid.proton.engine.Delivery;
+import org.apache.qpid.proton.engine.EndpointState;
+import org.apache.qpid.proton.engine.Event;
+import org.apache.qpid.proton.engine.Receiver;
+import org.apache.qpid.proton.engine.Sender;
+import org.apache.qpid.proton.engine.Session;
+import org.apache.qpid.proton.engine.Transport;
+import org.apache.qpid.proton.message.Message;
+import org.apache.qpid.proton.reactor.impl.AcceptorImpl;
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+public class MessageCodecPipelineTest {
+
+    private static final int MESSAGE_COUNT = 500;
+
+    private ExecutorService executor;
+
+    private final Connection clientConnection = Proton.connection();
+    private final Transport clientTransport = Proton.transport();
+    private final Connection serverConnection = Proton.connection();
+    private final Transport serverTransport = Proton.transport();
+    private final Collector serverCollector = Proton.collector();
+
+    private static class RecordingPipeline extends MessageCodecPipeline {
+        private final List<Object> received = new ArrayList<Object>();
+        private int sent;
+
+        RecordingPipeline(ExecutorService executor) {
+            super(executor);
+        }
+
+        RecordingPipeline(ExecutorService executor, Reactor reactor) {
+            super(executor, reactor);
+        }
+
+        @Override
+        protected void onMessage(Receiver receiver, Delivery delivery, Message message) {
+            received.add(((AmqpValue) message.getBody()).getValue());
+            delivery.settle();
+        }
+
+        @Override
+        protected void onMessageSent(Sender sender, Delivery delivery, Message message) {
+            assertNotNull(delivery);
+            delivery.settle();
+            sent++;
+        }
+    }
+
+    @Before
+    public void setUp() {
+        executor = Executors.newFixedThreadPool(4);
+
+        clientTransport.bind(clientConnection);
+        serverTransport.bind(serverConnection);
+        serverConnection.collect(serverCollector);
+    }
+
+    @After
+    public void tearDown() throws InterruptedException {
+        executor.shutdownNow();
+        executor.awaitTermination(10, TimeUnit.SECONDS);
+    }
+
+    @Test
+    public void testMessagesAreEncodedAndDecodedInLinkOrder() throws InterruptedException {
+        clientConnection.open();
+        Session clientSession = clientConnection.session();
+        clientSession.open();
+        Sender sender = clientSession.sender("sender");
+        sender.open();
+
+        pump();
+
+        serverConnection.open();
+        Session serverSession = serverConnection.sessionHead(EnumSet.of(EndpointState.UNINITIALIZED), EnumSet.of(EndpointState.ACTIVE));
+        serverSession.open();
+        Receiver receiver = (Receiver) serverConnection.linkHead(EnumSet.of(EndpointState.UNINITIALIZED), EnumSet.of(EndpointState.ACTIVE));
+        receiver.open();
+        receiver.flow(MESSAGE_COUNT);
+
+        pump();
+
+        RecordingPipeline clientPipeline = new RecordingPipeline(executor);
+        for (int i = 0; i < MESSAGE_COUNT; ++i) {
+            Message message = Proton.message();
+            message.setBody(new AmqpValue("message-" + i));
+            clientPipeline.send(sender, String.valueOf(i).getBytes(), message);
+        }
+
+        long deadline = System.currentTimeMillis() + 10000;
+        while (clientPipeline.sent < MESSAGE_COUNT && System.currentTimeMillis() < deadline) {
+            clientPipeline.dispatchCompleted();
+            Thread.sleep(1);
+        }
+
+        assertEquals(MESSAGE_COUNT, clientPipeline.sent);
+
+        pump();
+
+        RecordingPipeline serverPipeline = new RecordingPipeline(executor);
+
+        Event event;
+        while ((event = serverCollector.peek()) != null) {
+            event.dispatch(serverPipeline);
+            serverCollector.pop();
+        }
+
+        while (serverPipeline.received.size() < MESSAGE_COUNT && System.currentTimeMillis() < deadline) {
+            serverPipeline.dispatchCompleted();
+            Thread.sleep(1);
+        }
+
+        assertEquals(MESSAGE_COUNT, serverPipeline.received.size());
+        for (int i = 0; i < MESSAGE_COUNT; ++i) {
+            assertEquals("message-" + i, serverPipeline.received.get(i));
+        }
+    }
+
+    @Test
+    public void testReactorDispatchesLastResultsWithoutFurtherEvents() throws IOException {
+        final int count = 10;
+        final Reactor reactor = Proton.reactor();
+        final Acceptor[] acceptor = new Acceptor[1];
+
+        // Stops the reactor should the last decoded message never be dispatched
+        final Task guard = reactor.schedule(10000, new BaseHandler() {
+            @Override
+            public void onTimerTask(Event event) {
+                event.getReactor().stop();
+            }
+        });
+
+        // Installed only on the server connection, so it sees no events once the
+        // last transfer has arrived until it settles the messages it is handed
+        final RecordingPipeline serverPipeline = new RecordingPipeline(executor, reactor) {
+            @Override
+            protected void onMessage(Receiver receiver, Delivery delivery, Message message) {
+                super.onMessage(receiver, delivery, message);
+                if (received.size() == count) {
+                    guard.cancel();
+                    acceptor[0].close();
+                    receiver.getSession().getConnection().close();
+                }
+            }
+
+            @Override
+            public void onConnectionRemoteClose(Event event) {
+                event.getConnection().free();
+            }
+        };
+        serverPipeline.add(new Handshaker());
+        serverPipeline.add(new FlowController(64));
+        acceptor[0] = reactor.acceptor("127.0.0.1", 0, serverPipeline);
+
+        reactor.connectionToHost("127.0.0.1", ((AcceptorImpl) acceptor[0]).getPortNumber(), new BaseHandler() {
+            private int sent;
+
+            @Override
+            public void onConnectionInit(Event event) {
+                Connection connection = event.getConnection();
+                Session session = connection.session();
+                connection.open();
+                session.open();
+                session.sender("sender").open();
+            }
+
+            @Override
+            public void onLinkFlow(Event event) {
+                Sender sender = (Sender) event.getLink();
+                while (sender.getCredit() > 0 && sent < count) {
+                    Message message = Proton.message();
+                    message.setBody(new AmqpValue("message-" + sent));
+                    byte[] encoded = new byte[1024];
+                    int length = message.encode(encoded, 0, encoded.length);
+
+                    Delivery delivery = sender.delivery(String.valueOf(sent++).getBytes());
+                    sender.send(encoded, 0, length);
+                    sender.advance();
+                    delivery.settle();
+                }
+            }
+
+            @Override
+            public void onConnectionRemoteClose(Event event) {
+                event.getConnection().close();
+                event.getConnection().free();
+            }
+        });
+
+        reactor.run();
+        reactor.free();
+
+        assertEquals(count, serverPipeline.received.size());
+        for (int i = 0; i < count; ++i) {
+            assertEquals("message-" + i, serverPipeline.received.get(i));
+        }
+    }
+
+    private void pump() {
+        boolean moved;
+        do {
+            moved = pump(clientTransport, serverTransport);
+            moved |= pump(serverTransport, clientTransport);
+        } while (moved);
+    }
+
+    private boolean pump(Transport from, Transport to) {
+        ByteBuffer output = from.getOutputBuffer();
+        boolean moved = output.hasRemaining();
+
+        if (moved) {
+            to.processInput(output).checkIsOk();
+        }
+
+        from.outputConsumed();
+
+        return moved;
+    }
+}
@@ -0,0 +1,174 @@
+/*
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+package org.apache.qpid.proton.reactor.impl;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertTrue;
+
+import java.io.IOException;
+
+import org.apache.qpid.proton.engine.BaseHandler;
+import org.apache.qpid.proton.engine.Connection;
+import org.apache.qpid.proton.engine.Delivery;
+import org.apache.qpid.proton.engine.Event;
+import org.apache.qpid.proton.engine.Sender;
+import org.apache.qpid.proton.engine.Session;
+import org.apache.qpid.proton.reactor.Acceptor;
+import org.apache.qpid.proton.reactor.FlowController;
+import org.apache.qpid.proton.reactor.Handshaker;
+import org.junit.Test;
+
+public class OutputCoalescerTest {
+
+    private static final int COUNT = 1024;
+    private static final int WINDOW = 64;
+
+    // Allowance for the reactor getting round to a timer after it expires
+    private static final long TIMER_SLACK = 1000;
+
+    /**
+     * Tests that with a threshold that is never reached, all output is held
+     * back and then written by the timer no later than the delay after it
+     * was first held.
+     */
+    @Test
+    public void outputIsWrittenAfterDelay() throws IOException {
+        int delay = 20;
+        OutputCoalescer coalescer = transfer(1024 * 1024, delay);
+
+        assertTrue("Output was never held back", coalescer.getFlushes() > 0);
+        assertEquals("Output was written before the delay",
+                     coalescer.getFlushes(), coalescer.getTimerFlushes());
+        assertTrue("Output was held back for " + coalescer.getMaxHeld() + "ms",
+                   coalescer.getMaxHeld() >= delay && coalescer.getMaxHeld() <= delay + TIMER_SLACK);
+    }
+
+    /**
+     * Tests that output is written as soon as the threshold is reached, in
+     * far fewer writes than there are messages.
+     */
+    @Test
+    public void outputIsWrittenAtThreshold() throws IOException {
+        OutputCoalescer coalescer = transfer(256, 10);
+
+        assertTrue("Output was never written at the threshold",
+                   coalescer.getFlushes() > coalescer.getTimerFlushes());
+        assertTrue("Output was written " + coalescer.getFlushes() + " times for " + COUNT + " messages",
+                   coalescer.getFlushes() <= COUNT / 4);
+    }
+
+    private OutputCoalescer transfer(final int bytes, final int delay) throws IOException {
+        LeakTestReactor reactor = new LeakTestReactor();
+        ServerHandler sh = new ServerHandler();
+        Acceptor acceptor = reactor.acceptor("127.0.0.1", 0, sh);
+        sh.acceptor = acceptor;
+        sh.add(new Handshaker());
+        sh.add(new FlowController(WINDOW));
+        SinkHandler snk = new SinkHandler();
+        sh.add(snk);
+
+        SourceHandler src = new SourceHandler(bytes, delay);
+        reactor.connectionToHost("127.0.0.1", ((AcceptorImpl)acceptor).getPortNumber(), src);
+        reactor.run();
+        reactor.free();
+
+        assertEquals("Did not receive the expected number of messages", COUNT, snk.received);
+        reactor.assertNoLeaks();
+        assertNotNull(src.coalescer);
+        return src.coalescer;
+    }
+
+    private static class ServerHandler extends BaseHandler {
+        private Acceptor acceptor;
+
+        @Override
+        public void onConnectionRemoteOpen(Event event) {
+            event.getConnection().open();
+        }
+
+        @Override
+        public void onConnectionRemoteClose(Event event) {
+            acceptor.close();
+            event.getConnection().close();
+            event.getConnection().free();
+        }
+    }
+
+    private static class SinkHandler extends BaseHandler {
+        private int received;
+
+        @Override
+        public void onDelivery(Event event) {
+            Delivery dlv = event.getDelivery();
+            if (!dlv.isPartial()) {
+                dlv.settle();
+                ++received;
+            }
+        }
+    }
+
+    private static class SourceHandler extends BaseHandler {
+        private final int bytes;
+        private final int delay;
+        private int remaining = COUNT;
+        private OutputCoalescer coalescer;
+
+        private SourceHandler(int bytes, int delay) {
+            this.bytes = bytes;
+            this.delay = delay;
+        }
+
+        @Override
+        public void onConnectionInit(Event event) {
+            Connection conn = event.getConnection();
+            event.getReactor().setConnectionOutputCoalescing(conn, bytes, delay);
+            coalescer = conn.attachments().get(ReactorImpl.CONNECTION_OUTPUT_COALESCER_KEY, OutputCoalescer.class);
+
+            Session ssn = conn.session();
+            Sender snd = ssn.sender("sender");
+            conn.open();
+            ssn.open();
+            snd.open();
+        }
+
+        @Override
+        public void onLinkFlow(Event event) {
+            Sender link = (Sender)event.getLink();
+            while (link.getCredit() > 0 && remaining > 0) {
+                Delivery dlv = link.delivery(new byte[0]);
+                dlv.settle();
+                link.advance();
+                --remaining;
+            }
+
+            if (remaining == 0) {
+                event.getConnection().close();
+            }
+        }
+
+        @Override
+        public void onConnectionRemoteClose(Event event) {
+            event.getConnection().free();
+        }
+    }
+}
@@ -0,0 +1,301 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.systemtests;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertTrue;
+import static org.junit.Assume.assumeTrue;
+
+import java.lang.management.ManagementFactory;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+import java.util.EnumSet;
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+import org.apache.qpid.proton.Proton;
+import org.apache.qpid.proton.amqp.messaging.Accepted;
+import org.apache.qpid.proton.amqp.messaging.AmqpValue;
+import org.apache.qpid.proton.amqp.messaging.ApplicationProperties;
+import org.apache.qpid.proton.amqp.messaging.Header;
+import org.apache.qpid.proton.amqp.messaging.Properties;
+import org.apache.qpid.proton.engine.Connection;
+import org.apache.qpid.proton.engine.Delivery;
+import org.apache.qpid.proton.engine.EndpointState;
+import org.apache.qpid.proton.engine.Receiver;
+import org.apache.qpid.proton.engine.Sender;
+import org.apache.qpid.proton.engine.Session;
+import org.apache.qpid.proton.engine.Transport;
+import org.apache.qpid.proton.message.Message;
+import org.junit.Before;
+import org.junit.Test;
+
+/**
+ * Asserts upper bounds on the bytes allocated per message on the steady state send, receive,
+ * settle and codec paths, measured with the per-thread allocation counter.
+ *
+ * Each path is warmed up, then measured over several rounds with the lowest per-message figure
+ * compared against its budget, so that JIT compilation part way through a round cannot fail the
+ * test. The budgets leave headroom over the figures seen on current JVMs; a path starting to
+ * allocate a buffer or collection per message will exceed them. Lower a budget when a path is
+ * made to allocate less, so that it stays that way.
+ */
+public class AllocationBudgetTest
+{
+    private static final int WARMUP_ROUNDS = 50;
+    private static final int MEASURED_ROUNDS = 10;
+    private static final int MESSAGES_PER_ROUND = 200;
+    private static final int PAYLOAD_SIZE = 64;
+
+    private static final long SEND_BUDGET = 4096;
+    private static final long RECEIVE_BUDGET = 512;
+    private static final long SETTLE_BUDGET = 2048;
+    private static final long ENCODE_BUDGET = 1024;
+    private static final long DECODE_BUDGET = 4096;
+
+    private com.sun.management.ThreadMXBean threads;
+
+    @Before
+    public void setUp()
+    {
+        java.lang.management.ThreadMXBean threadMXBean = ManagementFactory.getThreadMXBean();
+        assumeTrue("Thread allocation counting is not available", threadMXBean instanceof com.sun.management.ThreadMXBean);
+
+        threads = (com.sun.management.ThreadMXBean) threadMXBean;
+        assumeTrue("Thread allocation counting is not supported", threads.isThreadAllocatedMemorySupported());
+        if (!threads.isThreadAllocatedMemoryEnabled())
+        {
+            threads.setThreadAllocatedMemoryEnabled(true);
+        }
+    }
+
+    @Test
+    public void testSendReceiveAndSettleAllocationBudgets()
+    {
+        Endpoints endpoints = new Endpoints();
+
+        for (int i = 0; i < WARMUP_ROUNDS; ++i)
+        {
+            endpoints.round();
+        }
+
+        long send = Long.MAX_VALUE;
+        long receive = Long.MAX_VALUE;
+        long settle = Long.MAX_VALUE;
+        for (int i = 0; i < MEASURED_ROUNDS; ++i)
+        {
+            long start = allocatedBytes();
+            endpoints.send();
+            long sent = allocatedBytes();
+            endpoints.receive();
+            long received = allocatedBytes();
+            endpoints.settle();
+            long settled = allocatedBytes();
+
+            send = Math.min(send, (sent - start) / MESSAGES_PER_ROUND);
+            receive = Math.min(receive, (received - sent) / MESSAGES_PER_ROUND);
+            settle = Math.min(settle, (settled - received) / MESSAGES_PER_ROUND);
+        }
+
+        assertWithinBudget("send", send, SEND_BUDGET);
+        assertWithinBudget("receive", receive, RECEIVE_BUDGET);
+        assertWithinBudget("settle", settle, SETTLE_BUDGET);
+    }
+
+    @Test
+    public void testMessageCodecAllocationBudgets()
+    {
+        Message message = Proton.message();
+        message.setHeader(new Header());
+        message.getHeader().setDurable(true);
+        Properties properties = new Properties();
+        properties.setMessageId("message-id");
+        properties.setTo("queue://allocations");
+        message.setProperties(properties);
+        Map<String, Object> applicationProperties = new LinkedHashMap<>();
+        applicationProperties.put("key1", "value1");
+        applicationProperties.put("key2", 42);
+        applicationProperties.put("key3", true);
+        message.setApplicationProperties(new ApplicationProperties(applicationProperties));
+        message.setBody(new AmqpValue("a small message body"));
+
+        byte[] encoded = new byte[1024];
+        int length = message.encode(encoded, 0, encoded.length);
+
+        for (int i = 0; i < WARMUP_ROUNDS * MESSAGES_PER_ROUND; ++i)
+        {
+            message.encode(encoded, 0, encoded.length);
+            Proton.message().decode(encoded, 0, length);
+        }
+
+        long encode = Long.MAX_VALUE;
+        long decode = Long.MAX_VALUE;
+        for (int i = 0; i < MEASURED_ROUNDS; ++i)
+        {
+            long start = allocatedBytes();
+            for (int j = 0; j < MESSAGES_PER_ROUND; ++j)
+            {
+                message.encode(encoded, 0, encoded.length);
+            }
+            long afterEncode = allocatedBytes();
+            for (int j = 0; j < MESSAGES_PER_ROUND; ++j)
+            {
+                Proton.message().decode(encoded, 0, length);
+            }
+            long decoded = allocatedBytes();
+
+            encode = Math.min(encode, (afterEncode - start) / MESSAGES_PER_ROUND);
+            decode = Math.min(decode, (decoded - afterEncode) / MESSAGES_PER_ROUND);
+        }
+
+        assertWithinBudget("encode", encode, ENCODE_BUDGET);
+        assertWithinBudget("decode", decode, DECODE_BUDGET);
+    }
+
+    private long allocatedBytes()
+    {
+        return threads.getThreadAllocatedBytes(Thread.currentThread().getId());
+    }
+
+    private static void assertWithinBudget(String path, long bytesPerMessage, long budget)
+    {
+        assertTrue("The " + path + " path allocated " + bytesPerMessage + " bytes per message, over its budget of " + budget,
+                   bytesPerMessage <= budget);
+    }
+
+    private static final class Endpoints
+    {
+        private final Transport clientTransport = Proton.transport();
+        private final Transport serverTransport = Proton.transport();
+        private final Sender sender;
+        private final Receiver receiver;
+        private final byte[][] tags = new byte[MESSAGES_PER_ROUND][];
+        private final Delivery[] sent = new Delivery[MESSAGES_PER_ROUND];
+        private final Delivery[] received = new Delivery[MESSAGES_PER_ROUND];
+        private final byte[] payload = new byte[PAYLOAD_SIZE];
+        private final byte[] scratch = new byte[PAYLOAD_SIZE];
+
+        Endpoints()
+        {
+            for (int i = 0; i < MESSAGES_PER_ROUND; ++i)
+            {
+                tags[i] = ("tag" + i).getBytes(StandardCharsets.UTF_8);
+            }
+
+            Connection clientConnection = Proton.connection();
+            Connection serverConnection = Proton.connection();
+            clientTransport.bind(clientConnection);
+            serverTransport.bind(serverConnection);
+
+            clientConnection.open();
+            Session session = clientConnection.session();
+            session.open();
+            sender = session.sender("allocations");
+            sender.open();
+
+            pump();
+
+            serverConnection.open();
+            serverConnection.sessionHead(EnumSet.of(EndpointState.UNINITIALIZED), EnumSet.of(EndpointState.ACTIVE)).open();
+            receiver = (Receiver) serverConnection.linkHead(EnumSet.of(EndpointState.UNINITIALIZED), EnumSet.of(EndpointState.ACTIVE));
+            assertNotNull(receiver);
+            receiver.open();
+            receiver.flow(MESSAGES_PER_ROUND);
+
+            pump();
+        }
+
+        void round()
+        {
+            send();
+            receive();
+            settle();
+        }
+
+        void send()
+        {
+            for (int i = 0; i < MESSAGES_PER_ROUND; ++i)
+            {
+                sent[i] = sender.delivery(tags[i]);
+                sender.send(payload, 0, payload.length);
+                sender.advance();
+            }
+
+            pump();
+        }
+
+        void receive()
+        {
+            for (int i = 0; i < MESSAGES_PER_ROUND; ++i)
+            {
+                Delivery delivery = receiver.current();
+                assertNotNull(delivery);
+                assertEquals(PAYLOAD_SIZE, receiver.recv(scratch, 0, scratch.length));
+                receiver.advance();
+                received[i] = delivery;
+            }
+        }
+
+        void settle()
+        {
+            for (int i = 0; i < MESSAGES_PER_ROUND; ++i)
+            {
+                received[i].disposition(Accepted.getInstance());
+                received[i].settle();
+                received[i] = null;
+            }
+            receiver.flow(MESSAGES_PER_ROUND);
+
+            pump();
+
+            for (int i = 0; i < MESSAGES_PER_ROUND; ++i)
+            {
+                sent[i].settle();
+                sent[i] = null;
+            }
+
+            pump();
+        }
+
+        private void pump()
+        {
+            boolean moved;
+            do
+            {
+                moved = pump(clientTransport, serverTransport);
+                moved |= pump(serverTransport, clientTransport);
+            }
+            while (moved);
+        }
+
+        private static boolean pump(Transport from, Transport to)
+        {
+            ByteBuffer output = from.getOutputBuffer();
+            boolean moved = output.hasRemaining();
+            if (moved)
+            {
+                to.processInput(output).checkIsOk();
+            }
+
+            from.outputConsumed();
+            return moved;
+        }
+    }
+}
@@ -0,0 +1,216 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.systemtests;
+
+import static java.util.EnumSet.of;
+import static org.apache.qpid.proton.engine.EndpointState.ACTIVE;
+import static org.apache.qpid.proton.engine.EndpointState.UNINITIALIZED;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertSame;
+import static org.junit.Assert.assertTrue;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import org.apache.qpid.proton.Proton;
+import org.apache.qpid.proton.amqp.messaging.Accepted;
+import org.apache.qpid.proton.engine.Collector;
+import org.apache.qpid.proton.engine.Connection;
+import org.apache.qpid.proton.engine.Delivery;
+import org.apache.qpid.proton.engine.EngineListener;
+import org.apache.qpid.proton.engine.Event;
+import org.apache.qpid.proton.engine.Link;
+import org.apache.qpid.proton.engine.ProtonJConnection;
+import org.apache.qpid.proton.engine.Receiver;
+import org.apache.qpid.proton.engine.Sender;
+import org.apache.qpid.proton.engine.Session;
+import org.junit.Test;
+
+public class EngineListenerTest extends EngineTestBase
+{
+    @Test
+    public void testListenerIsToldOfChangesInsteadOfCollector() throws Exception
+    {
+        RecordingListener listener = new RecordingListener();
+        Collector collector = Collector.Factory.create();
+
+        getClient().transport = Proton.transport();
+        getServer().transport = Proton.transport();
+
+        getClient().connection = Proton.connection();
+        ((ProtonJConnection) getClient().connection).setEngineListener(listener);
+        getClient().connection.collect(collector);
+        getClient().transport.bind(getClient().connection);
+
+        getServer().connection = Proton.connection();
+        getServer().transport.bind(getServer().connection);
+
+        getClient().connection.open();
+        getServer().connection.open();
+        doOutputInputCycle();
+
+        assertTrue(listener.connectionEvents.contains(Event.Type.CONNECTION_REMOTE_OPEN));
+
+        getClient().session = getClient().connection.session();
+        getClient().session.open();
+        pumpClientToServer();
+        getServer().session = getServer().connection.sessionHead(of(UNINITIALIZED), of(ACTIVE));
+        getServer().session.open();
+        pumpServerToClient();
+
+        assertTrue(listener.sessionEvents.contains(Event.Type.SESSION_REMOTE_OPEN));
+
+        getClient().receiver = getClient().session.receiver("link1");
+        getClient().receiver.open();
+        getClient().receiver.flow(1);
+        pumpClientToServer();
+        getServer().sender = (Sender) getServer().connection.linkHead(of(UNINITIALIZED), of(ACTIVE));
+        getServer().sender.open();
+        pumpServerToClient();
+
+        assertTrue(listener.linkEvents.contains(Event.Type.LINK_REMOTE_OPEN));
+
+        byte[] payload = new byte[] { 1, 2, 3, 4, 5 };
+        getServer().sender.delivery(new byte[] { 0 });
+        getServer().sender.send(payload, 0, payload.length);
+        getServer().sender.advance();
+        pumpServerToClient();
+
+        assertEquals(1, listener.transfers.size());
+        Delivery clientDelivery = listener.transfers.get(0);
+        assertSame(getClient().receiver, clientDelivery.getLink());
+        assertEquals(payload.length, listener.lastAvailable);
+        assertFalse(listener.lastPartial);
+
+        assertTrue(listener.connectionEvents.contains(Event.Type.CONNECTION_INIT));
+        assertNull("Events should not have been collected", collector.peek());
+    }
+
+    @Test
+    public void testFlowAndDispositionCarryTheirState() throws Exception
+    {
+        RecordingListener listener = new RecordingListener();
+
+        getClient().transport = Proton.transport();
+        getServer().transport = Proton.transport();
+
+        getClient().connection = Proton.connection();
+        ((ProtonJConnection) getClient().connection).setEngineListener(listener);
+        getClient().transport.bind(getClient().connection);
+
+        getServer().connection = Proton.connection();
+        getServer().transport.bind(getServer().connection);
+
+        getClient().connection.open();
+        getServer().connection.open();
+        doOutputInputCycle();
+
+        getClient().session = getClient().connection.session();
+        getClient().session.open();
+        pumpClientToServer();
+        getServer().session = getServer().connection.sessionHead(of(UNINITIALIZED), of(ACTIVE));
+        getServer().session.open();
+        pumpServerToClient();
+
+        getClient().sender = getClient().session.sender("link1");
+        getClient().sender.open();
+        pumpClientToServer();
+        getServer().receiver = (Receiver) getServer().connection.linkHead(of(UNINITIALIZED), of(ACTIVE));
+        getServer().receiver.open();
+        getServer().receiver.flow(3);
+        pumpServerToClient();
+
+        assertSame(getClient().sender, listener.lastFlowLink);
+        assertEquals(3, listener.lastCredit);
+
+        byte[] payload = new byte[] { 1, 2, 3 };
+        Delivery clientDelivery = getClient().sender.delivery(new byte[] { 0 });
+        getClient().sender.send(payload, 0, payload.length);
+        getClient().sender.advance();
+        pumpClientToServer();
+
+        assertEquals("Sending should have reduced the credit", 2, listener.lastCredit);
+
+        Delivery serverDelivery = getServer().receiver.current();
+        serverDelivery.disposition(Accepted.getInstance());
+        serverDelivery.settle();
+        pumpServerToClient();
+
+        assertEquals(1, listener.dispositions.size());
+        assertSame(clientDelivery, listener.dispositions.get(0));
+        assertTrue(listener.lastRemotelySettled);
+        assertEquals(Accepted.getInstance(), clientDelivery.getRemoteState());
+    }
+
+    private static final class RecordingListener implements EngineListener
+    {
+        private final List<Event.Type> connectionEvents = new ArrayList<>();
+        private final List<Event.Type> sessionEvents = new ArrayList<>();
+        private final List<Event.Type> linkEvents = new ArrayList<>();
+        private final List<Delivery> transfers = new ArrayList<>();
+        private final List<Delivery> dispositions = new ArrayList<>();
+        private int lastAvailable;
+        private boolean lastPartial;
+        private boolean lastRemotelySettled;
+        private Link lastFlowLink;
+        private int lastCredit;
+
+        @Override
+        public void onTransfer(Receiver receiver, Delivery delivery, int available, boolean partial)
+        {
+            transfers.add(delivery);
+            lastAvailable = available;
+            lastPartial = partial;
+        }
+
+        @Override
+        public void onDisposition(Delivery delivery, boolean remotelySettled)
+        {
+            dispositions.add(delivery);
+            lastRemotelySettled = remotelySettled;
+        }
+
+        @Override
+        public void onFlow(Link link, int credit)
+        {
+            lastFlowLink = link;
+            lastCredit = credit;
+        }
+
+        @Override
+        public void onConnection(Event.Type type, Connection connection)
+        {
+            connectionEvents.add(type);
+        }
+
+        @Override
+        public void onSession(Event.Type type, Session session)
+        {
+            sessionEvents.add(type);
+        }
+
+        @Override
+        public void onLink(Event.Type type, Link link)
+        {
+            linkEvents.add(type);
+        }
+    }
+}
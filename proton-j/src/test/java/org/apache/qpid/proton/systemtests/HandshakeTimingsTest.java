@@ -0,0 +1,170 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.systemtests;
+
+import static java.util.EnumSet.of;
+import static org.apache.qpid.proton.engine.EndpointState.ACTIVE;
+import static org.apache.qpid.proton.engine.EndpointState.UNINITIALIZED;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertTrue;
+
+import org.apache.qpid.proton.Proton;
+import org.apache.qpid.proton.engine.HandshakeTimings;
+import org.apache.qpid.proton.engine.HandshakeTimings.Phase;
+import org.apache.qpid.proton.engine.HandshakeTimingsRecorder;
+import org.apache.qpid.proton.engine.Sasl;
+import org.apache.qpid.proton.engine.Sender;
+import org.junit.Test;
+
+public class HandshakeTimingsTest extends EngineTestBase
+{
+    @Test
+    public void testPhasesAreTimedInOrder() throws Exception
+    {
+        HandshakeTimingsRecorder recorder = HandshakeTimingsRecorder.Factory.create();
+
+        getClient().transport = Proton.transport();
+        getClient().transport.setHandshakeTimingsRecorder(recorder);
+        getServer().transport = Proton.transport();
+        getServer().transport.setHandshakeTimingsRecorder(recorder);
+
+        getClient().transport.socketConnected();
+        getServer().transport.socketConnected();
+
+        Sasl clientSasl = getClient().transport.sasl();
+        clientSasl.client();
+        Sasl serverSasl = getServer().transport.sasl();
+        serverSasl.server();
+        serverSasl.setMechanisms("ANONYMOUS");
+
+        pumpClientToServer();
+        pumpServerToClient();
+        clientSasl.setMechanisms("ANONYMOUS");
+        pumpClientToServer();
+        serverSasl.done(Sasl.SaslOutcome.PN_SASL_OK);
+        pumpServerToClient();
+
+        HandshakeTimings clientTimings = getClient().transport.getHandshakeTimings();
+        assertTrue(clientTimings.getNanos(Phase.SASL_OUTCOME) >= clientTimings.getNanos(Phase.SOCKET_CONNECTED));
+        assertEquals(-1, clientTimings.getNanos(Phase.OPEN_SENT));
+
+        getClient().connection = Proton.connection();
+        getClient().transport.bind(getClient().connection);
+        getServer().connection = Proton.connection();
+        getServer().transport.bind(getServer().connection);
+
+        getClient().connection.open();
+        getServer().connection.open();
+        doOutputInputCycle();
+
+        getClient().session = getClient().connection.session();
+        getClient().session.open();
+        pumpClientToServer();
+        getServer().session = getServer().connection.sessionHead(of(UNINITIALIZED), of(ACTIVE));
+        getServer().session.open();
+        pumpServerToClient();
+
+        getClient().receiver = getClient().session.receiver("link1");
+        getClient().receiver.open();
+        pumpClientToServer();
+        assertEquals(-1, clientTimings.getNanos(Phase.FIRST_ATTACH_ACTIVE));
+
+        getServer().sender = (Sender) getServer().connection.linkHead(of(UNINITIALIZED), of(ACTIVE));
+        getServer().sender.open();
+        pumpServerToClient();
+
+        HandshakeTimings serverTimings = getServer().transport.getHandshakeTimings();
+        for (HandshakeTimings timings : new HandshakeTimings[] { clientTimings, serverTimings })
+        {
+            assertEquals("No TLS was used", -1, timings.getNanos(Phase.TLS_FINISHED));
+            assertEquals(-1, timings.getElapsedNanos(Phase.TLS_FINISHED));
+            assertTrue(timings.getElapsedNanos(Phase.SOCKET_CONNECTED) >= 0);
+            assertTrue(timings.getNanos(Phase.OPEN_SENT) >= timings.getNanos(Phase.SASL_OUTCOME));
+            assertTrue(timings.getNanos(Phase.OPEN_RECEIVED) >= timings.getNanos(Phase.SASL_OUTCOME));
+            assertTrue(timings.getNanos(Phase.FIRST_ATTACH_ACTIVE) >= timings.getNanos(Phase.OPEN_RECEIVED));
+        }
+
+        for (Phase phase : Phase.values())
+        {
+            assertEquals(phase == Phase.TLS_FINISHED ? 0 : 2, recorder.getCount(phase));
+        }
+        assertEquals(Math.max(clientTimings.getElapsedNanos(Phase.OPEN_SENT), serverTimings.getElapsedNanos(Phase.OPEN_SENT)),
+                     recorder.getMaxNanos(Phase.OPEN_SENT));
+    }
+
+    @Test
+    public void testPhaseIsOnlyTimedWhenFirstReached() throws Exception
+    {
+        HandshakeTimingsRecorder recorder = HandshakeTimingsRecorder.Factory.create();
+        getClient().transport = Proton.transport();
+        getClient().transport.setHandshakeTimingsRecorder(recorder);
+
+        getClient().transport.socketConnected();
+        long connected = getClient().transport.getHandshakeTimings().getNanos(Phase.SOCKET_CONNECTED);
+        getClient().transport.socketConnected();
+
+        assertEquals(connected, getClient().transport.getHandshakeTimings().getNanos(Phase.SOCKET_CONNECTED));
+        assertEquals(1, recorder.getCount(Phase.SOCKET_CONNECTED));
+    }
+
+    @Test
+    public void testPhasesReachedBeforeRecorderIsSetAreRecorded() throws Exception
+    {
+        getClient().transport = Proton.transport();
+        getClient().transport.socketConnected();
+
+        HandshakeTimingsRecorder recorder = HandshakeTimingsRecorder.Factory.create();
+        getClient().transport.setHandshakeTimingsRecorder(recorder);
+
+        HandshakeTimings timings = getClient().transport.getHandshakeTimings();
+        assertEquals(1, recorder.getCount(Phase.SOCKET_CONNECTED));
+        assertEquals(timings.getElapsedNanos(Phase.SOCKET_CONNECTED), recorder.getMaxNanos(Phase.SOCKET_CONNECTED));
+        assertEquals(0, recorder.getCount(Phase.OPEN_SENT));
+
+        // Setting the same recorder again does not record the phases twice
+        getClient().transport.setHandshakeTimingsRecorder(recorder);
+        assertEquals(1, recorder.getCount(Phase.SOCKET_CONNECTED));
+    }
+
+    @Test
+    public void testRecorderPercentiles() throws Exception
+    {
+        HandshakeTimingsRecorder recorder = HandshakeTimingsRecorder.Factory.create();
+        assertEquals(0, recorder.getPercentileNanos(Phase.OPEN_RECEIVED, 99));
+
+        for (int i = 0; i < 99; i++)
+        {
+            recorder.record(Phase.OPEN_RECEIVED, 1000);
+        }
+        recorder.record(Phase.OPEN_RECEIVED, 1000000);
+
+        assertEquals(100, recorder.getCount(Phase.OPEN_RECEIVED));
+        assertEquals(1000000, recorder.getMaxNanos(Phase.OPEN_RECEIVED));
+
+        // 1000ns falls in the bucket from 512 to 1023
+        assertEquals(1023, recorder.getPercentileNanos(Phase.OPEN_RECEIVED, 50));
+        assertEquals(1023, recorder.getPercentileNanos(Phase.OPEN_RECEIVED, 99));
+        assertEquals(1000000, recorder.getPercentileNanos(Phase.OPEN_RECEIVED, 100));
+        assertEquals(99, recorder.getBucketCounts(Phase.OPEN_RECEIVED)[10]);
+
+        recorder.reset();
+        assertEquals(0, recorder.getCount(Phase.OPEN_RECEIVED));
+        assertEquals(0, recorder.getMaxNanos(Phase.OPEN_RECEIVED));
+    }
+}
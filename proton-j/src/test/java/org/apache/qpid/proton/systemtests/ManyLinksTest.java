@@ -0,0 +1,166 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+package org.apache.qpid.proton.systemtests;
+
+import static java.util.EnumSet.of;
+import static org.apache.qpid.proton.engine.EndpointState.ACTIVE;
+import static org.apache.qpid.proton.engine.EndpointState.CLOSED;
+import static org.apache.qpid.proton.engine.EndpointState.UNINITIALIZED;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNull;
+
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.List;
+
+import org.apache.qpid.proton.Proton;
+import org.apache.qpid.proton.engine.Connection;
+import org.apache.qpid.proton.engine.Link;
+import org.apache.qpid.proton.engine.Receiver;
+import org.apache.qpid.proton.engine.Session;
+import org.apache.qpid.proton.engine.Transport;
+import org.junit.Test;
+
+/**
+ * Opens and tears down enough links that work done per endpoint for each other endpoint, when
+ * allocating handles or ending sessions, would make the test time out. The links are spread over
+ * many sessions, as ending each session used to walk every endpoint of the connection.
+ */
+public class ManyLinksTest
+{
+    private static final int SESSIONS = 1000;
+    private static final int LINKS_PER_SESSION = 50;
+
+    @Test(timeout = 60000)
+    public void testOpenAndTearDownManyLinks() throws Exception
+    {
+        Transport clientTransport = Proton.transport();
+        Connection client = Proton.connection();
+        clientTransport.bind(client);
+
+        Transport serverTransport = Proton.transport();
+        Connection server = Proton.connection();
+        serverTransport.bind(server);
+
+        client.open();
+        List<Receiver> receivers = new ArrayList<>(SESSIONS * LINKS_PER_SESSION);
+        List<Session> sessions = new ArrayList<>(SESSIONS);
+        for (int i = 0; i < SESSIONS; i++)
+        {
+            Session session = client.session();
+            session.open();
+            sessions.add(session);
+            for (int j = 0; j < LINKS_PER_SESSION; j++)
+            {
+                Receiver receiver = session.receiver("link-" + i + "-" + j);
+                receiver.open();
+                receivers.add(receiver);
+            }
+        }
+        pump(clientTransport, serverTransport);
+
+        server.open();
+        openAll(server.sessionHead(of(UNINITIALIZED), of(ACTIVE)));
+        int opened = 0;
+        Link link = server.linkHead(of(UNINITIALIZED), of(ACTIVE));
+        while (link != null)
+        {
+            Link next = link.next(of(UNINITIALIZED), of(ACTIVE));
+            link.open();
+            opened++;
+            link = next;
+        }
+        assertEquals(SESSIONS * LINKS_PER_SESSION, opened);
+        pump(serverTransport, clientTransport);
+
+        for (Receiver receiver : receivers)
+        {
+            assertEquals(ACTIVE, receiver.getRemoteState());
+        }
+
+        // Tear everything down in one go
+        for (Receiver receiver : receivers)
+        {
+            receiver.close();
+        }
+        for (Session session : sessions)
+        {
+            session.close();
+        }
+        client.close();
+        pump(clientTransport, serverTransport);
+
+        assertEquals(CLOSED, server.getRemoteState());
+        link = server.linkHead(of(ACTIVE), of(CLOSED));
+        int closed = 0;
+        while (link != null)
+        {
+            Link next = link.next(of(ACTIVE), of(CLOSED));
+            link.close();
+            closed++;
+            link = next;
+        }
+        assertEquals(SESSIONS * LINKS_PER_SESSION, closed);
+
+        Session session = server.sessionHead(of(ACTIVE), of(CLOSED));
+        while (session != null)
+        {
+            Session next = session.next(of(ACTIVE), of(CLOSED));
+            session.close();
+            session = next;
+        }
+        server.close();
+        pump(serverTransport, clientTransport);
+
+        assertEquals(CLOSED, client.getRemoteState());
+        assertNull(client.linkHead(of(CLOSED), of(ACTIVE)));
+        assertNull(client.sessionHead(of(CLOSED), of(ACTIVE)));
+    }
+
+    private void openAll(Session session)
+    {
+        while (session != null)
+        {
+            Session next = session.next(of(UNINITIALIZED), of(ACTIVE));
+            session.open();
+            session = next;
+        }
+    }
+
+    /**
+     * Moves all the output of one transport to the other, in as many pieces as its input buffer needs.
+     */
+    private void pump(Transport from, Transport to)
+    {
+        int pending;
+        while ((pending = from.pending()) > 0)
+        {
+            ByteBuffer head = from.head();
+            ByteBuffer tail = to.tail();
+
+            int length = Math.min(pending, tail.remaining());
+            ByteBuffer chunk = head.duplicate();
+            chunk.limit(chunk.position() + length);
+            tail.put(chunk);
+
+            from.pop(length);
+            to.process();
+        }
+    }
+}
@@ -28,6 +28,7 @@ import java.io.FileInputStream;
 import java.io.InputStream;
 import java.security.KeyStore;
 import java.security.SecureRandom;
+import java.util.concurrent.TimeUnit;
 
 import javax.net.ssl.KeyManagerFactory;
 import javax.net.ssl.SSLContext;
@@ -38,10 +39,15 @@ import org.apache.qpid.proton.amqp.transport.ErrorCondition;
 import org.apache.qpid.proton.engine.Connection;
 import org.apache.qpid.proton.engine.Endpoint;
 import org.apache.qpid.proton.engine.EndpointState;
+import org.apache.qpid.proton.engine.ProtonJSslDomain;
 import org.apache.qpid.proton.engine.SslDomain;
 import org.apache.qpid.proton.engine.SslDomain.Mode;
 import org.apache.qpid.proton.engine.SslDomain.VerifyMode;
+import org.apache.qpid.proton.engine.SslPeerDetails;
+import org.apache.qpid.proton.engine.SslPeerValidationCache;
+import org.apache.qpid.proton.engine.SslServerNameMapping;
 import org.apache.qpid.proton.engine.Transport;
+import org.apache.qpid.proton.engine.TransportException;
 import org.junit.Test;
 
 public class SslTest
@@ -54,6 +60,8 @@ public class SslTest
 
     private static final String SERVER_2_JKS_KEYSTORE = "src/test/resources/server2-jks.keystore";
     private static final String CA_CERTS = "src/test/resources/ca-certs.crt";
+    private static final String CA_CERT = "src/test/resources/ca.crt";
+    private static final String CA_2_CERT = "src/test/resources/ca2.crt";
 
     private static final String SERVER_CONTAINER = "serverContainer";
     private static final String CLIENT_CONTAINER = "clientContainer";
@@ -242,4 +250,143 @@ public class SslTest
         assertConditions(clientTransport);
         assertConditions(serverTransport);
     }
+
+    @Test
+    public void testServerNameSelectsMappedSslContext() throws Exception
+    {
+        SSLContext serverSslContext = createSslContext(SERVER_JKS_KEYSTORE, PASSWORD, SERVER_JKS_TRUSTSTORE, PASSWORD);
+        SSLContext server2SslContext = createSslContext(SERVER_2_JKS_KEYSTORE, PASSWORD, SERVER_JKS_TRUSTSTORE, PASSWORD);
+
+        SslServerNameMapping mapping = SslServerNameMapping.Factory.create();
+        mapping.setContext("*.example.com", serverSslContext);
+        mapping.setContext("tenant2.example.com", server2SslContext);
+
+        ProtonJSslDomain serverSslDomain = (ProtonJSslDomain) SslDomain.Factory.create();
+        serverSslDomain.init(Mode.SERVER);
+        serverSslDomain.setSslContext(serverSslContext);
+        serverSslDomain.setServerNameMapping(mapping);
+
+        // Each client only trusts the CA that signed the certificate it should be presented with
+        doServerNameTestImpl(serverSslDomain, "tenant1.example.com", CA_CERT);
+        doServerNameTestImpl(serverSslDomain, "tenant2.example.com", CA_2_CERT);
+
+        // Replacing a context takes effect from the next handshake
+        mapping.setContext("tenant1.example.com", server2SslContext);
+        doServerNameTestImpl(serverSslDomain, "tenant1.example.com", CA_2_CERT);
+    }
+
+    @Test
+    public void testSslContextReplacedFromAnotherThreadIsUsed() throws Exception
+    {
+        SSLContext serverSslContext = createSslContext(SERVER_JKS_KEYSTORE, PASSWORD, SERVER_JKS_TRUSTSTORE, PASSWORD);
+        final SSLContext server2SslContext = createSslContext(SERVER_2_JKS_KEYSTORE, PASSWORD, SERVER_JKS_TRUSTSTORE, PASSWORD);
+
+        final SslDomain serverSslDomain = SslDomain.Factory.create();
+        serverSslDomain.init(Mode.SERVER);
+        serverSslDomain.setSslContext(serverSslContext);
+
+        doServerNameTestImpl(serverSslDomain, "localhost", CA_CERT);
+
+        // As a certificate reload would, replace the context while this thread keeps handshaking
+        Thread reloader = new Thread(new Runnable()
+        {
+            @Override
+            public void run()
+            {
+                serverSslDomain.setSslContext(server2SslContext);
+            }
+        });
+        reloader.start();
+        reloader.join();
+
+        doServerNameTestImpl(serverSslDomain, "localhost", CA_2_CERT);
+    }
+
+    @Test
+    public void testSharedPeerValidationCacheDoesNotTrustChainForOtherDomain() throws Exception
+    {
+        SslPeerValidationCache cache = SslPeerValidationCache.Factory.create(16, 1, TimeUnit.MINUTES);
+
+        SSLContext serverSslContext = createSslContext(SERVER_JKS_KEYSTORE, PASSWORD, SERVER_JKS_TRUSTSTORE, PASSWORD);
+        SslDomain serverSslDomain = SslDomain.Factory.create();
+        serverSslDomain.init(Mode.SERVER);
+        serverSslDomain.setSslContext(serverSslContext);
+
+        // The server's certificate is signed by the CA the first domain trusts, but not the second
+        assertEquals(ACTIVE, doPeerValidationCacheTestImpl(serverSslDomain, CA_CERT, cache));
+        assertEquals(1, cache.size());
+
+        assertEquals(UNINITIALIZED, doPeerValidationCacheTestImpl(serverSslDomain, CA_2_CERT, cache));
+        assertEquals(0, cache.getHits());
+    }
+
+    private EndpointState doPeerValidationCacheTestImpl(SslDomain serverSslDomain, String trustedCaDb,
+                                                        SslPeerValidationCache cache) throws Exception
+    {
+        Transport clientTransport = Proton.transport();
+        Transport serverTransport = Proton.transport();
+
+        TransportPumper pumper = new TransportPumper(clientTransport, serverTransport);
+
+        Connection clientConnection = Proton.connection();
+        Connection serverConnection = Proton.connection();
+
+        ProtonJSslDomain clientSslDomain = (ProtonJSslDomain) SslDomain.Factory.create();
+        clientSslDomain.init(Mode.CLIENT);
+        clientSslDomain.setPeerAuthentication(VerifyMode.VERIFY_PEER);
+        clientSslDomain.setTrustedCaDb(trustedCaDb);
+        clientSslDomain.setPeerValidationCache(cache);
+        clientTransport.ssl(clientSslDomain);
+
+        serverTransport.ssl(serverSslDomain);
+
+        clientTransport.bind(clientConnection);
+        serverTransport.bind(serverConnection);
+
+        clientConnection.open();
+        serverConnection.open();
+        try
+        {
+            pumper.pumpAll();
+        }
+        catch (TransportException e)
+        {
+            // A rejected handshake may surface as the transport refusing further input
+        }
+
+        return clientConnection.getRemoteState();
+    }
+
+    private void doServerNameTestImpl(SslDomain serverSslDomain, String serverName, String trustedCaDb) throws Exception
+    {
+        Transport clientTransport = Proton.transport();
+        Transport serverTransport = Proton.transport();
+
+        TransportPumper pumper = new TransportPumper(clientTransport, serverTransport);
+
+        Connection clientConnection = Proton.connection();
+        Connection serverConnection = Proton.connection();
+
+        SslDomain clientSslDomain = SslDomain.Factory.create();
+        clientSslDomain.init(Mode.CLIENT);
+        clientSslDomain.setPeerAuthentication(VerifyMode.VERIFY_PEER);
+        clientSslDomain.setTrustedCaDb(trustedCaDb);
+        clientTransport.ssl(clientSslDomain, SslPeerDetails.Factory.create(serverName, 5671));
+
+        serverTransport.ssl(serverSslDomain);
+
+        clientTransport.bind(clientConnection);
+        serverTransport.bind(serverConnection);
+
+        clientConnection.open();
+        pumper.pumpAll();
+        serverConnection.open();
+        pumper.pumpAll();
+
+        assertConditions(clientTransport);
+        assertConditions(serverTransport);
+
+        assertEndpointState(clientConnection, ACTIVE, ACTIVE);
+        assertEndpointState(serverConnection, ACTIVE, ACTIVE);
+    }
 }
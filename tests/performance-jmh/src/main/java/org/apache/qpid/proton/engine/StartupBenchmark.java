@@ -0,0 +1,142 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.qpid.proton.engine;
+
+import java.nio.ByteBuffer;
+import java.util.EnumSet;
+import java.util.concurrent.TimeUnit;
+
+import org.apache.qpid.proton.Proton;
+import org.apache.qpid.proton.amqp.messaging.AmqpValue;
+import org.apache.qpid.proton.message.Message;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Warmup;
+import org.openjdk.jmh.runner.Runner;
+import org.openjdk.jmh.runner.RunnerException;
+import org.openjdk.jmh.runner.options.Options;
+import org.openjdk.jmh.runner.options.OptionsBuilder;
+
+/**
+ * Measures the time from a cold JVM to the first message being sent over a pair of transports
+ * connected in memory: the SASL exchange, opening the connection, session and link, and
+ * encoding, transferring and decoding one message. Each fork measures a single operation, so the
+ * result is dominated by class loading, static initialisation and type registration, which is
+ * what short lived clients pay.
+ */
+@BenchmarkMode(Mode.SingleShotTime)
+@OutputTimeUnit(TimeUnit.MILLISECONDS)
+@Fork(20)
+@Warmup(iterations = 0)
+@Measurement(iterations = 1)
+public class StartupBenchmark
+{
+    @Benchmark
+    public Object firstMessageSent()
+    {
+        Transport clientTransport = Proton.transport();
+        Transport serverTransport = Proton.transport();
+
+        Sasl clientSasl = clientTransport.sasl();
+        clientSasl.client();
+        clientSasl.setMechanisms("ANONYMOUS");
+        Sasl serverSasl = serverTransport.sasl();
+        serverSasl.server();
+        serverSasl.setMechanisms("ANONYMOUS");
+
+        Connection clientConnection = Proton.connection();
+        Connection serverConnection = Proton.connection();
+        clientTransport.bind(clientConnection);
+        serverTransport.bind(serverConnection);
+
+        clientConnection.open();
+        Session session = clientConnection.session();
+        session.open();
+        Sender sender = session.sender("startup");
+        sender.open();
+
+        pump(clientTransport, serverTransport);
+        serverSasl.done(Sasl.SaslOutcome.PN_SASL_OK);
+        pump(clientTransport, serverTransport);
+
+        serverConnection.open();
+        serverConnection.sessionHead(EnumSet.of(EndpointState.UNINITIALIZED), EnumSet.of(EndpointState.ACTIVE)).open();
+        Receiver receiver = (Receiver) serverConnection.linkHead(EnumSet.of(EndpointState.UNINITIALIZED), EnumSet.of(EndpointState.ACTIVE));
+        receiver.open();
+        receiver.flow(1);
+
+        pump(clientTransport, serverTransport);
+
+        Message message = Proton.message();
+        message.setAddress("startup");
+        message.setBody(new AmqpValue("first message"));
+        byte[] encoded = new byte[256];
+        int length = message.encode(encoded, 0, encoded.length);
+
+        sender.delivery(new byte[] { 0 });
+        sender.send(encoded, 0, length);
+        sender.advance();
+
+        pump(clientTransport, serverTransport);
+
+        Delivery delivery = receiver.current();
+        byte[] received = new byte[delivery.pending()];
+        receiver.recv(received, 0, received.length);
+        receiver.advance();
+
+        Message decoded = Proton.message();
+        decoded.decode(received, 0, received.length);
+        return decoded.getBody();
+    }
+
+    private static void pump(Transport clientTransport, Transport serverTransport)
+    {
+        boolean moved;
+        do
+        {
+            moved = transfer(clientTransport, serverTransport);
+            moved |= transfer(serverTransport, clientTransport);
+        }
+        while (moved);
+    }
+
+    private static boolean transfer(Transport from, Transport to)
+    {
+        ByteBuffer output = from.getOutputBuffer();
+        boolean moved = output.hasRemaining();
+        if (moved)
+        {
+            to.processInput(output).checkIsOk();
+        }
+
+        from.outputConsumed();
+        return moved;
+    }
+
+    public static void main(String[] args) throws RunnerException
+    {
+        final Options opt = new OptionsBuilder()
+            .include(StartupBenchmark.class.getSimpleName())
+            .build();
+        new Runner(opt).run();
+    }
+}
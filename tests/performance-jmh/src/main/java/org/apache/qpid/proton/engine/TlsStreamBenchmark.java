@@ -0,0 +1,439 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.qpid.proton.engine;
+
+import java.io.FileInputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.net.InetAddress;
+import java.net.InetSocketAddress;
+import java.nio.channels.SelectionKey;
+import java.nio.channels.Selector;
+import java.nio.channels.ServerSocketChannel;
+import java.nio.channels.SocketChannel;
+import java.security.KeyStore;
+import java.util.EnumSet;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Semaphore;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import javax.net.ssl.KeyManagerFactory;
+import javax.net.ssl.SSLContext;
+import javax.net.ssl.TrustManagerFactory;
+
+import org.apache.qpid.proton.Proton;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+import org.openjdk.jmh.runner.Runner;
+import org.openjdk.jmh.runner.RunnerException;
+import org.openjdk.jmh.runner.options.Options;
+import org.openjdk.jmh.runner.options.OptionsBuilder;
+
+/**
+ * Measures the time taken to move a fixed amount of message data over each of 1-4 concurrent TLS
+ * connections on a loopback socket, with TLS records processed on the transport's own thread or
+ * pipelined onto a record processing executor.  Each end of each connection is driven by its own
+ * thread, so with enough cores the time per operation is flat for as long as throughput per
+ * connection scales.
+ *
+ * The key store used by both ends is given by the {@value #KEY_STORE_PROPERTY} system property, with
+ * its password in {@value #KEY_STORE_PASSWORD_PROPERTY}.  It must contain a key entry whose certificate
+ * is also trusted by the store, e.g. a self signed one made with keytool -genkeypair.
+ */
+@State(Scope.Benchmark)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MILLISECONDS)
+@Warmup(iterations = 5, time = 1)
+@Measurement(iterations = 5, time = 1)
+public class TlsStreamBenchmark
+{
+    public static final String KEY_STORE_PROPERTY = "proton.benchmark.keyStore";
+    public static final String KEY_STORE_PASSWORD_PROPERTY = "proton.benchmark.keyStorePassword";
+
+    private static final int PAYLOAD_SIZE = 64 * 1024;
+    private static final int MESSAGES_PER_STREAM = 256;
+    private static final int CREDIT = 64;
+
+    @Param({"1", "2", "3", "4"})
+    public int streams;
+
+    @Param({"false", "true"})
+    public boolean pipelined;
+
+    private SSLContext sslContext;
+    private ExecutorService recordExecutor;
+    private ExecutorService driverExecutor;
+    private ServerSocketChannel acceptor;
+    private Stream[] active;
+
+    @Setup(Level.Trial)
+    public void init() throws Exception
+    {
+        sslContext = createSslContext();
+        driverExecutor = Executors.newCachedThreadPool();
+        if (pipelined)
+        {
+            recordExecutor = Executors.newCachedThreadPool();
+        }
+
+        acceptor = ServerSocketChannel.open();
+        acceptor.bind(new InetSocketAddress(InetAddress.getLoopbackAddress(), 0));
+
+        active = new Stream[streams];
+        for (int i = 0; i < streams; ++i)
+        {
+            active[i] = new Stream();
+        }
+        for (Stream stream : active)
+        {
+            stream.awaitReady();
+        }
+    }
+
+    @TearDown(Level.Trial)
+    public void close() throws IOException
+    {
+        for (Stream stream : active)
+        {
+            stream.close();
+        }
+        acceptor.close();
+        driverExecutor.shutdownNow();
+        if (recordExecutor != null)
+        {
+            recordExecutor.shutdownNow();
+        }
+    }
+
+    @Benchmark
+    public long transfer() throws InterruptedException
+    {
+        for (Stream stream : active)
+        {
+            stream.client.request(MESSAGES_PER_STREAM);
+        }
+        for (Stream stream : active)
+        {
+            stream.server.received.acquire(MESSAGES_PER_STREAM);
+        }
+        return (long) streams * MESSAGES_PER_STREAM * PAYLOAD_SIZE;
+    }
+
+    private SSLContext createSslContext() throws Exception
+    {
+        String keyStoreFile = System.getProperty(KEY_STORE_PROPERTY);
+        if (keyStoreFile == null)
+        {
+            throw new IllegalStateException("A key store must be given using -D" + KEY_STORE_PROPERTY);
+        }
+
+        char[] password = System.getProperty(KEY_STORE_PASSWORD_PROPERTY, "").toCharArray();
+        KeyStore keyStore = KeyStore.getInstance(KeyStore.getDefaultType());
+        try (InputStream in = new FileInputStream(keyStoreFile))
+        {
+            keyStore.load(in, password);
+        }
+
+        KeyManagerFactory kmf = KeyManagerFactory.getInstance(KeyManagerFactory.getDefaultAlgorithm());
+        kmf.init(keyStore, password);
+        TrustManagerFactory tmf = TrustManagerFactory.getInstance(TrustManagerFactory.getDefaultAlgorithm());
+        tmf.init(keyStore);
+
+        SSLContext context = SSLContext.getInstance("TLS");
+        context.init(kmf.getKeyManagers(), tmf.getTrustManagers(), null);
+        return context;
+    }
+
+    private Transport createTransport(SslDomain.Mode mode)
+    {
+        SslDomain domain = SslDomain.Factory.create();
+        domain.init(mode);
+        domain.setSslContext(sslContext);
+        if (pipelined)
+        {
+            ((ProtonJSslDomain) domain).setRecordProcessingExecutor(recordExecutor);
+        }
+
+        Transport transport = Proton.transport();
+        transport.ssl(domain);
+        return transport;
+    }
+
+    private final class Stream
+    {
+        private final ClientEndpoint client;
+        private final ServerEndpoint server;
+
+        Stream() throws IOException
+        {
+            SocketChannel clientChannel = SocketChannel.open(acceptor.getLocalAddress());
+            SocketChannel serverChannel = acceptor.accept();
+
+            client = new ClientEndpoint(clientChannel, createTransport(SslDomain.Mode.CLIENT));
+            server = new ServerEndpoint(serverChannel, createTransport(SslDomain.Mode.SERVER));
+
+            driverExecutor.execute(client);
+            driverExecutor.execute(server);
+        }
+
+        void awaitReady() throws InterruptedException
+        {
+            client.ready.acquire();
+        }
+
+        void close() throws IOException
+        {
+            client.close();
+            server.close();
+        }
+    }
+
+    /**
+     * Drives one end of a connection over a non-blocking socket until closed, in the same way as the
+     * reactor's IOHandler.
+     */
+    private abstract static class Endpoint implements Runnable
+    {
+        protected final Connection connection = Proton.connection();
+        private final SocketChannel channel;
+        private final Transport transport;
+        private final Selector selector;
+        private volatile boolean closed;
+
+        Endpoint(SocketChannel channel, Transport transport) throws IOException
+        {
+            this.channel = channel;
+            this.transport = transport;
+            this.selector = Selector.open();
+
+            channel.configureBlocking(false);
+            channel.socket().setTcpNoDelay(true);
+            transport.bind(connection);
+        }
+
+        /**
+         * @return true if any progress was made.
+         */
+        protected abstract boolean work();
+
+        @Override
+        public void run()
+        {
+            try
+            {
+                SelectionKey key = channel.register(selector, SelectionKey.OP_READ);
+
+                while (!closed)
+                {
+                    boolean progress = work();
+
+                    int pending = transport.pending();
+                    if (pending > 0)
+                    {
+                        int n = channel.write(transport.head());
+                        if (n > 0)
+                        {
+                            transport.pop(n);
+                            progress = true;
+                        }
+                    }
+
+                    int capacity = transport.capacity();
+                    if (capacity > 0)
+                    {
+                        int n = channel.read(transport.tail());
+                        if (n > 0)
+                        {
+                            transport.process();
+                            progress = true;
+                        }
+                        else if (n < 0)
+                        {
+                            return;
+                        }
+                    }
+
+                    if (!progress)
+                    {
+                        key.interestOps(SelectionKey.OP_READ | (transport.pending() > 0 ? SelectionKey.OP_WRITE : 0));
+                        selector.select(100);
+                        selector.selectedKeys().clear();
+                    }
+                }
+            }
+            catch (IOException e)
+            {
+                if (!closed)
+                {
+                    throw new IllegalStateException(e);
+                }
+            }
+        }
+
+        void wakeup()
+        {
+            selector.wakeup();
+        }
+
+        void close() throws IOException
+        {
+            closed = true;
+            selector.wakeup();
+            channel.close();
+        }
+    }
+
+    private static final class ClientEndpoint extends Endpoint
+    {
+        private final Semaphore ready = new Semaphore(0);
+        private final AtomicInteger requested = new AtomicInteger();
+        private final byte[] payload = new byte[PAYLOAD_SIZE];
+        private final Sender sender;
+        private boolean signalledReady;
+        private int sent;
+
+        ClientEndpoint(SocketChannel channel, Transport transport) throws IOException
+        {
+            super(channel, transport);
+
+            connection.open();
+            Session session = connection.session();
+            session.open();
+            sender = session.sender("tls-stream");
+            sender.open();
+        }
+
+        void request(int messages)
+        {
+            requested.addAndGet(messages);
+            wakeup();
+        }
+
+        @Override
+        protected boolean work()
+        {
+            if (!signalledReady && sender.getCredit() > 0)
+            {
+                signalledReady = true;
+                ready.release();
+            }
+
+            boolean progress = false;
+            int target = requested.get();
+            while (sent < target && sender.getCredit() > 0)
+            {
+                Delivery delivery = sender.delivery(Integer.toString(sent).getBytes());
+                sender.send(payload, 0, payload.length);
+                sender.advance();
+                delivery.settle();
+                sent++;
+                progress = true;
+            }
+
+            return progress;
+        }
+    }
+
+    private static final class ServerEndpoint extends Endpoint
+    {
+        private final Semaphore received = new Semaphore(0);
+        private final byte[] scratch = new byte[PAYLOAD_SIZE];
+        private Receiver receiver;
+
+        ServerEndpoint(SocketChannel channel, Transport transport) throws IOException
+        {
+            super(channel, transport);
+        }
+
+        @Override
+        protected boolean work()
+        {
+            boolean progress = false;
+
+            if (receiver == null)
+            {
+                if (connection.getLocalState() == EndpointState.UNINITIALIZED && connection.getRemoteState() == EndpointState.ACTIVE)
+                {
+                    connection.open();
+                }
+
+                Session session = connection.sessionHead(EnumSet.of(EndpointState.UNINITIALIZED), EnumSet.of(EndpointState.ACTIVE));
+                if (session != null)
+                {
+                    session.open();
+                }
+
+                Link link = connection.linkHead(EnumSet.of(EndpointState.UNINITIALIZED), EnumSet.of(EndpointState.ACTIVE));
+                if (link != null)
+                {
+                    receiver = (Receiver) link;
+                    receiver.open();
+                    receiver.flow(CREDIT);
+                    progress = true;
+                }
+
+                return progress;
+            }
+
+            Delivery delivery;
+            while ((delivery = receiver.current()) != null && delivery.isReadable())
+            {
+                while (delivery.pending() > 0)
+                {
+                    receiver.recv(scratch, 0, scratch.length);
+                    progress = true;
+                }
+
+                if (delivery.isPartial())
+                {
+                    break;
+                }
+
+                receiver.advance();
+                delivery.settle();
+                receiver.flow(1);
+                received.release();
+            }
+
+            return progress;
+        }
+    }
+
+    public static void main(String[] args) throws RunnerException
+    {
+        final Options opt = new OptionsBuilder()
+            .include(TlsStreamBenchmark.class.getSimpleName())
+            .warmupIterations(5)
+            .measurementIterations(5)
+            .forks(1)
+            .build();
+        new Runner(opt).run();
+    }
+}
@@ -0,0 +1,168 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.qpid.proton.engine;
+
+import java.nio.ByteBuffer;
+import java.util.EnumSet;
+import java.util.concurrent.TimeUnit;
+
+import org.apache.qpid.proton.Proton;
+import org.apache.qpid.proton.engine.impl.TransportInternal;
+import org.apache.qpid.proton.engine.impl.WebSocketImpl;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+import org.openjdk.jmh.runner.Runner;
+import org.openjdk.jmh.runner.RunnerException;
+import org.openjdk.jmh.runner.options.Options;
+import org.openjdk.jmh.runner.options.OptionsBuilder;
+
+/**
+ * Measures the time taken to move a batch of messages between a pair of transports connected in
+ * memory, either directly or with a WebSocket layer at each end, so the cost of the WebSocket
+ * framing and masking can be compared against the plain transport.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 5, time = 1)
+@Measurement(iterations = 5, time = 1)
+public class WebSocketTransportBenchmark
+{
+    private static final int MESSAGES_PER_OPERATION = 16;
+
+    @Param({"false", "true"})
+    public boolean webSocket;
+
+    @Param({"256", "65536"})
+    public int payloadSize;
+
+    private Transport clientTransport;
+    private Transport serverTransport;
+    private Sender sender;
+    private Receiver receiver;
+    private byte[] payload;
+    private byte[] scratch;
+    private int tag;
+
+    @Setup
+    public void init()
+    {
+        payload = new byte[payloadSize];
+        scratch = new byte[payloadSize];
+
+        clientTransport = Proton.transport();
+        serverTransport = Proton.transport();
+        if (webSocket)
+        {
+            ((TransportInternal) clientTransport).addTransportLayer(new WebSocketImpl(WebSocketImpl.Mode.CLIENT, "localhost", "/"));
+            ((TransportInternal) serverTransport).addTransportLayer(new WebSocketImpl(WebSocketImpl.Mode.SERVER, null, null));
+        }
+
+        Connection clientConnection = Proton.connection();
+        Connection serverConnection = Proton.connection();
+        clientTransport.bind(clientConnection);
+        serverTransport.bind(serverConnection);
+
+        clientConnection.open();
+        Session session = clientConnection.session();
+        session.open();
+        sender = session.sender("benchmark");
+        sender.open();
+
+        pump();
+
+        serverConnection.open();
+        serverConnection.sessionHead(EnumSet.of(EndpointState.UNINITIALIZED), EnumSet.of(EndpointState.ACTIVE)).open();
+        receiver = (Receiver) serverConnection.linkHead(EnumSet.of(EndpointState.UNINITIALIZED), EnumSet.of(EndpointState.ACTIVE));
+        receiver.open();
+        receiver.flow(MESSAGES_PER_OPERATION);
+
+        pump();
+    }
+
+    @Benchmark
+    public int transfer()
+    {
+        for (int i = 0; i < MESSAGES_PER_OPERATION; ++i)
+        {
+            Delivery delivery = sender.delivery(Integer.toString(tag++).getBytes());
+            sender.send(payload, 0, payload.length);
+            sender.advance();
+            delivery.settle();
+        }
+
+        pump();
+
+        int received = 0;
+        Delivery delivery;
+        while ((delivery = receiver.current()) != null && !delivery.isPartial())
+        {
+            received += receiver.recv(scratch, 0, scratch.length);
+            receiver.advance();
+            delivery.settle();
+        }
+
+        receiver.flow(MESSAGES_PER_OPERATION);
+        pump();
+
+        return received;
+    }
+
+    private void pump()
+    {
+        boolean moved;
+        do
+        {
+            moved = pump(clientTransport, serverTransport);
+            moved |= pump(serverTransport, clientTransport);
+        }
+        while (moved);
+    }
+
+    private static boolean pump(Transport from, Transport to)
+    {
+        ByteBuffer output = from.getOutputBuffer();
+        boolean moved = output.hasRemaining();
+        if (moved)
+        {
+            to.processInput(output).checkIsOk();
+        }
+
+        from.outputConsumed();
+        return moved;
+    }
+
+    public static void main(String[] args) throws RunnerException
+    {
+        final Options opt = new OptionsBuilder()
+            .include(WebSocketTransportBenchmark.class.getSimpleName())
+            .warmupIterations(5)
+            .measurementIterations(5)
+            .forks(1)
+            .build();
+        new Runner(opt).run();
+    }
+}
@@ -0,0 +1,338 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.qpid.proton.engine;
+
+import java.io.BufferedInputStream;
+import java.io.FileInputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.lang.management.ManagementFactory;
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.List;
+
+import org.apache.qpid.proton.Proton;
+import org.apache.qpid.proton.amqp.messaging.Accepted;
+import org.apache.qpid.proton.engine.impl.WireCaptureImpl;
+
+/**
+ * Replays the input recorded by a {@link WireCaptureImpl} through fresh transports as fast as
+ * possible, reporting the throughput achieved and the bytes allocated per replay, so that
+ * captured traffic can be used as a repeatable benchmark:
+ *
+ *     java -cp target/proton-j-performance-jmh.jar org.apache.qpid.proton.engine.WireCaptureReplay &lt;capture&gt; [iterations]
+ *
+ * The replaying transport plays the part of the captured endpoint as a passive peer: it answers
+ * SASL with success, opens whatever the remote peer opens, grants credit to receiving links and
+ * accepts and settles the messages it receives. Captures taken from the actively sending side
+ * need a handler scripting the same application actions, given to {@link #replay(List, Handler)}.
+ */
+public class WireCaptureReplay
+{
+    private static final int DEFAULT_ITERATIONS = 20;
+    private static final int LINK_CREDIT = 1000;
+
+    private final List<byte[]> input;
+    private final long capturedNanos;
+    private final long inputBytes;
+
+    public WireCaptureReplay(List<WireCaptureImpl.Chunk> chunks)
+    {
+        input = new ArrayList<>();
+        long bytes = 0;
+        for (WireCaptureImpl.Chunk chunk : chunks)
+        {
+            if (chunk.getDirection() == WireCaptureImpl.Direction.INPUT && chunk.getData().length > 0)
+            {
+                input.add(chunk.getData());
+                bytes += chunk.getData().length;
+            }
+        }
+
+        inputBytes = bytes;
+        capturedNanos = chunks.isEmpty() ? 0 : chunks.get(chunks.size() - 1).getTimestamp();
+    }
+
+    public long getInputBytes()
+    {
+        return inputBytes;
+    }
+
+    public long getCapturedNanos()
+    {
+        return capturedNanos;
+    }
+
+    /**
+     * Feeds the captured input through a new transport, dispatching the resulting events to the
+     * given handler after each chunk and discarding whatever the transport writes in reply.
+     *
+     * @param handler the application actions to take in response to the captured traffic
+     * @return the number of bytes the transport wrote in reply
+     */
+    public long replay(Handler handler)
+    {
+        Transport transport = Proton.transport();
+        Sasl sasl = transport.sasl();
+        sasl.server();
+        sasl.allowSkip(true);
+        sasl.setMechanisms("ANONYMOUS", "PLAIN");
+        sasl.setListener(new ReplaySaslListener());
+
+        Connection connection = Proton.connection();
+        Collector collector = Collector.Factory.create();
+        connection.collect(collector);
+        transport.bind(connection);
+
+        long output = 0;
+        for (byte[] chunk : input)
+        {
+            ByteBuffer buffer = ByteBuffer.wrap(chunk);
+            while (buffer.hasRemaining())
+            {
+                int before = buffer.remaining();
+                TransportResult result = transport.processInput(buffer);
+                if (!result.isOk())
+                {
+                    throw new IllegalStateException("Replayed input was rejected", result.getException());
+                }
+
+                dispatch(collector, handler);
+                output += drain(transport);
+
+                if (buffer.remaining() == before)
+                {
+                    break;
+                }
+            }
+        }
+
+        return output;
+    }
+
+    /**
+     * Replays the input of the given chunks once through a new transport.
+     */
+    public static long replay(List<WireCaptureImpl.Chunk> chunks, Handler handler)
+    {
+        return new WireCaptureReplay(chunks).replay(handler);
+    }
+
+    private static void dispatch(Collector collector, Handler handler)
+    {
+        Event event;
+        while ((event = collector.peek()) != null)
+        {
+            event.dispatch(handler);
+            collector.pop();
+        }
+    }
+
+    private static long drain(Transport transport)
+    {
+        long drained = 0;
+        int pending;
+        while ((pending = transport.pending()) > 0)
+        {
+            transport.pop(pending);
+            drained += pending;
+        }
+        return drained;
+    }
+
+    public static void main(String[] args) throws IOException
+    {
+        if (args.length < 1)
+        {
+            System.err.println("Usage: WireCaptureReplay <capture> [iterations]");
+            System.exit(1);
+        }
+
+        int iterations = args.length > 1 ? Integer.parseInt(args[1]) : DEFAULT_ITERATIONS;
+
+        List<WireCaptureImpl.Chunk> chunks;
+        try (InputStream in = new BufferedInputStream(new FileInputStream(args[0])))
+        {
+            chunks = WireCaptureImpl.read(in);
+        }
+
+        WireCaptureReplay replay = new WireCaptureReplay(chunks);
+        System.out.printf("Capture: %d chunks, %d input bytes over %.3f ms%n",
+                          chunks.size(), replay.getInputBytes(), replay.getCapturedNanos() / 1e6);
+
+        // Warm up with as many replays as are measured
+        for (int i = 0; i < iterations; ++i)
+        {
+            replay.replay(new PassivePeerHandler());
+        }
+
+        long allocatedBefore = allocatedBytes();
+        long start = System.nanoTime();
+        long output = 0;
+        for (int i = 0; i < iterations; ++i)
+        {
+            output += replay.replay(new PassivePeerHandler());
+        }
+        long elapsed = System.nanoTime() - start;
+        long allocated = allocatedBytes() - allocatedBefore;
+
+        double seconds = elapsed / 1e9;
+        System.out.printf("Replayed %d times in %.3f ms: %.1f MB/s input, %.1f replays/s, %d output bytes per replay%n",
+                          iterations, elapsed / 1e6, replay.getInputBytes() * iterations / seconds / 1e6,
+                          iterations / seconds, output / iterations);
+        if (allocatedBefore >= 0)
+        {
+            System.out.printf("Allocated %d bytes per replay, %.2f per input byte%n",
+                              allocated / iterations, (double) allocated / iterations / Math.max(1, replay.getInputBytes()));
+        }
+    }
+
+    private static long allocatedBytes()
+    {
+        java.lang.management.ThreadMXBean threads = ManagementFactory.getThreadMXBean();
+        if (threads instanceof com.sun.management.ThreadMXBean)
+        {
+            com.sun.management.ThreadMXBean sunThreads = (com.sun.management.ThreadMXBean) threads;
+            if (sunThreads.isThreadAllocatedMemorySupported() && sunThreads.isThreadAllocatedMemoryEnabled())
+            {
+                return sunThreads.getThreadAllocatedBytes(Thread.currentThread().getId());
+            }
+        }
+        return -1;
+    }
+
+    private static final class ReplaySaslListener implements SaslListener
+    {
+        @Override
+        public void onSaslInit(Sasl sasl, Transport transport)
+        {
+            sasl.done(Sasl.SaslOutcome.PN_SASL_OK);
+        }
+
+        @Override
+        public void onSaslResponse(Sasl sasl, Transport transport)
+        {
+            sasl.done(Sasl.SaslOutcome.PN_SASL_OK);
+        }
+
+        @Override
+        public void onSaslMechanisms(Sasl sasl, Transport transport)
+        {
+        }
+
+        @Override
+        public void onSaslChallenge(Sasl sasl, Transport transport)
+        {
+        }
+
+        @Override
+        public void onSaslOutcome(Sasl sasl, Transport transport)
+        {
+        }
+    }
+
+    /**
+     * Plays the part of a peer that follows the remote endpoint's lead and consumes everything
+     * it is sent.
+     */
+    public static class PassivePeerHandler extends BaseHandler
+    {
+        private byte[] scratch = new byte[1024];
+
+        @Override
+        public void onConnectionRemoteOpen(Event event)
+        {
+            Connection connection = event.getConnection();
+            if (connection.getLocalState() == EndpointState.UNINITIALIZED)
+            {
+                connection.open();
+            }
+        }
+
+        @Override
+        public void onSessionRemoteOpen(Event event)
+        {
+            Session session = event.getSession();
+            if (session.getLocalState() == EndpointState.UNINITIALIZED)
+            {
+                session.open();
+            }
+        }
+
+        @Override
+        public void onLinkRemoteOpen(Event event)
+        {
+            Link link = event.getLink();
+            if (link.getLocalState() == EndpointState.UNINITIALIZED)
+            {
+                link.setSource(link.getRemoteSource());
+                link.setTarget(link.getRemoteTarget());
+                link.open();
+                if (link instanceof Receiver)
+                {
+                    ((Receiver) link).flow(LINK_CREDIT);
+                }
+            }
+        }
+
+        @Override
+        public void onDelivery(Event event)
+        {
+            Delivery delivery = event.getDelivery();
+            if (delivery.getLink() instanceof Receiver)
+            {
+                Receiver receiver = (Receiver) delivery.getLink();
+                if (delivery.isReadable() && !delivery.isPartial())
+                {
+                    int pending = delivery.pending();
+                    if (scratch.length < pending)
+                    {
+                        scratch = new byte[pending];
+                    }
+                    receiver.recv(scratch, 0, pending);
+                    receiver.advance();
+                    delivery.disposition(Accepted.getInstance());
+                    delivery.settle();
+                    receiver.flow(1);
+                }
+            }
+            else if (delivery.remotelySettled())
+            {
+                delivery.settle();
+            }
+        }
+
+        @Override
+        public void onLinkRemoteClose(Event event)
+        {
+            event.getLink().close();
+        }
+
+        @Override
+        public void onSessionRemoteClose(Event event)
+        {
+            event.getSession().close();
+        }
+
+        @Override
+        public void onConnectionRemoteClose(Event event)
+        {
+            event.getConnection().close();
+        }
+    }
+}
@@ -0,0 +1,416 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements. See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * <p>
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * <p>
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.qpid.proton.message;
+
+import org.apache.qpid.proton.amqp.Binary;
+import org.apache.qpid.proton.amqp.Symbol;
+import org.apache.qpid.proton.amqp.UnsignedByte;
+import org.apache.qpid.proton.amqp.UnsignedInteger;
+import org.apache.qpid.proton.amqp.messaging.AmqpValue;
+import org.apache.qpid.proton.amqp.messaging.ApplicationProperties;
+import org.apache.qpid.proton.amqp.messaging.Data;
+import org.apache.qpid.proton.amqp.messaging.Header;
+import org.apache.qpid.proton.amqp.messaging.MessageAnnotations;
+import org.apache.qpid.proton.amqp.messaging.Properties;
+import org.apache.qpid.proton.amqp.messaging.Section;
+import org.apache.qpid.proton.codec.AMQPDefinedTypes;
+import org.apache.qpid.proton.codec.DecoderImpl;
+import org.apache.qpid.proton.codec.EncoderImpl;
+import org.apache.qpid.proton.codec.ReadableBuffer;
+import org.openjdk.jmh.annotations.*;
+import org.openjdk.jmh.infra.Blackhole;
+import org.openjdk.jmh.runner.RunnerException;
+
+import java.io.File;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.file.Files;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Date;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Random;
+import java.util.UUID;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Measures decode, encode and round trip costs per message over a corpus of encoded messages
+ * of a given shape, both at the codec level with {@link DecoderImpl} and {@link EncoderImpl}
+ * and for whole messages with {@link Message}. Run with the GC profiler to see allocation per
+ * message:
+ *
+ *     java -jar target/proton-j-performance-jmh.jar CorpusBenchmark -prof gc
+ *
+ * The {@code interop} shape is read from the tests/interop files, found by searching up from the
+ * working directory, and the {@code captured} shape from the files in the directories listed in
+ * the {@value #CORPUS_PROPERTY} system property, each holding a sequence of encoded AMQP values
+ * such as a message payload. The other shapes are generated.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 5, time = 1)
+@Measurement(iterations = 5, time = 1)
+public class CorpusBenchmark
+{
+    public static final String CORPUS_PROPERTY = "proton.benchmark.corpus";
+
+    private static final int VARIANTS = 8;
+
+    @Param({"interop", "largeMap", "nestedList", "bigBinary", "unicode", "typical"})
+    public String shape;
+
+    private DecoderImpl decoder;
+    private EncoderImpl encoder;
+    private ByteBuffer encodeBuffer;
+    private byte[] messageBuffer;
+    private Entry[] entries;
+    private int next;
+
+    private static final class Entry
+    {
+        private final ReadableBuffer encoded;
+        private final List<Object> values;
+        private final byte[] message;
+        private final Message decodedMessage;
+
+        private Entry(ReadableBuffer encoded, List<Object> values, byte[] message, Message decodedMessage)
+        {
+            this.encoded = encoded;
+            this.values = values;
+            this.message = message;
+            this.decodedMessage = decodedMessage;
+        }
+    }
+
+    @Setup
+    public void init() throws IOException
+    {
+        decoder = new DecoderImpl();
+        encoder = new EncoderImpl(decoder);
+        AMQPDefinedTypes.registerAllTypes(decoder, encoder);
+
+        List<byte[]> corpus = loadCorpus(shape);
+        if (corpus.isEmpty())
+        {
+            throw new IllegalStateException("No encoded messages found for shape " + shape);
+        }
+
+        int maxLength = 0;
+        List<Entry> loaded = new ArrayList<>();
+        for (byte[] encoded : corpus)
+        {
+            Entry entry = createEntry(encoded);
+            loaded.add(entry);
+            maxLength = Math.max(maxLength, Math.max(encoded.length, entry.message.length));
+        }
+
+        entries = loaded.toArray(new Entry[0]);
+        encodeBuffer = ByteBuffer.allocate(maxLength * 2 + 1024);
+        messageBuffer = new byte[maxLength * 2 + 1024];
+        encoder.setByteBuffer(encodeBuffer);
+    }
+
+    private Entry nextEntry()
+    {
+        Entry entry = entries[next];
+        if (++next == entries.length)
+        {
+            next = 0;
+        }
+        return entry;
+    }
+
+    @Benchmark
+    public void decode(Blackhole blackhole)
+    {
+        ReadableBuffer encoded = nextEntry().encoded;
+        encoded.rewind();
+        decoder.setBuffer(encoded);
+        while (encoded.hasRemaining())
+        {
+            blackhole.consume(decoder.readObject());
+        }
+    }
+
+    @Benchmark
+    public ByteBuffer encode()
+    {
+        List<Object> values = nextEntry().values;
+        encodeBuffer.clear();
+        for (int i = 0; i < values.size(); ++i)
+        {
+            encoder.writeObject(values.get(i));
+        }
+        return encodeBuffer;
+    }
+
+    @Benchmark
+    public ByteBuffer roundTrip()
+    {
+        ReadableBuffer encoded = nextEntry().encoded;
+        encoded.rewind();
+        decoder.setBuffer(encoded);
+        encodeBuffer.clear();
+        while (encoded.hasRemaining())
+        {
+            encoder.writeObject(decoder.readObject());
+        }
+        return encodeBuffer;
+    }
+
+    @Benchmark
+    public Message decodeMessage()
+    {
+        byte[] encoded = nextEntry().message;
+        Message message = Message.Factory.create();
+        message.decode(encoded, 0, encoded.length);
+        return message;
+    }
+
+    @Benchmark
+    public int encodeMessage()
+    {
+        return nextEntry().decodedMessage.encode(messageBuffer, 0, messageBuffer.length);
+    }
+
+    @Benchmark
+    public int roundTripMessage()
+    {
+        byte[] encoded = nextEntry().message;
+        Message message = Message.Factory.create();
+        message.decode(encoded, 0, encoded.length);
+        return message.encode(messageBuffer, 0, messageBuffer.length);
+    }
+
+    private Entry createEntry(byte[] encoded)
+    {
+        ReadableBuffer buffer = ReadableBuffer.ByteBufferReader.wrap(encoded);
+        decoder.setBuffer(buffer);
+
+        List<Object> values = new ArrayList<>();
+        boolean sections = true;
+        while (buffer.hasRemaining())
+        {
+            Object value = decoder.readObject();
+            values.add(value);
+            sections &= value instanceof Section;
+        }
+
+        // A sequence of sections is a message in its own right, anything else becomes its body
+        byte[] message;
+        if (sections)
+        {
+            message = encoded;
+        }
+        else
+        {
+            Message wrapper = Message.Factory.create();
+            wrapper.setMessageId(UUID.randomUUID());
+            wrapper.setAddress("queue://corpus");
+            wrapper.setBody(new AmqpValue(values.size() == 1 ? values.get(0) : values));
+            message = encodeMessage(wrapper, encoded.length);
+        }
+
+        Message decodedMessage = Message.Factory.create();
+        decodedMessage.decode(message, 0, message.length);
+
+        return new Entry(buffer, values, message, decodedMessage);
+    }
+
+    private static byte[] encodeMessage(Message message, int sizeHint)
+    {
+        byte[] buffer = new byte[sizeHint * 2 + 1024];
+        int length = message.encode(buffer, 0, buffer.length);
+        return Arrays.copyOf(buffer, length);
+    }
+
+    private List<byte[]> loadCorpus(String shape) throws IOException
+    {
+        switch (shape)
+        {
+            case "interop":
+                return readFiles(findInteropDir());
+            case "captured":
+                List<byte[]> captured = new ArrayList<>();
+                String directories = System.getProperty(CORPUS_PROPERTY, "");
+                for (String directory : directories.split(","))
+                {
+                    if (!directory.trim().isEmpty())
+                    {
+                        captured.addAll(readFiles(new File(directory.trim())));
+                    }
+                }
+                return captured;
+            default:
+                List<byte[]> generated = new ArrayList<>();
+                Random random = new Random(17);
+                for (int i = 0; i < VARIANTS; ++i)
+                {
+                    generated.add(encodeMessage(generate(shape, i, random), 1024 * 1024));
+                }
+                return generated;
+        }
+    }
+
+    private static Message generate(String shape, int variant, Random random)
+    {
+        Message message = Message.Factory.create();
+        switch (shape)
+        {
+            case "largeMap":
+                Map<String, Object> map = new LinkedHashMap<>();
+                for (int i = 0; i < 500 + variant * 100; ++i)
+                {
+                    map.put("key-" + i, randomValue(i, random));
+                }
+                message.setBody(new AmqpValue(map));
+                break;
+            case "nestedList":
+                message.setBody(new AmqpValue(nestedList(3 + variant % 3, random)));
+                break;
+            case "bigBinary":
+                byte[] payload = new byte[(64 << (variant % 3)) * 1024];
+                random.nextBytes(payload);
+                message.setBody(new Data(new Binary(payload)));
+                break;
+            case "unicode":
+                List<Object> strings = new ArrayList<>();
+                for (int i = 0; i < 20 + variant * 10; ++i)
+                {
+                    strings.add(unicodeString(random));
+                }
+                message.setBody(new AmqpValue(strings));
+                break;
+            case "typical":
+                message.setHeader(new Header());
+                message.getHeader().setDurable(true);
+                message.getHeader().setPriority(UnsignedByte.valueOf((byte) 4));
+                Properties properties = new Properties();
+                properties.setMessageId("ID:" + UUID.randomUUID());
+                properties.setTo("queue://orders");
+                properties.setCorrelationId(UUID.randomUUID());
+                properties.setContentType(Symbol.valueOf("application/json"));
+                properties.setCreationTime(new Date(1500000000000L + variant));
+                message.setProperties(properties);
+                Map<Symbol, Object> annotations = new LinkedHashMap<>();
+                annotations.put(Symbol.valueOf("x-opt-jms-msg-type"), (byte) 5);
+                annotations.put(Symbol.valueOf("x-opt-jms-dest"), (byte) 0);
+                message.setMessageAnnotations(new MessageAnnotations(annotations));
+                Map<String, Object> applicationProperties = new LinkedHashMap<>();
+                for (int i = 0; i < 10; ++i)
+                {
+                    applicationProperties.put("property-" + i, randomValue(i + variant, random));
+                }
+                message.setApplicationProperties(new ApplicationProperties(applicationProperties));
+                message.setBody(new AmqpValue("{\"order\": " + variant + ", \"items\": [1, 2, 3]}"));
+                break;
+            default:
+                throw new IllegalArgumentException("Unknown corpus shape: " + shape);
+        }
+        return message;
+    }
+
+    private static Object randomValue(int index, Random random)
+    {
+        switch (index % 8)
+        {
+            case 0: return random.nextInt();
+            case 1: return random.nextLong();
+            case 2: return "value-" + random.nextInt(1000);
+            case 3: return random.nextBoolean();
+            case 4: return new UUID(random.nextLong(), random.nextLong());
+            case 5: return random.nextDouble();
+            case 6: return UnsignedInteger.valueOf(random.nextInt() & Integer.MAX_VALUE);
+            default:
+                byte[] bytes = new byte[16];
+                random.nextBytes(bytes);
+                return new Binary(bytes);
+        }
+    }
+
+    private static List<Object> nestedList(int depth, Random random)
+    {
+        List<Object> list = new ArrayList<>();
+        for (int i = 0; i < 4; ++i)
+        {
+            list.add(depth > 0 && i < 3 ? nestedList(depth - 1, random) : randomValue(random.nextInt(8), random));
+        }
+        return list;
+    }
+
+    private static final String[] UNICODE_WORDS = {
+        "hello", "héllo wörld", "Привет мир",
+        "こんにちは世界", "مرحبا",
+        "😀🚀", "¡Hola!", "γειά"
+    };
+
+    private static String unicodeString(Random random)
+    {
+        StringBuilder builder = new StringBuilder();
+        int words = 1 + random.nextInt(40);
+        for (int i = 0; i < words; ++i)
+        {
+            builder.append(UNICODE_WORDS[random.nextInt(UNICODE_WORDS.length)]).append(' ');
+        }
+        return builder.toString();
+    }
+
+    private static File findInteropDir()
+    {
+        File dir = new File(System.getProperty("user.dir")).getAbsoluteFile();
+        while (dir != null)
+        {
+            File interop = dir.getName().equals("tests") ? new File(dir, "interop") : new File(new File(dir, "tests"), "interop");
+            if (interop.isDirectory())
+            {
+                return interop;
+            }
+            dir = dir.getParentFile();
+        }
+
+        throw new IllegalStateException("Cannot find tests/interop directory");
+    }
+
+    private static List<byte[]> readFiles(File directory) throws IOException
+    {
+        File[] files = directory.listFiles();
+        if (files == null)
+        {
+            throw new IOException("Cannot list corpus directory " + directory);
+        }
+
+        Arrays.sort(files);
+        List<byte[]> contents = new ArrayList<>();
+        for (File file : files)
+        {
+            if (file.isFile() && file.length() > 0)
+            {
+                contents.add(Files.readAllBytes(file.toPath()));
+            }
+        }
+        return contents;
+    }
+
+    public static void main(String[] args) throws RunnerException
+    {
+        MessageBenchmark.runBenchmark(CorpusBenchmark.class);
+    }
+}